@@ -0,0 +1,214 @@
+//Compares loading a synthetic config corpus with the streaming decoder from src/settings/configDecoder.h
+//against the jsoncpp DOM path it replaced. Without arguments it writes the corpus and runs itself once
+//per loader, so each loader's peak memory is measured in a fresh process.
+//
+//	configDecoderBench [files] [rules per file]
+//	configDecoderBench --load <decoder|jsoncpp> <corpus dir> <file count>
+
+#include "settings/configDecoder.h"
+
+#include <json/json.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#	define WIN32_LEAN_AND_MEAN
+#	define NOMINMAX
+#	include <Windows.h>
+#	include <Psapi.h>
+#else
+#	include <sys/resource.h>
+#endif
+
+namespace
+{
+	constexpr int kRepeats = 5;
+
+	size_t PeakMemoryKiB()
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters{};
+		::GetProcessMemoryInfo(::GetCurrentProcess(), &counters, sizeof(counters));
+		return counters.PeakWorkingSetSize / 1024;
+#else
+		rusage usage{};
+		::getrusage(RUSAGE_SELF, &usage);
+		return static_cast<size_t>(usage.ru_maxrss);
+#endif
+	}
+
+	std::string MakeForm(std::mt19937& a_rng)
+	{
+		static constexpr const char* plugins[] = { "Skyrim.esm", "Dawnguard.esm", "HearthFires.esm", "Dragonborn.esm", "Some Mod \\\"Remastered\\\".esp" };
+		std::uniform_int_distribution<uint32_t> id(0x800, 0xFFFFFF);
+		std::uniform_int_distribution<size_t> plugin(0, std::size(plugins) - 1);
+		char buffer[16];
+		std::snprintf(buffer, sizeof(buffer), "0x%X", id(a_rng));
+		return std::string(buffer) + "|" + plugins[plugin(a_rng)];
+	}
+
+	std::string MakeList(std::mt19937& a_rng, size_t a_count)
+	{
+		std::string result = "[";
+		for (size_t i = 0; i < a_count; ++i) {
+			result += (i ? ", \"" : "\"") + MakeForm(a_rng) + "\"";
+		}
+		return result + "]";
+	}
+
+	void WriteCorpus(const std::filesystem::path& a_directory, size_t a_files, size_t a_rules)
+	{
+		std::filesystem::remove_all(a_directory);
+		std::filesystem::create_directories(a_directory);
+		std::mt19937 rng{ 1234 };
+		std::uniform_int_distribution<int> roll(0, 99);
+		for (size_t file = 0; file < a_files; ++file) {
+			std::ofstream out(a_directory / ("config" + std::to_string(file) + ".json"), std::ios::binary);
+			out << "{\n\t// generated\n\t\"rules\": [\n";
+			for (size_t rule = 0; rule < a_rules; ++rule) {
+				out << "\t\t{\n\t\t\t\"friendlyName\": \"Rule " << rule << " of file " << file << "\",\n";
+				out << "\t\t\t\"conditions\": {\n\t\t\t\t\"plugins\": [\"Skyrim.esm\"],\n";
+				if (roll(rng) < 50) out << "\t\t\t\t\"containers\": " << MakeList(rng, 1 + rng() % 8) << ",\n";
+				if (roll(rng) < 30) out << "\t\t\t\t\"!locations\": " << MakeList(rng, 1 + rng() % 4) << ",\n";
+				if (roll(rng) < 20) out << "\t\t\t\t\"globals\": [\"GameDaysPassed|" << roll(rng) << "\"],\n";
+				if (roll(rng) < 10) out << "\t\t\t\t\"questConditions\": { \"questID\": \"MQ101\", \"stageDone\": [10, 20] },\n";
+				out << "\t\t\t\t\"allowVendors\": " << (roll(rng) < 50 ? "true" : "false") << "\n\t\t\t},\n";
+				out << "\t\t\t\"changes\": [\n";
+				const auto changes = 1 + rng() % 4;
+				for (size_t change = 0; change < changes; ++change) {
+					out << (change ? ",\n" : "") << "\t\t\t\t{ ";
+					switch (roll(rng) % 3) {
+					case 0:
+						out << "\"add\": " << MakeList(rng, 1 + rng() % 3) << ", \"count\": " << 1 + rng() % 5;
+						break;
+					case 1:
+						out << "\"remove\": \"" << MakeForm(rng) << "\", \"count\": 0";
+						break;
+					default:
+						out << "\"add\": " << MakeList(rng, 1) << ", \"removeByKeywords\": [\"VendorItemFood\", \"VendorItemIngredient\"]";
+						break;
+					}
+					out << " }";
+				}
+				out << "\n\t\t\t]\n\t\t}" << (rule + 1 < a_rules ? "," : "") << "\n";
+			}
+			out << "\t]\n}";
+		}
+	}
+
+	//Touches every string the reader would, so both loaders do comparable work. The result is printed
+	//to check both loaders saw the same data.
+	size_t Checksum(const Settings::Config::ConfigFile& a_file)
+	{
+		size_t sum = 0;
+		for (const auto& rule : a_file.rules) {
+			sum += rule.friendlyName.text.size();
+			for (const auto& element : rule.conditions.containers.elements) sum += element.text.size();
+			for (const auto& element : rule.conditions.notLocations.elements) sum += element.text.size();
+			for (const auto& change : rule.changes) {
+				for (const auto& element : change.add.elements) sum += element.text.size();
+				sum += change.remove.text.size() + change.count.AsUInt();
+			}
+		}
+		return sum;
+	}
+
+	size_t Checksum(const Json::Value& a_root)
+	{
+		size_t sum = 0;
+		for (const auto& rule : a_root["rules"]) {
+			sum += rule["friendlyName"].asString().size();
+			for (const auto& element : rule["conditions"]["containers"]) sum += element.asString().size();
+			for (const auto& element : rule["conditions"]["!locations"]) sum += element.asString().size();
+			for (const auto& change : rule["changes"]) {
+				for (const auto& element : change["add"]) sum += element.asString().size();
+				if (change["remove"]) sum += change["remove"].asString().size();
+				if (change["count"]) sum += change["count"].asUInt();
+			}
+		}
+		return sum;
+	}
+
+	int Load(const std::string& a_loader, const std::filesystem::path& a_directory, size_t a_files)
+	{
+		std::vector<std::string> paths;
+		for (size_t file = 0; file < a_files; ++file) {
+			paths.push_back((a_directory / ("config" + std::to_string(file) + ".json")).string());
+		}
+
+		//Every loaded file stays alive until the end of a pass, as in the plugin.
+		double best = 1e30;
+		size_t checksum = 0;
+		for (int repeat = 0; repeat < kRepeats; ++repeat) {
+			checksum = 0;
+			const auto start = std::chrono::steady_clock::now();
+			if (a_loader == "decoder") {
+				std::vector<Settings::Config::ConfigFile> files(paths.size());
+				for (size_t i = 0; i < paths.size(); ++i) {
+					std::string error;
+					if (!Settings::Config::Decode(paths[i], files[i], error)) {
+						std::fprintf(stderr, "%s\n", error.c_str());
+						return 1;
+					}
+					checksum += Checksum(files[i]);
+				}
+			}
+			else {
+				std::vector<Json::Value> roots(paths.size());
+				Json::CharReaderBuilder builder{};
+				const std::unique_ptr<Json::CharReader> reader{ builder.newCharReader() };
+				for (size_t i = 0; i < paths.size(); ++i) {
+					std::ifstream rawJSON(paths[i], std::ios::binary);
+					std::string contents{ std::istreambuf_iterator<char>(rawJSON), std::istreambuf_iterator<char>() };
+					std::string errors;
+					if (!reader->parse(contents.data(), contents.data() + contents.size(), &roots[i], &errors)) {
+						std::fprintf(stderr, "%s\n", errors.c_str());
+						return 1;
+					}
+					checksum += Checksum(roots[i]);
+				}
+			}
+			const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+			best = std::min(best, elapsed.count());
+		}
+
+		std::printf("%-8s  %10.2f ms  %10zu KiB  checksum %zu\n", a_loader.c_str(), best, PeakMemoryKiB(), checksum);
+		return 0;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc == 5 && std::string(argv[1]) == "--load") {
+		return Load(argv[2], argv[3], std::strtoull(argv[4], nullptr, 10));
+	}
+
+	const size_t files = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200;
+	const size_t rules = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100;
+	const auto directory = std::filesystem::temp_directory_path() / "cdfDecoderBench";
+	WriteCorpus(directory, files, rules);
+
+	size_t bytes = 0;
+	for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+		bytes += entry.file_size();
+	}
+	std::printf("%zu files, %zu rules each, %.1f MiB. Best of %d passes, peak memory of a fresh process.\n", files, rules, bytes / (1024.0 * 1024.0), kRepeats);
+	std::printf("loader          time          peak\n");
+
+	int result = 0;
+	for (const char* loader : { "decoder", "jsoncpp" }) {
+		const auto command = "\"" + std::string(argv[0]) + "\" --load " + loader + " \"" + directory.string() + "\" " + std::to_string(files);
+		std::fflush(stdout);
+		result |= std::system(command.c_str());
+	}
+	std::filesystem::remove_all(directory);
+	return result;
+}
\ No newline at end of file
@@ -0,0 +1,380 @@
+//Checks configs without the game. Configs go through the same decoder and Settings::Config::RuleCompiler
+//as in the plugin, with forms looked up in a dump written in game by "cdf dumpforms". On top of the
+//plugin's own messages it reports rules that can never fire, duplicate rules and an estimate of the
+//work each container costs on Initialize/Reset.
+//
+//	configLint <form dump> <config dir or file>... [--top N] [--strict]
+//
+//Exits with 1 if a config has errors, or with --strict also on dead or duplicate rules.
+
+#include "formDatabase.h"
+
+#include "settings/configCompiler.h"
+#include "settings/configDecoder.h"
+
+#include <fmt/ranges.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+	using DevTools::Form;
+	using DevTools::FormKind;
+	using Rule = DevTools::DatabaseResolver::Rule;
+
+	//Same types and precedence as Hooks::ContainerManager::RegisterRule.
+	enum class RuleType : uint8_t
+	{
+		kAdd,
+		kRemove,
+		kRemoveKeyword,
+		kReplace,
+		kReplaceKeyword,
+		kNone
+	};
+
+	constexpr std::string_view typeNames[] = { "add", "remove", "remove by keyword", "replace", "replace by keyword" };
+
+	RuleType Classify(const Rule::Change& a_change)
+	{
+		if (a_change.add && a_change.removeKeywords) return RuleType::kReplaceKeyword;
+		if (a_change.add && a_change.remove) return RuleType::kReplace;
+		if (a_change.removeKeywords) return RuleType::kRemoveKeyword;
+		if (a_change.remove) return RuleType::kRemove;
+		if (a_change.add) return RuleType::kAdd;
+		return RuleType::kNone;
+	}
+
+	//One change of one config rule, with what the plugin would evaluate for it.
+	struct LintRule
+	{
+		std::string location;
+		RuleType type;
+		//Every condition the rule checks, in a canonical form, for duplicate detection.
+		std::string checks;
+		std::string payload;
+		size_t dynamicConditions;
+		//Whether the rule is limited to the allowed containers.
+		bool limited;
+		std::unordered_set<const Form*> allowed;
+		std::unordered_set<const Form*> excluded;
+		const Form* target;
+		std::vector<const Form*> keywords;
+		size_t forms;
+	};
+
+	struct Totals
+	{
+		size_t files{ 0 };
+		size_t errors{ 0 };
+		size_t notes{ 0 };
+		size_t dead{ 0 };
+		size_t duplicates{ 0 };
+	};
+
+	std::string Id(const Form* a_form)
+	{
+		return a_form ? fmt::format("{:08X}", a_form->id) : "null";
+	}
+
+	template <class Set>
+	std::string Canonical(std::string_view a_name, const Set& a_set)
+	{
+		std::vector<std::string> ids{};
+		for (const auto form : a_set.forms) {
+			ids.push_back(Id(form));
+		}
+		std::ranges::sort(ids);
+		return fmt::format("{}{}[{}]", a_set.inverted ? "!" : "", a_name, fmt::join(ids, ","));
+	}
+
+	//Mirrors the optimizer's constant folding: an empty form list never matches.
+	bool NeverFires(const Rule& a_rule, LintRule& a_lint)
+	{
+		auto constantFalse = [](const auto& a_sets) {
+			return std::ranges::any_of(a_sets, [](const auto& a_set) { return a_set.forms.empty() && !a_set.inverted; });
+		};
+		if (constantFalse(a_rule.containers) || constantFalse(a_rule.locations) || constantFalse(a_rule.worldspaces) || constantFalse(a_rule.locationKeywords)) {
+			return true;
+		}
+		if (std::ranges::any_of(a_rule.references, [](const auto& a_set) { return a_set.ids.empty() && !a_set.inverted; })) {
+			return true;
+		}
+		return a_lint.limited && std::ranges::all_of(a_lint.allowed, [&](const Form* a_container) { return a_lint.excluded.contains(a_container); });
+	}
+
+	LintRule Describe(const Rule& a_rule, const Rule::Change& a_change, std::string a_location)
+	{
+		LintRule lint{};
+		lint.location = std::move(a_location);
+		lint.type = Classify(a_change);
+		lint.target = a_change.remove;
+		lint.forms = a_change.add ? a_change.add->size() : 0;
+		if (a_change.removeKeywords) {
+			lint.keywords = *a_change.removeKeywords;
+		}
+
+		std::vector<std::string> checks{};
+		checks.push_back(fmt::format("flags:{}{}{}{}", a_rule.bypassUnsafeContainers, a_rule.allowVendors, a_rule.onlyVendors, a_rule.randomAdd));
+		for (const auto& set : a_rule.containers) {
+			checks.push_back(Canonical("containers", set));
+			if (set.inverted) {
+				lint.excluded.insert(set.forms.begin(), set.forms.end());
+			}
+			else if (!lint.limited) {
+				lint.allowed.insert(set.forms.begin(), set.forms.end());
+				lint.limited = true;
+			}
+			else {
+				std::erase_if(lint.allowed, [&](const Form* a_form) { return std::ranges::find(set.forms, a_form) == set.forms.end(); });
+			}
+		}
+		for (const auto& set : a_rule.locations) {
+			checks.push_back(Canonical("locations", set));
+		}
+		for (const auto& set : a_rule.worldspaces) {
+			checks.push_back(Canonical("worldspaces", set));
+		}
+		for (const auto& set : a_rule.locationKeywords) {
+			checks.push_back(Canonical("locationKeywords", set));
+		}
+		for (const auto& skill : a_rule.skills) {
+			checks.push_back(fmt::format("{}skill[{}|{}]", skill.inverted ? "!" : "", Utilities::String::tolower(skill.name), skill.level));
+		}
+		for (const auto& global : a_rule.globals) {
+			checks.push_back(fmt::format("{}global[{}|{}]", global.inverted ? "!" : "", Id(global.global), global.value));
+		}
+		for (const auto& quest : a_rule.quests) {
+			checks.push_back(fmt::format("quest[{}|{}|{}]", Id(quest.quest), fmt::join(quest.stages, ","), quest.completed));
+		}
+		for (const auto& set : a_rule.references) {
+			std::vector<std::string> ids{};
+			for (const auto id : set.ids) {
+				ids.push_back(fmt::format("{:08X}", id));
+			}
+			std::ranges::sort(ids);
+			checks.push_back(fmt::format("{}references[{}]", set.inverted ? "!" : "", fmt::join(ids, ",")));
+		}
+		std::ranges::sort(checks);
+		lint.checks = fmt::format("{}", fmt::join(checks, ";"));
+		//Container conditions are answered by the candidate index, everything else runs per container.
+		lint.dynamicConditions = a_rule.skills.size() + a_rule.globals.size() + a_rule.locations.size() + a_rule.worldspaces.size() +
+		                         a_rule.locationKeywords.size() + a_rule.quests.size() + a_rule.references.size();
+
+		std::vector<std::string> forms{};
+		if (a_change.add) {
+			for (const auto form : *a_change.add) {
+				forms.push_back(Id(form));
+			}
+		}
+		std::vector<std::string> keywords{};
+		for (const auto keyword : lint.keywords) {
+			keywords.push_back(Id(keyword));
+		}
+		std::ranges::sort(keywords);
+		lint.payload = fmt::format("{}|{}|{}|{}", Id(a_change.remove), fmt::join(forms, ","), fmt::join(keywords, ","), a_change.count.value_or(~0u));
+		return lint;
+	}
+
+	//Items a container can start with, through its leveled lists.
+	void CollectItems(const DevTools::FormDatabase& a_database, const Form* a_form, std::unordered_set<const Form*>& a_items, size_t a_depth = 0)
+	{
+		if (!a_form || a_depth > 32 || !a_items.insert(a_form).second) {
+			return;
+		}
+		if (a_form->kind == FormKind::kLeveledList || a_form->kind == FormKind::kContainer) {
+			for (const auto link : a_form->links) {
+				CollectItems(a_database, a_database.Find(link), a_items, a_depth + 1);
+			}
+		}
+	}
+
+	bool HasAllKeywords(const Form* a_item, const std::vector<const Form*>& a_keywords)
+	{
+		return std::ranges::all_of(a_keywords, [&](const Form* a_keyword) { return std::ranges::find(a_item->links, a_keyword->id) != a_item->links.end(); });
+	}
+
+	std::vector<std::string> FindConfigs(const std::vector<std::string>& a_inputs)
+	{
+		std::vector<std::string> paths{};
+		for (const auto& input : a_inputs) {
+			if (std::filesystem::is_directory(input)) {
+				std::vector<std::string> files{};
+				for (const auto& entry : std::filesystem::directory_iterator(input)) {
+					if (entry.is_regular_file() && entry.path().extension() == ".json") {
+						files.push_back(entry.path().string());
+					}
+				}
+				//Same order as the plugin reads them in.
+				std::ranges::sort(files);
+				paths.insert(paths.end(), files.begin(), files.end());
+			}
+			else {
+				paths.push_back(input);
+			}
+		}
+		return paths;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> inputs{};
+	size_t top = 10;
+	bool strict = false;
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view argument = argv[i];
+		if (argument == "--top" && i + 1 < argc) {
+			top = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else if (argument == "--strict") {
+			strict = true;
+		}
+		else {
+			inputs.emplace_back(argument);
+		}
+	}
+	if (inputs.size() < 2) {
+		fmt::print(stderr, "usage: configLint <form dump> <config dir or file>... [--top N] [--strict]\n");
+		return 2;
+	}
+
+	DevTools::FormDatabase database{};
+	std::string error{};
+	if (!database.Load(inputs.front(), error)) {
+		fmt::print(stderr, "{}\n", error);
+		return 2;
+	}
+	inputs.erase(inputs.begin());
+
+	Totals totals{};
+	std::vector<LintRule> rules{};
+	DevTools::DatabaseResolver resolver{ database };
+	auto report = [&](Settings::Config::Severity a_severity, const std::string& a_message) {
+		if (a_severity == Settings::Config::Severity::kWarning) {
+			fmt::print("error: {}\n", a_message);
+			++totals.errors;
+		}
+		else {
+			fmt::print("note: {}\n", a_message);
+			++totals.notes;
+		}
+	};
+
+	for (auto path : FindConfigs(inputs)) {
+		++totals.files;
+		Settings::Config::ConfigFile config{};
+		if (!Settings::Config::Decode(path, config, error)) {
+			fmt::print("error: {}\n", error);
+			++totals.errors;
+			continue;
+		}
+		if (config.rootType != Settings::Config::ValueType::kObject) {
+			fmt::print("error: <{}> is not an object. File will be ignored.\n", path);
+			++totals.errors;
+			continue;
+		}
+
+		Settings::Config::CompileRules(config, path, resolver, report, [&](Rule& a_rule) {
+			for (const auto& change : a_rule.changes) {
+				auto lint = Describe(a_rule, change, fmt::format("<{}>/[{}]", path, a_rule.friendlyName));
+				if (lint.type == RuleType::kNone) {
+					fmt::print("note: {} has a change with only a count, it does nothing.\n", lint.location);
+					++totals.notes;
+					continue;
+				}
+				if (NeverFires(a_rule, lint)) {
+					fmt::print("warning: {} {} rule can never fire, its conditions can't be met.\n", lint.location, typeNames[static_cast<size_t>(lint.type)]);
+					++totals.dead;
+					continue;
+				}
+				rules.push_back(std::move(lint));
+			}
+			});
+	}
+
+	//Duplicates: same type, same checks and same change.
+	std::unordered_map<std::string, size_t> seen{};
+	for (size_t i = 0; i < rules.size(); ++i) {
+		const auto key = fmt::format("{}#{}#{}", static_cast<int>(rules[i].type), rules[i].checks, rules[i].payload);
+		const auto [it, inserted] = seen.try_emplace(key, i);
+		if (!inserted) {
+			fmt::print("warning: {} {} rule duplicates {}.\n", rules[i].location, typeNames[static_cast<size_t>(rules[i].type)], rules[it->second].location);
+			++totals.duplicates;
+		}
+	}
+
+	//Per container cost, in the order of work the hooks do: one visit per candidate rule, its per
+	//container conditions, and an inventory scan for everything that removes.
+	struct ContainerCost
+	{
+		const Form* container;
+		size_t rules;
+		size_t cost;
+	};
+	std::vector<ContainerCost> costs{};
+	std::vector<bool> targetSeen(rules.size(), false);
+	for (const auto& form : database.GetForms()) {
+		if (form.kind != FormKind::kContainer) {
+			continue;
+		}
+
+		std::unordered_set<const Form*> items{};
+		CollectItems(database, &form, items);
+		ContainerCost cost{ &form, 0, 0 };
+		for (size_t i = 0; i < rules.size(); ++i) {
+			const auto& rule = rules[i];
+			if ((rule.limited && !rule.allowed.contains(&form)) || rule.excluded.contains(&form)) {
+				continue;
+			}
+			++cost.rules;
+			cost.cost += 1 + rule.dynamicConditions;
+			if (rule.type == RuleType::kAdd) {
+				cost.cost += rule.forms;
+				continue;
+			}
+			cost.cost += form.links.size();
+
+			if (rule.target && items.contains(rule.target)) {
+				targetSeen[i] = true;
+			}
+			if (!rule.keywords.empty() && std::ranges::any_of(items, [&](const Form* a_item) { return a_item->kind == FormKind::kItem && HasAllKeywords(a_item, rule.keywords); })) {
+				targetSeen[i] = true;
+			}
+		}
+		costs.push_back(cost);
+	}
+
+	//Removals only ever look at what is in the container, this is worth a look but not an error:
+	//other rules or the player can still put the item there.
+	for (size_t i = 0; i < rules.size(); ++i) {
+		if (rules[i].type != RuleType::kAdd && !targetSeen[i]) {
+			fmt::print("note: {} {} rule matches nothing any container starts with.\n", rules[i].location, typeNames[static_cast<size_t>(rules[i].type)]);
+			++totals.notes;
+		}
+	}
+
+	std::ranges::sort(costs, std::ranges::greater{}, &ContainerCost::cost);
+	size_t totalCost = 0;
+	for (const auto& cost : costs) {
+		totalCost += cost.cost;
+	}
+	fmt::print("\n{} files, {} rules, {} containers. {} errors, {} dead rules, {} duplicates, {} notes.\n",
+		totals.files, rules.size(), costs.size(), totals.errors, totals.dead, totals.duplicates, totals.notes);
+	if (!costs.empty()) {
+		fmt::print("Estimated cost per container (rule visits + conditions + inventory entries scanned): average {:.1f}\n", static_cast<double>(totalCost) / costs.size());
+		for (size_t i = 0; i < std::min(top, costs.size()); ++i) {
+			const auto& cost = costs[i];
+			fmt::print("  {:08X} {:<40} {:>6} rules {:>8} cost\n", cost.container->id, cost.container->editorID, cost.rules, cost.cost);
+		}
+	}
+
+	const bool failed = totals.errors > 0 || (strict && (totals.dead > 0 || totals.duplicates > 0));
+	return failed ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,261 @@
+#pragma once
+
+//Synthetic load orders and config corpora for load time benchmarks. The form database and the configs
+//come from the same seed, so every form string in the corpus resolves (unless a missing share is asked
+//for), and the same options always give the same files.
+
+#include "formDatabase.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace DevTools
+{
+	struct CorpusOptions
+	{
+		size_t files{ 100 };
+		size_t rulesPerFile{ 20 };
+		size_t maxChangesPerRule{ 4 };
+		//Chance, in percent, that a rule has a given condition type.
+		int conditionChance{ 25 };
+		//Relative weights of the change kinds.
+		int addWeight{ 50 };
+		int removeWeight{ 25 };
+		int keywordWeight{ 15 };
+		int replaceWeight{ 10 };
+		//Share of form references written as editor IDs instead of "0xID|Plugin.esp", in percent.
+		int editorIDShare{ 50 };
+		//Share of form references that point at nothing, in percent.
+		int missingShare{ 0 };
+		uint32_t seed{ 1234 };
+	};
+
+	class CorpusGenerator
+	{
+	public:
+		explicit CorpusGenerator(const CorpusOptions& a_options) :
+			options(a_options),
+			rng(a_options.seed)
+		{}
+
+		//A load order roughly the size of a modded game: a few masters and a light plugin.
+		void BuildDatabase(FormDatabase& a_database)
+		{
+			mods = {
+				{ "Skyrim.esm", 0x00, 0x000 },
+				{ "Update.esm", 0x01, 0x000 },
+				{ "Dawnguard.esm", 0x02, 0x000 },
+				{ "Dragonborn.esm", 0x03, 0x000 },
+				{ "Some Light Mod.esp", 0xFE, 0x001 }
+			};
+			for (const auto& mod : mods) {
+				a_database.AddMod(mod.name, mod.compileIndex, mod.smallFileCompileIndex);
+			}
+
+			AddForms(a_database, FormKind::kKeyword, "Keyword", 400, keywords);
+			AddForms(a_database, FormKind::kItem, "Item", 20000, items);
+			AddForms(a_database, FormKind::kLeveledList, "LItem", 2000, leveledLists);
+			AddForms(a_database, FormKind::kContainer, "Chest", 3000, containers);
+			AddForms(a_database, FormKind::kLocation, "Location", 600, locations);
+			AddForms(a_database, FormKind::kWorldspace, "World", 40, worldspaces);
+			AddForms(a_database, FormKind::kGlobal, "Global", 200, globals);
+			AddForms(a_database, FormKind::kQuest, "Quest", 400, quests);
+
+			std::uniform_int_distribution<size_t> keyword(0, keywords.size() - 1);
+			std::uniform_int_distribution<size_t> item(0, items.size() - 1);
+			for (auto* form : items) {
+				for (size_t i = rng() % 4; i > 0; --i) {
+					form->links.push_back(keywords[keyword(rng)]->id);
+				}
+			}
+			for (auto* form : leveledLists) {
+				for (size_t i = 1 + rng() % 6; i > 0; --i) {
+					form->links.push_back(items[item(rng)]->id);
+				}
+			}
+			for (auto* form : containers) {
+				for (size_t i = rng() % 12; i > 0; --i) {
+					form->links.push_back(rng() % 4 ? items[item(rng)]->id : leveledLists[rng() % leveledLists.size()]->id);
+					form->counts.push_back(1 + rng() % 5);
+				}
+			}
+		}
+
+		//Writes config0.json ... configN.json. Returns the number of changes (registered rules) written.
+		size_t WriteCorpus(const std::filesystem::path& a_directory)
+		{
+			std::filesystem::remove_all(a_directory);
+			std::filesystem::create_directories(a_directory);
+			size_t changes = 0;
+			for (size_t file = 0; file < options.files; ++file) {
+				std::ofstream out(a_directory / ("config" + std::to_string(file) + ".json"), std::ios::binary);
+				out << "{\n\t\"rules\": [\n";
+				for (size_t rule = 0; rule < options.rulesPerFile; ++rule) {
+					out << "\t\t{\n\t\t\t\"friendlyName\": \"Rule " << rule << " of file " << file << "\",\n";
+					WriteConditions(out);
+					out << "\t\t\t\"changes\": [\n";
+					const auto count = 1 + rng() % options.maxChangesPerRule;
+					for (size_t change = 0; change < count; ++change) {
+						out << (change ? ",\n" : "") << "\t\t\t\t{ ";
+						WriteChange(out);
+						out << " }";
+					}
+					changes += count;
+					out << "\n\t\t\t]\n\t\t}" << (rule + 1 < options.rulesPerFile ? "," : "") << "\n";
+				}
+				out << "\t]\n}";
+			}
+			return changes;
+		}
+
+		//Same format as the in-game "cdf dumpforms", so configLint can check a generated corpus.
+		static void WriteDump(const std::filesystem::path& a_path, const FormDatabase& a_database, const std::vector<Mod>& a_mods)
+		{
+			static constexpr const char* tags[] = { "ITEM", "LVLI", "CONT", "KYWD", "LCTN", "WRLD", "GLOB", "QUST" };
+			std::ofstream out(a_path, std::ios::binary);
+			out << "CDF form dump 1\n";
+			char buffer[32];
+			for (const auto& mod : a_mods) {
+				std::snprintf(buffer, sizeof(buffer), "MOD\t%02X\t%03X\t", mod.compileIndex, mod.smallFileCompileIndex);
+				out << buffer << mod.name << '\n';
+			}
+			for (const auto& form : a_database.GetForms()) {
+				std::snprintf(buffer, sizeof(buffer), "%s\t%08X\t", tags[static_cast<size_t>(form.kind)], form.id);
+				out << buffer << form.editorID << '\t';
+				for (size_t i = 0; i < form.links.size(); ++i) {
+					std::snprintf(buffer, sizeof(buffer), "%s%08X", i ? "," : "", form.links[i]);
+					out << buffer;
+					if (form.kind == FormKind::kContainer) {
+						out << '*' << form.counts[i];
+					}
+				}
+				out << '\n';
+			}
+		}
+
+		const std::vector<Mod>& GetMods() const { return mods; }
+
+	private:
+		void AddForms(FormDatabase& a_database, FormKind a_kind, const char* a_prefix, size_t a_count, std::vector<Form*>& a_target)
+		{
+			for (size_t i = 0; i < a_count; ++i) {
+				//Mostly masters, some from the light plugin.
+				const auto& mod = mods[i % 7 == 6 ? mods.size() - 1 : i % (mods.size() - 1)];
+				const bool light = mod.compileIndex == 0xFE;
+				const uint32_t local = light ? static_cast<uint32_t>(0x800 + nextLocal++ % 0x7FF) : static_cast<uint32_t>(0x800 + nextLocal++);
+				const uint32_t id = (mod.compileIndex << 24) + (mod.smallFileCompileIndex << 12) + local;
+				if (a_database.Find(id)) {
+					continue;
+				}
+				auto& form = a_database.AddForm(id, a_kind, std::string("CDF") + a_prefix + std::to_string(i));
+				a_target.push_back(&form);
+			}
+		}
+
+		std::string Reference(const std::vector<Form*>& a_forms)
+		{
+			std::uniform_int_distribution<int> roll(0, 99);
+			if (roll(rng) < options.missingShare) {
+				return "CDFMissingForm" + std::to_string(rng() % 1000);
+			}
+
+			const auto* form = a_forms[rng() % a_forms.size()];
+			if (roll(rng) < options.editorIDShare) {
+				return form->editorID;
+			}
+			const auto& mod = mods[ModIndex(form->id)];
+			const uint32_t local = mod.compileIndex == 0xFE ? (form->id & 0xFFF) : (form->id & 0xFFFFFF);
+			char buffer[16];
+			std::snprintf(buffer, sizeof(buffer), "0x%X", local);
+			return std::string(buffer) + "|" + mod.name;
+		}
+
+		size_t ModIndex(uint32_t a_id) const
+		{
+			const auto compileIndex = a_id >> 24;
+			for (size_t i = 0; i < mods.size(); ++i) {
+				if (mods[i].compileIndex == compileIndex) {
+					return i;
+				}
+			}
+			return 0;
+		}
+
+		std::string List(const std::vector<Form*>& a_forms, size_t a_count)
+		{
+			std::string result = "[";
+			for (size_t i = 0; i < a_count; ++i) {
+				result += (i ? ", \"" : "\"") + Reference(a_forms) + "\"";
+			}
+			return result + "]";
+		}
+
+		std::string EditorIDList(const std::vector<Form*>& a_forms, size_t a_count, const char* a_suffix = "")
+		{
+			std::string result = "[";
+			for (size_t i = 0; i < a_count; ++i) {
+				result += (i ? ", \"" : "\"") + a_forms[rng() % a_forms.size()]->editorID + a_suffix + "\"";
+			}
+			return result + "]";
+		}
+
+		bool Roll()
+		{
+			return static_cast<int>(rng() % 100) < options.conditionChance;
+		}
+
+		void WriteConditions(std::ofstream& a_out)
+		{
+			a_out << "\t\t\t\"conditions\": {\n";
+			if (Roll()) a_out << "\t\t\t\t\"plugins\": [\"" << mods[rng() % mods.size()].name << "\"],\n";
+			if (Roll()) a_out << "\t\t\t\t\"containers\": " << List(containers, 1 + rng() % 8) << ",\n";
+			if (Roll()) a_out << "\t\t\t\t\"!containers\": " << List(containers, 1 + rng() % 3) << ",\n";
+			if (Roll()) a_out << "\t\t\t\t\"locations\": " << List(locations, 1 + rng() % 4) << ",\n";
+			if (Roll()) a_out << "\t\t\t\t\"!worldspaces\": " << List(worldspaces, 1 + rng() % 2) << ",\n";
+			if (Roll()) a_out << "\t\t\t\t\"locationKeywords\": " << EditorIDList(keywords, 1 + rng() % 2) << ",\n";
+			if (Roll()) a_out << "\t\t\t\t\"playerSkills\": [\"OneHanded|" << rng() % 100 << "\"],\n";
+			if (Roll()) a_out << "\t\t\t\t\"globals\": " << EditorIDList(globals, 1, "|1") << ",\n";
+			if (Roll()) a_out << "\t\t\t\t\"questConditions\": { \"questID\": \"" << quests[rng() % quests.size()]->editorID << "\", \"stageDone\": [10, 20] },\n";
+			if (Roll()) a_out << "\t\t\t\t\"references\": [\"0x" << std::hex << (0x10000 + rng() % 0xFFFF) << std::dec << "\"],\n";
+			a_out << "\t\t\t\t\"allowVendors\": " << (rng() % 2 ? "true" : "false") << "\n\t\t\t},\n";
+		}
+
+		void WriteChange(std::ofstream& a_out)
+		{
+			const int total = options.addWeight + options.removeWeight + options.keywordWeight + options.replaceWeight;
+			int pick = total > 0 ? static_cast<int>(rng() % total) : 0;
+			if ((pick -= options.addWeight) < 0) {
+				a_out << "\"add\": " << List(rng() % 4 ? items : leveledLists, 1 + rng() % 3) << ", \"count\": " << 1 + rng() % 5;
+			}
+			else if ((pick -= options.removeWeight) < 0) {
+				a_out << "\"remove\": \"" << Reference(items) << "\", \"count\": " << rng() % 3;
+			}
+			else if ((pick -= options.keywordWeight) < 0) {
+				a_out << "\"removeByKeywords\": " << List(keywords, 1 + rng() % 2);
+				if (rng() % 2) {
+					a_out << ", \"add\": " << List(items, 1);
+				}
+			}
+			else {
+				a_out << "\"remove\": \"" << Reference(items) << "\", \"add\": " << List(items, 1 + rng() % 2);
+			}
+		}
+
+		CorpusOptions options;
+		std::mt19937 rng;
+		std::vector<Mod> mods;
+		uint32_t nextLocal{ 0 };
+		std::vector<Form*> items;
+		std::vector<Form*> leveledLists;
+		std::vector<Form*> containers;
+		std::vector<Form*> keywords;
+		std::vector<Form*> locations;
+		std::vector<Form*> worldspaces;
+		std::vector<Form*> globals;
+		std::vector<Form*> quests;
+	};
+}
\ No newline at end of file
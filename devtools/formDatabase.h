@@ -0,0 +1,250 @@
+#pragma once
+
+//Offline stand-in for the game's forms, for tools that run configs through Settings::Config::RuleCompiler
+//without the game. Loaded from the dump written by the "cdf dumpforms" console command (format in
+//src/settings/formDump.h), or filled directly by tools that need a synthetic load order.
+
+#include "settings/configCompiler.h"
+#include "utilities/stringUtilities.h"
+
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace DevTools
+{
+	enum class FormKind : uint8_t
+	{
+		kItem,
+		kLeveledList,
+		kContainer,
+		kKeyword,
+		kLocation,
+		kWorldspace,
+		kGlobal,
+		kQuest
+	};
+
+	struct Form
+	{
+		uint32_t id;
+		FormKind kind;
+		std::string editorID;
+		//Keywords for items, entries for leveled lists, contents for containers.
+		std::vector<uint32_t> links;
+		//Containers only, parallel to links.
+		std::vector<int32_t> counts;
+	};
+
+	struct Mod
+	{
+		std::string name;
+		uint32_t compileIndex;
+		uint32_t smallFileCompileIndex;
+	};
+
+	class FormDatabase
+	{
+	public:
+		void AddMod(std::string a_name, uint32_t a_compileIndex, uint32_t a_smallFileCompileIndex)
+		{
+			auto key = Utilities::String::tolower(a_name);
+			mods.try_emplace(std::move(key), Mod{ std::move(a_name), a_compileIndex, a_smallFileCompileIndex });
+		}
+
+		Form& AddForm(uint32_t a_id, FormKind a_kind, std::string a_editorID)
+		{
+			auto& form = forms.emplace_back(Form{ a_id, a_kind, std::move(a_editorID), {}, {} });
+			byID[a_id] = &form;
+			if (!form.editorID.empty()) {
+				byEditorID.try_emplace(Utilities::String::tolower(form.editorID), &form);
+			}
+			return form;
+		}
+
+		const Mod* FindMod(std::string_view a_name) const
+		{
+			const auto it = mods.find(Utilities::String::tolower(a_name));
+			return it != mods.end() ? &it->second : nullptr;
+		}
+
+		const Form* Find(uint32_t a_id) const
+		{
+			const auto it = byID.find(a_id);
+			return it != byID.end() ? it->second : nullptr;
+		}
+
+		//Case insensitive, like the game's editor ID map.
+		const Form* FindByEditorID(std::string_view a_editorID) const
+		{
+			const auto it = byEditorID.find(Utilities::String::tolower(a_editorID));
+			return it != byEditorID.end() ? it->second : nullptr;
+		}
+
+		const std::deque<Form>& GetForms() const { return forms; }
+
+		bool Load(const std::string& a_path, std::string& a_error)
+		{
+			std::ifstream file{ a_path };
+			if (!file) {
+				a_error = "could not open " + a_path;
+				return false;
+			}
+
+			std::string line{};
+			size_t lineNumber = 0;
+			while (std::getline(file, line)) {
+				++lineNumber;
+				if (!line.empty() && line.back() == '\r') {
+					line.pop_back();
+				}
+				if (lineNumber == 1) {
+					if (!line.starts_with("CDF form dump ")) {
+						a_error = a_path + " is not a form dump";
+						return false;
+					}
+					continue;
+				}
+				if (!line.empty() && !ParseLine(line)) {
+					a_error = a_path + ", line " + std::to_string(lineNumber) + ": malformed record";
+					return false;
+				}
+			}
+			return true;
+		}
+
+	private:
+		static std::vector<std::string_view> SplitAll(std::string_view a_text, char a_delimiter)
+		{
+			std::vector<std::string_view> parts{};
+			if (a_text.empty()) {
+				return parts;
+			}
+			size_t start = 0;
+			while (true) {
+				const auto end = a_text.find(a_delimiter, start);
+				parts.push_back(a_text.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start));
+				if (end == std::string_view::npos) {
+					return parts;
+				}
+				start = end + 1;
+			}
+		}
+
+		bool ParseLine(std::string_view a_line)
+		{
+			const auto fields = SplitAll(a_line, '\t');
+			if (fields.size() != 4) {
+				return false;
+			}
+
+			if (fields[0] == "MOD") {
+				const auto compileIndex = Utilities::String::to_num<uint32_t>(fields[1], true);
+				const auto smallIndex = Utilities::String::to_num<uint32_t>(fields[2], true);
+				if (!compileIndex || !smallIndex) {
+					return false;
+				}
+				AddMod(std::string(fields[3]), *compileIndex, *smallIndex);
+				return true;
+			}
+
+			static constexpr std::pair<std::string_view, FormKind> tags[] = {
+				{ "ITEM", FormKind::kItem },
+				{ "LVLI", FormKind::kLeveledList },
+				{ "CONT", FormKind::kContainer },
+				{ "KYWD", FormKind::kKeyword },
+				{ "LCTN", FormKind::kLocation },
+				{ "WRLD", FormKind::kWorldspace },
+				{ "GLOB", FormKind::kGlobal },
+				{ "QUST", FormKind::kQuest }
+			};
+			const auto tag = std::ranges::find(tags, fields[0], &std::pair<std::string_view, FormKind>::first);
+			const auto id = Utilities::String::to_num<uint32_t>(fields[1], true);
+			if (tag == std::end(tags) || !id) {
+				return false;
+			}
+
+			auto& form = AddForm(*id, tag->second, std::string(fields[2]));
+			for (const auto entry : SplitAll(fields[3], ',')) {
+				const auto parts = Utilities::String::split<2>(entry, "*");
+				const auto link = Utilities::String::to_num<uint32_t>(parts.parts[0], true);
+				if (!link) {
+					return false;
+				}
+				form.links.push_back(*link);
+				if (form.kind == FormKind::kContainer) {
+					const auto count = parts.count == 2 ? Utilities::String::to_num<int32_t>(parts.parts[1]) : std::nullopt;
+					if (!count) {
+						return false;
+					}
+					form.counts.push_back(*count);
+				}
+			}
+			return true;
+		}
+
+		std::deque<Form> forms;
+		std::unordered_map<uint32_t, Form*> byID;
+		std::unordered_map<std::string, Form*> byEditorID;
+		std::unordered_map<std::string, Mod> mods;
+	};
+
+	//Settings::Config::RuleCompiler resolver over a FormDatabase. Mirrors Settings::FormResolver, form
+	//strings are "0xID|Plugin.esp" or an editor ID.
+	class DatabaseResolver
+	{
+	public:
+		using Item = const Form*;
+		using Container = const Form*;
+		using Location = const Form*;
+		using Worldspace = const Form*;
+		using Keyword = const Form*;
+		using Global = const Form*;
+		using Quest = const Form*;
+		using Rule = Settings::Config::CompiledRule<DatabaseResolver>;
+
+		explicit DatabaseResolver(const FormDatabase& a_database) :
+			database(a_database)
+		{}
+
+		bool HasMod(std::string_view a_name) { return database.FindMod(a_name) != nullptr; }
+
+		Item ResolveItem(std::string_view a_identifier)
+		{
+			const auto form = Resolve(a_identifier);
+			return form && (form->kind == FormKind::kItem || form->kind == FormKind::kLeveledList) ? form : nullptr;
+		}
+		Container ResolveContainer(std::string_view a_identifier) { return Of(Resolve(a_identifier), FormKind::kContainer); }
+		Location ResolveLocation(std::string_view a_identifier) { return Of(Resolve(a_identifier), FormKind::kLocation); }
+		Worldspace ResolveWorldspace(std::string_view a_identifier) { return Of(Resolve(a_identifier), FormKind::kWorldspace); }
+		Keyword ResolveKeyword(std::string_view a_identifier) { return Of(Resolve(a_identifier), FormKind::kKeyword); }
+
+		Keyword FindKeyword(std::string_view a_editorID) { return Of(database.FindByEditorID(a_editorID), FormKind::kKeyword); }
+		Global FindGlobal(std::string_view a_editorID) { return Of(database.FindByEditorID(a_editorID), FormKind::kGlobal); }
+		Quest FindQuest(std::string_view a_editorID) { return Of(database.FindByEditorID(a_editorID), FormKind::kQuest); }
+
+	private:
+		static const Form* Of(const Form* a_form, FormKind a_kind) { return a_form && a_form->kind == a_kind ? a_form : nullptr; }
+
+		const Form* Resolve(std::string_view a_identifier)
+		{
+			const auto splitID = Utilities::String::split<2>(a_identifier, "|");
+			if (splitID.count != 2) {
+				return database.FindByEditorID(a_identifier);
+			}
+
+			if (!Utilities::String::is_only_hex(splitID.parts[0])) return nullptr;
+			const auto rawFormID = Utilities::String::to_num<uint32_t>(splitID.parts[0], true);
+			const auto* mod = database.FindMod(splitID.parts[1]);
+			if (!rawFormID || !mod) return nullptr;
+
+			return database.Find((mod->compileIndex << 24) + (mod->smallFileCompileIndex << 12) + *rawFormID);
+		}
+
+		const FormDatabase& database;
+	};
+}
\ No newline at end of file
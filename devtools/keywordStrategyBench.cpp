@@ -0,0 +1,144 @@
+//Benchmarks the keyword rule matching strategies from src/rules/keywordMatcher.h over synthetic
+//inventories and rule sets, and prints the fastest strategy per (inventory size, rule count).
+//Items carry 3-6 keywords drawn from a pool of common keywords, rules require 1-2 keywords drawn from
+//a wider pool, so most rules don't match most containers, which is what real configs look like.
+
+#include "rules/keywordMatcher.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+namespace
+{
+	using Keyword = uint32_t;
+	using Strategy = Rules::KeywordMatching::Strategy;
+
+	struct Item
+	{
+		std::vector<Keyword> keywords;
+	};
+
+	struct Rule
+	{
+		std::vector<Keyword> keywords;
+	};
+
+	constexpr size_t kItemKeywordPool = 120;
+	constexpr size_t kRuleKeywordPool = 300;
+	constexpr size_t kContainers = 64;
+
+	std::vector<Item> MakeInventory(std::mt19937& a_rng, size_t a_size)
+	{
+		std::uniform_int_distribution<size_t> keywordCount(3, 6);
+		std::uniform_int_distribution<Keyword> keyword(0, kItemKeywordPool - 1);
+		std::vector<Item> items(a_size);
+		for (auto& item : items) {
+			const auto count = keywordCount(a_rng);
+			for (size_t i = 0; i < count; ++i) {
+				item.keywords.push_back(keyword(a_rng));
+			}
+		}
+		return items;
+	}
+
+	std::vector<Rule> MakeRules(std::mt19937& a_rng, size_t a_count)
+	{
+		std::uniform_int_distribution<size_t> keywordCount(1, 2);
+		std::uniform_int_distribution<Keyword> keyword(0, kRuleKeywordPool - 1);
+		std::vector<Rule> rules(a_count);
+		for (auto& rule : rules) {
+			const auto count = keywordCount(a_rng);
+			for (size_t i = 0; i < count; ++i) {
+				rule.keywords.push_back(keyword(a_rng));
+			}
+		}
+		return rules;
+	}
+
+	double Measure(Strategy a_strategy, const std::vector<std::vector<Item>>& a_inventories, const std::vector<Rule>& a_rules, size_t& a_checksum)
+	{
+		std::vector<std::vector<uint32_t>> matches{};
+		size_t iterations = 0;
+		const auto start = std::chrono::steady_clock::now();
+		auto now = start;
+		do {
+			for (const auto& inventory : a_inventories) {
+				Rules::KeywordMatching::Match<Item, Keyword>(
+					a_strategy, std::span<const Item>(inventory), a_rules.size(),
+					[&](size_t a_rule) { return std::span<const Keyword>(a_rules[a_rule].keywords); },
+					[](const Item& a_item, Keyword a_keyword) {
+						return std::find(a_item.keywords.begin(), a_item.keywords.end(), a_keyword) != a_item.keywords.end();
+					},
+					[](const Item& a_item, auto&& a_callback) {
+						for (const auto keyword : a_item.keywords) {
+							a_callback(keyword);
+						}
+					},
+					matches);
+				for (const auto& ruleMatches : matches) {
+					a_checksum += ruleMatches.size();
+				}
+			}
+			iterations += a_inventories.size();
+			now = std::chrono::steady_clock::now();
+		} while (now - start < std::chrono::milliseconds(20));
+
+		return std::chrono::duration<double, std::nano>(now - start).count() / static_cast<double>(iterations);
+	}
+
+	const char* GetName(Strategy a_strategy)
+	{
+		switch (a_strategy) {
+		case Strategy::kPerRule:
+			return "per-rule";
+		case Strategy::kKeywordPrefilter:
+			return "prefilter";
+		case Strategy::kFused:
+			return "fused";
+		default:
+			return "?";
+		}
+	}
+}
+
+int main()
+{
+	std::mt19937 rng{ 1234 };
+	constexpr size_t inventorySizes[] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+	constexpr size_t ruleCounts[] = { 1, 2, 4, 8, 16, 32, 64, 128, 256 };
+
+	size_t checksum = 0;
+	size_t agreements = 0;
+	size_t total = 0;
+	std::printf("%6s %6s | %12s %12s %12s | %-10s %-10s\n", "items", "rules", "per-rule ns", "prefilter ns", "fused ns", "fastest", "chosen");
+	for (const auto items : inventorySizes) {
+		std::vector<std::vector<Item>> inventories{};
+		for (size_t i = 0; i < kContainers; ++i) {
+			inventories.push_back(MakeInventory(rng, items));
+		}
+
+		for (const auto ruleCount : ruleCounts) {
+			const auto rules = MakeRules(rng, ruleCount);
+
+			double timings[static_cast<size_t>(Strategy::kTotal)]{};
+			size_t best = 0;
+			for (size_t strategy = 0; strategy < static_cast<size_t>(Strategy::kTotal); ++strategy) {
+				timings[strategy] = Measure(static_cast<Strategy>(strategy), inventories, rules, checksum);
+				if (timings[strategy] < timings[best]) {
+					best = strategy;
+				}
+			}
+
+			const auto chosen = Rules::KeywordMatching::Choose({ items, ruleCount });
+			//Within 10% of the fastest counts as a good pick, timings at this scale are noisy.
+			const bool good = timings[static_cast<size_t>(chosen)] <= timings[best] * 1.1;
+			agreements += good ? 1 : 0;
+			++total;
+			std::printf("%6zu %6zu | %12.0f %12.0f %12.0f | %-10s %-10s%s\n", items, ruleCount,
+				timings[0], timings[1], timings[2], GetName(static_cast<Strategy>(best)), GetName(chosen), good ? "" : "  <-");
+		}
+	}
+	std::printf("Choose() within 10%% of the fastest strategy in %zu of %zu cases (checksum %zu).\n", agreements, total, checksum);
+	return 0;
+}
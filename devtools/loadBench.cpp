@@ -0,0 +1,288 @@
+//Measures how config loading scales with the size of a config corpus. Generates a synthetic load order
+//and corpus (see corpusGenerator.h), then times the three load phases against the mock form database:
+//decoding, checking and resolving through Settings::Config::RuleCompiler, and registering the result
+//the way Settings::JSON::ReadConfig and ContainerManager::RegisterRule do. Each size is loaded in a
+//fresh process so peak memory is its own.
+//
+//	loadBench [--files N] [--rules N] [--conditions PCT] [--editor-ids PCT] [--missing PCT]
+//	          [--mix add:remove:keyword:replace] [--keep DIR]
+//	loadBench --sweep [options]     10, 100, 1000 and 10000 files
+//	loadBench --load <corpus dir>   internal, one measured load
+
+#include "corpusGenerator.h"
+#include "formDatabase.h"
+
+#include "settings/configCompiler.h"
+#include "settings/configDecoder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#	define WIN32_LEAN_AND_MEAN
+#	define NOMINMAX
+#	include <Windows.h>
+#	include <Psapi.h>
+#else
+#	include <sys/resource.h>
+#endif
+
+namespace
+{
+	using DevTools::Form;
+	using Rule = DevTools::DatabaseResolver::Rule;
+	using Clock = std::chrono::steady_clock;
+
+	size_t PeakMemoryKiB()
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters{};
+		::GetProcessMemoryInfo(::GetCurrentProcess(), &counters, sizeof(counters));
+		return counters.PeakWorkingSetSize / 1024;
+#else
+		rusage usage{};
+		::getrusage(RUSAGE_SELF, &usage);
+		return static_cast<size_t>(usage.ru_maxrss);
+#endif
+	}
+
+	double Milliseconds(Clock::time_point a_start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - a_start).count();
+	}
+
+	//Stand-ins for the condition objects, Rules::RuleData and Rules::RuleLists, with the same allocations.
+	struct MockSpan
+	{
+		uint32_t offset;
+		uint32_t size;
+	};
+
+	struct MockCondition
+	{
+		bool inverted;
+		std::vector<const Form*> forms;
+		std::vector<uint32_t> ids;
+		std::string name;
+		float value;
+	};
+
+	struct MockRule
+	{
+		uint8_t type;
+		uint8_t flags;
+		uint32_t count;
+		const Form* target;
+		MockSpan conditions;
+		MockSpan forms;
+		MockSpan keywords;
+		uint32_t source;
+	};
+
+	class MockManager
+	{
+	public:
+		void Register(const std::string& a_path, Rule& a_rule)
+		{
+			std::vector<size_t> targets{};
+			auto store = [&](MockCondition a_condition) {
+				targets.push_back(conditions.size());
+				conditions.push_back(std::make_shared<MockCondition>(std::move(a_condition)));
+			};
+			for (const auto& skill : a_rule.skills) store({ skill.inverted, {}, {}, std::string(skill.name), skill.level });
+			for (auto& set : a_rule.containers) store({ set.inverted, std::move(set.forms), {}, {}, 0.0f });
+			for (const auto& global : a_rule.globals) store({ global.inverted, { global.global }, {}, {}, global.value });
+			for (auto& set : a_rule.locations) store({ set.inverted, std::move(set.forms), {}, {}, 0.0f });
+			for (auto& set : a_rule.locationKeywords) store({ set.inverted, std::move(set.forms), {}, {}, 0.0f });
+			for (auto& quest : a_rule.quests) store({ quest.inverted, { quest.quest }, { quest.stages.begin(), quest.stages.end() }, {}, 0.0f });
+			for (auto& set : a_rule.references) store({ set.inverted, {}, std::move(set.ids), {}, 0.0f });
+			for (auto& set : a_rule.worldspaces) store({ set.inverted, std::move(set.forms), {}, {}, 0.0f });
+
+			sources.emplace_back(a_path, std::string(a_rule.friendlyName));
+			//Once per config entry, like ContainerManager::InternConditions.
+			const auto conditionSpan = Append(conditionArena, targets);
+			const auto flags = static_cast<uint8_t>(a_rule.allowVendors | a_rule.onlyVendors << 1 | a_rule.bypassUnsafeContainers << 2 | a_rule.randomAdd << 3);
+			for (auto& change : a_rule.changes) {
+				//Type and count as in RegisterRule.
+				MockRule rule{ 0, flags, 0, change.remove, conditionSpan, {}, {}, static_cast<uint32_t>(sources.size() - 1) };
+				if (change.add && change.removeKeywords) rule.type = 4;
+				else if (change.add && change.remove) rule.type = 3;
+				else if (change.removeKeywords) rule.type = 2;
+				else if (change.remove) {
+					rule.type = 1;
+					rule.count = change.count.value_or(0);
+				}
+				else if (change.add) rule.count = change.count.value_or(1);
+				else continue;
+
+				if (change.add) rule.forms = Append(formArena, *change.add);
+				if (change.removeKeywords) rule.keywords = Append(keywordArena, *change.removeKeywords);
+				rules.push_back(std::move(rule));
+			}
+		}
+
+		size_t GetRuleCount() const { return rules.size(); }
+		size_t GetConditionCount() const { return conditions.size(); }
+
+	private:
+		//Appends without the lookup for identical lists, which the synthetic corpus hardly has.
+		template <class T, class U>
+		static MockSpan Append(std::vector<T>& a_arena, const std::vector<U>& a_values)
+		{
+			const MockSpan span{ static_cast<uint32_t>(a_arena.size()), static_cast<uint32_t>(a_values.size()) };
+			a_arena.insert(a_arena.end(), a_values.begin(), a_values.end());
+			return span;
+		}
+
+		std::vector<std::shared_ptr<MockCondition>> conditions;
+		std::vector<uint32_t> conditionArena;
+		std::vector<const Form*> formArena;
+		std::vector<const Form*> keywordArena;
+		std::vector<MockRule> rules;
+		std::vector<std::pair<std::string, std::string>> sources;
+	};
+
+	int Load(const std::filesystem::path& a_directory)
+	{
+		DevTools::FormDatabase database{};
+		std::string error{};
+		if (!database.Load((a_directory / "forms.txt").string(), error)) {
+			std::fprintf(stderr, "%s\n", error.c_str());
+			return 1;
+		}
+		const auto baseline = PeakMemoryKiB();
+
+		std::vector<std::string> paths{};
+		for (const auto& entry : std::filesystem::directory_iterator(a_directory)) {
+			if (entry.path().extension() == ".json") {
+				paths.push_back(entry.path().string());
+			}
+		}
+		std::ranges::sort(paths);
+
+		//Decode everything first, like the background read in Settings::JSON::BeginRead.
+		auto start = Clock::now();
+		std::vector<Settings::Config::ConfigFile> files(paths.size());
+		for (size_t i = 0; i < paths.size(); ++i) {
+			if (!Settings::Config::Decode(paths[i], files[i], error)) {
+				std::fprintf(stderr, "%s\n", error.c_str());
+				return 1;
+			}
+		}
+		const double decodeTime = Milliseconds(start);
+
+		start = Clock::now();
+		DevTools::DatabaseResolver resolver{ database };
+		size_t messages = 0;
+		auto report = [&](Settings::Config::Severity, const std::string&) { ++messages; };
+		std::vector<std::vector<Rule>> compiled(paths.size());
+		size_t configRules = 0;
+		for (size_t i = 0; i < paths.size(); ++i) {
+			Settings::Config::CompileRules(files[i], paths[i], resolver, report, [&](Rule& a_rule) { compiled[i].push_back(std::move(a_rule)); });
+			configRules += compiled[i].size();
+		}
+		const double compileTime = Milliseconds(start);
+
+		start = Clock::now();
+		MockManager manager{};
+		for (size_t i = 0; i < paths.size(); ++i) {
+			for (auto& rule : compiled[i]) {
+				manager.Register(paths[i], rule);
+			}
+			compiled[i].clear();
+			files[i] = {};
+		}
+		const double registerTime = Milliseconds(start);
+
+		const double total = decodeTime + compileTime + registerTime;
+		const auto rules = static_cast<double>(manager.GetRuleCount());
+		auto rate = [&](double a_ms) { return a_ms > 0.0 ? rules / a_ms * 1000.0 : 0.0; };
+		std::printf("%6zu files %8zu config rules %8zu rules %8zu conditions %6zu messages\n", paths.size(), configRules, manager.GetRuleCount(), manager.GetConditionCount(), messages);
+		std::printf("  decode    %10.2f ms %12.0f rules/s\n", decodeTime, rate(decodeTime));
+		std::printf("  compile   %10.2f ms %12.0f rules/s\n", compileTime, rate(compileTime));
+		std::printf("  register  %10.2f ms %12.0f rules/s\n", registerTime, rate(registerTime));
+		std::printf("  total     %10.2f ms %12.0f rules/s   peak %zu KiB (%zu KiB over the form database)\n", total, rate(total), PeakMemoryKiB(), PeakMemoryKiB() - baseline);
+		return 0;
+	}
+
+	bool ParseMix(const char* a_text, DevTools::CorpusOptions& a_options)
+	{
+		return std::sscanf(a_text, "%d:%d:%d:%d", &a_options.addWeight, &a_options.removeWeight, &a_options.keywordWeight, &a_options.replaceWeight) == 4;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc == 3 && std::string(argv[1]) == "--load") {
+		return Load(argv[2]);
+	}
+
+	DevTools::CorpusOptions options{};
+	std::vector<size_t> sizes{};
+	std::filesystem::path keep{};
+	for (int i = 1; i < argc; ++i) {
+		const std::string argument = argv[i];
+		const bool hasValue = i + 1 < argc;
+		if (argument == "--sweep") {
+			sizes = { 10, 100, 1000, 10000 };
+		}
+		else if (argument == "--files" && hasValue) {
+			options.files = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else if (argument == "--rules" && hasValue) {
+			options.rulesPerFile = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else if (argument == "--conditions" && hasValue) {
+			options.conditionChance = std::atoi(argv[++i]);
+		}
+		else if (argument == "--editor-ids" && hasValue) {
+			options.editorIDShare = std::atoi(argv[++i]);
+		}
+		else if (argument == "--missing" && hasValue) {
+			options.missingShare = std::atoi(argv[++i]);
+		}
+		else if (argument == "--mix" && hasValue && ParseMix(argv[i + 1], options)) {
+			++i;
+		}
+		else if (argument == "--keep" && hasValue) {
+			keep = argv[++i];
+		}
+		else {
+			std::fprintf(stderr, "unknown or incomplete argument %s\n", argument.c_str());
+			return 2;
+		}
+	}
+	if (sizes.empty()) {
+		sizes.push_back(options.files);
+	}
+
+	std::printf("%zu rules per file, %d%% condition chance, %d%% editor IDs, %d%% missing forms, mix %d:%d:%d:%d\n",
+		options.rulesPerFile, options.conditionChance, options.editorIDShare, options.missingShare,
+		options.addWeight, options.removeWeight, options.keywordWeight, options.replaceWeight);
+
+	int result = 0;
+	for (const auto size : sizes) {
+		options.files = size;
+		const auto directory = !keep.empty() && sizes.size() == 1 ? keep : std::filesystem::temp_directory_path() / "cdfLoadBench";
+
+		DevTools::CorpusGenerator generator{ options };
+		DevTools::FormDatabase database{};
+		generator.BuildDatabase(database);
+		generator.WriteCorpus(directory);
+		DevTools::CorpusGenerator::WriteDump(directory / "forms.txt", database, generator.GetMods());
+
+		const auto command = "\"" + std::string(argv[0]) + "\" --load \"" + directory.string() + "\"";
+		std::fflush(stdout);
+		result |= std::system(command.c_str());
+		if (directory != keep) {
+			std::filesystem::remove_all(directory);
+		}
+	}
+	return result;
+}
\ No newline at end of file
@@ -0,0 +1,135 @@
+//Test producer for statsViewer. Publishes the live statistics block the way the plugin does and fills
+//it with synthetic hook traffic from a few threads, so the viewer and the shared memory layout can be
+//tried without the game.
+//
+//	statsProducer [--seconds N] [--threads N] [--rules N]
+
+#include "profiling/sharedMemory.h"
+#include "profiling/statsBlock.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#	include <process.h>
+#	define getpid _getpid
+#else
+#	include <unistd.h>
+#endif
+
+namespace
+{
+	namespace Stats = Profiling::Stats;
+
+	std::atomic<bool> stop{ false };
+
+	void OnSignal(int)
+	{
+		stop = true;
+	}
+
+	//One container through the hooks, with the same counters and phases the plugin records.
+	void Simulate(Stats::Block& a_block, std::mt19937& a_rng, size_t a_rules)
+	{
+		std::uniform_int_distribution<int> percent(0, 99);
+		std::lognormal_distribution<double> latency(8.0, 1.2);
+		std::geometric_distribution<size_t> popularRule(0.02);
+		auto nanoseconds = [&]() { return static_cast<uint64_t>(latency(a_rng)); };
+
+		const size_t hook = percent(a_rng) < 80 ? 0 : 1;
+		a_block.hookCalls[hook].fetch_add(1, std::memory_order_relaxed);
+		const bool merchantLookup = percent(a_rng) < 90;
+		if (merchantLookup) {
+			a_block.merchantLookups.fetch_add(1, std::memory_order_relaxed);
+			a_block.merchantHits.fetch_add(percent(a_rng) < 5 ? 1 : 0, std::memory_order_relaxed);
+		}
+
+		uint64_t total = nanoseconds() / 8;
+		if (percent(a_rng) < 60) {
+			a_block.prefilterRejected.fetch_add(1, std::memory_order_relaxed);
+		}
+		else {
+			a_block.prefilterPassed.fetch_add(1, std::memory_order_relaxed);
+			a_block.BeginProcessing();
+			(percent(a_rng) < 85 ? a_block.candidateHits : a_block.candidateMisses).fetch_add(1, std::memory_order_relaxed);
+			uint64_t processing = 0;
+			for (auto visits = 1 + a_rng() % 6; visits > 0; --visits) {
+				const auto rule = std::min(popularRule(a_rng), a_rules - 1);
+				const auto type = rule % Stats::ruleTypeCount;
+				a_block.ruleVisits[type].fetch_add(1, std::memory_order_relaxed);
+				const auto time = nanoseconds();
+				a_block.RecordLatency(3 + type, time);
+				processing += time;
+				if (percent(a_rng) < 30) {
+					a_block.RuleApplied(rule, type);
+				}
+			}
+			a_block.RecordLatency(2, processing);
+			a_block.EndProcessing();
+			total += processing;
+		}
+		a_block.RecordLatency(hook, total);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	long seconds = 30;
+	size_t threads = 4;
+	size_t rules = 500;
+	for (int i = 1; i < argc; ++i) {
+		const std::string argument = argv[i];
+		const bool hasValue = i + 1 < argc;
+		if (argument == "--seconds" && hasValue) {
+			seconds = std::atol(argv[++i]);
+		}
+		else if (argument == "--threads" && hasValue) {
+			threads = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+		}
+		else if (argument == "--rules" && hasValue) {
+			rules = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+		}
+		else {
+			std::fprintf(stderr, "unknown or incomplete argument %s\n", argument.c_str());
+			return 2;
+		}
+	}
+
+	Profiling::SharedMemory memory{};
+	std::string error{};
+	if (!memory.Create(Stats::mappingName, sizeof(Stats::Block), error)) {
+		std::fprintf(stderr, "%s\n", error.c_str());
+		return 1;
+	}
+	auto& block = *static_cast<Stats::Block*>(memory.GetData());
+	block.Publish(static_cast<uint32_t>(getpid()));
+	block.ResetRules(rules);
+	std::printf("Publishing %s (%zu bytes) for %ld s from %zu threads.\n", Stats::mappingName, sizeof(Stats::Block), seconds, threads);
+	std::fflush(stdout);
+
+	//Unlinks the mapping on Ctrl+C too.
+	std::signal(SIGINT, OnSignal);
+	std::signal(SIGTERM, OnSignal);
+	const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+	std::vector<std::thread> workers{};
+	for (size_t i = 0; i < threads; ++i) {
+		workers.emplace_back([&, i]() {
+			std::mt19937 rng(static_cast<uint32_t>(1234 + i));
+			while (!stop && std::chrono::steady_clock::now() < end) {
+				Simulate(block, rng, rules);
+				std::this_thread::sleep_for(std::chrono::microseconds(200));
+			}
+		});
+	}
+	for (auto& worker : workers) {
+		worker.join();
+	}
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,236 @@
+//Live view of the statistics block the plugin publishes with [Profiling] bLiveStats=true in its INI
+//(layout in src/profiling/statsBlock.h). Rates are per second over the last refresh. Latency
+//percentiles come from power of two buckets, so they are upper bounds.
+//
+//	statsViewer [--interval MS] [--count N]     refresh every MS ms (1000), stop after N refreshes
+
+#include "profiling/sharedMemory.h"
+#include "profiling/statsBlock.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#	define WIN32_LEAN_AND_MEAN
+#	define NOMINMAX
+#	include <Windows.h>
+#	include <io.h>
+#	define isatty _isatty
+#	define fileno _fileno
+#else
+#	include <unistd.h>
+#endif
+
+namespace
+{
+	namespace Stats = Profiling::Stats;
+
+	//Plain copy of the counters, read once per refresh.
+	struct Sample
+	{
+		uint64_t generation;
+		uint64_t ruleCount;
+		std::array<uint64_t, Stats::hookCount> hookCalls;
+		uint64_t processed;
+		uint64_t inFlight;
+		uint64_t maxInFlight;
+		uint64_t prefilterPassed;
+		uint64_t prefilterRejected;
+		uint64_t candidateHits;
+		uint64_t candidateMisses;
+		uint64_t merchantLookups;
+		uint64_t merchantHits;
+		std::array<uint64_t, Stats::ruleTypeCount> ruleVisits;
+		std::array<uint64_t, Stats::ruleTypeCount> ruleApplications;
+		std::array<std::array<uint64_t, Stats::latencyBucketCount>, Stats::phaseCount> latency;
+		std::vector<uint64_t> ruleHits;
+	};
+
+	uint64_t Load(const Stats::Counter& a_counter)
+	{
+		return a_counter.load(std::memory_order_relaxed);
+	}
+
+	void Read(const Stats::Block& a_block, Sample& a_sample)
+	{
+		a_sample.generation = a_block.generation.load(std::memory_order_acquire);
+		a_sample.ruleCount = Load(a_block.ruleCount);
+		for (size_t i = 0; i < Stats::hookCount; ++i) a_sample.hookCalls[i] = Load(a_block.hookCalls[i]);
+		a_sample.processed = Load(a_block.processed);
+		a_sample.inFlight = Load(a_block.inFlight);
+		a_sample.maxInFlight = Load(a_block.maxInFlight);
+		a_sample.prefilterPassed = Load(a_block.prefilterPassed);
+		a_sample.prefilterRejected = Load(a_block.prefilterRejected);
+		a_sample.candidateHits = Load(a_block.candidateHits);
+		a_sample.candidateMisses = Load(a_block.candidateMisses);
+		a_sample.merchantLookups = Load(a_block.merchantLookups);
+		a_sample.merchantHits = Load(a_block.merchantHits);
+		for (size_t i = 0; i < Stats::ruleTypeCount; ++i) {
+			a_sample.ruleVisits[i] = Load(a_block.ruleVisits[i]);
+			a_sample.ruleApplications[i] = Load(a_block.ruleApplications[i]);
+		}
+		for (size_t phase = 0; phase < Stats::phaseCount; ++phase) {
+			for (size_t bucket = 0; bucket < Stats::latencyBucketCount; ++bucket) {
+				a_sample.latency[phase][bucket] = Load(a_block.latency[phase][bucket]);
+			}
+		}
+		a_sample.ruleHits.resize(Stats::trackedRuleCount);
+		for (size_t rule = 0; rule < Stats::trackedRuleCount; ++rule) {
+			a_sample.ruleHits[rule] = Load(a_block.ruleHits[rule]);
+		}
+	}
+
+	double Percent(uint64_t a_part, uint64_t a_whole)
+	{
+		return a_whole ? 100.0 * static_cast<double>(a_part) / static_cast<double>(a_whole) : 0.0;
+	}
+
+	//Upper bound of the bucket holding the a_percentile'th sample, in microseconds.
+	double Percentile(const std::array<uint64_t, Stats::latencyBucketCount>& a_buckets, uint64_t a_count, double a_percentile)
+	{
+		const auto rank = static_cast<uint64_t>(a_percentile / 100.0 * static_cast<double>(a_count) + 0.999999);
+		uint64_t seen = 0;
+		for (size_t bucket = 0; bucket < a_buckets.size(); ++bucket) {
+			seen += a_buckets[bucket];
+			if (seen >= rank && seen > 0) {
+				return static_cast<double>(uint64_t{ 2 } << bucket) / 1000.0;
+			}
+		}
+		return 0.0;
+	}
+
+	void Print(const Stats::Block& a_block, const Sample& a_now, const Sample& a_then, double a_seconds, bool a_clear)
+	{
+		auto rate = [&](uint64_t a_now, uint64_t a_then) { return a_seconds > 0.0 ? static_cast<double>(a_now - a_then) / a_seconds : 0.0; };
+		if (a_clear) {
+			std::printf("\x1b[H\x1b[2J");
+		}
+		std::printf("CDF live statistics, process %u, layout %u, %llu rules\n\n", a_block.processID, a_block.version, static_cast<unsigned long long>(a_now.ruleCount));
+
+		std::printf("%-26s %12s %10s\n", "Hooks", "total", "per s");
+		for (size_t i = 0; i < Stats::hookCount; ++i) {
+			std::printf("  %-24s %12llu %10.1f\n", Stats::hookNames[i], static_cast<unsigned long long>(a_now.hookCalls[i]), rate(a_now.hookCalls[i], a_then.hookCalls[i]));
+		}
+		std::printf("  %-24s %12llu %10.1f   in flight %llu, at most %llu\n", "Processed", static_cast<unsigned long long>(a_now.processed),
+			rate(a_now.processed, a_then.processed), static_cast<unsigned long long>(a_now.inFlight), static_cast<unsigned long long>(a_now.maxInFlight));
+
+		std::printf("\n%-26s %12s %10s\n", "Caches", "lookups", "hit rate");
+		std::printf("  %-24s %12llu %9.1f%%\n", "Prefilter (skips)", static_cast<unsigned long long>(a_now.prefilterPassed + a_now.prefilterRejected),
+			Percent(a_now.prefilterRejected, a_now.prefilterPassed + a_now.prefilterRejected));
+		std::printf("  %-24s %12llu %9.1f%%\n", "Candidate index", static_cast<unsigned long long>(a_now.candidateHits + a_now.candidateMisses),
+			Percent(a_now.candidateHits, a_now.candidateHits + a_now.candidateMisses));
+		std::printf("  %-24s %12llu %9.1f%%\n", "Merchant containers", static_cast<unsigned long long>(a_now.merchantLookups), Percent(a_now.merchantHits, a_now.merchantLookups));
+
+		std::printf("\n%-26s %12s %10s %12s %10s\n", "Rules", "visits", "per s", "applied", "per s");
+		for (size_t i = 0; i < Stats::ruleTypeCount; ++i) {
+			std::printf("  %-24s %12llu %10.1f %12llu %10.1f\n", Stats::ruleTypeNames[i], static_cast<unsigned long long>(a_now.ruleVisits[i]),
+				rate(a_now.ruleVisits[i], a_then.ruleVisits[i]), static_cast<unsigned long long>(a_now.ruleApplications[i]),
+				rate(a_now.ruleApplications[i], a_then.ruleApplications[i]));
+		}
+
+		std::printf("\n%-26s %12s %9s %9s %9s %9s %9s  (us)\n", "Latency", "samples", "p50", "p90", "p99", "p99.9", "max");
+		for (size_t phase = 0; phase < Stats::phaseCount; ++phase) {
+			const auto& buckets = a_now.latency[phase];
+			uint64_t count = 0;
+			size_t highest = 0;
+			for (size_t bucket = 0; bucket < buckets.size(); ++bucket) {
+				count += buckets[bucket];
+				highest = buckets[bucket] ? bucket : highest;
+			}
+			if (count == 0) {
+				continue;
+			}
+			std::printf("  %-24s %12llu %9.1f %9.1f %9.1f %9.1f %9.1f\n", Stats::phaseNames[phase], static_cast<unsigned long long>(count),
+				Percentile(buckets, count, 50.0), Percentile(buckets, count, 90.0), Percentile(buckets, count, 99.0), Percentile(buckets, count, 99.9),
+				static_cast<double>(uint64_t{ 2 } << highest) / 1000.0);
+		}
+
+		//Rule numbers are rule table indices, as in "cdf explain".
+		std::vector<std::pair<uint64_t, size_t>> recent{};
+		const bool sameRules = a_now.generation == a_then.generation;
+		for (size_t rule = 0; rule < a_now.ruleHits.size(); ++rule) {
+			const auto delta = a_now.ruleHits[rule] - (sameRules ? a_then.ruleHits[rule] : 0);
+			if (delta > 0) {
+				recent.emplace_back(delta, rule);
+			}
+		}
+		const auto shown = std::min<size_t>(recent.size(), 10);
+		std::partial_sort(recent.begin(), recent.begin() + shown, recent.end(), [](const auto& a_left, const auto& a_right) { return a_left.first > a_right.first; });
+		std::printf("\nMost applied rules since the last refresh:\n");
+		for (size_t i = 0; i < shown; ++i) {
+			const auto rule = recent[i].second;
+			std::printf("  #%-6zu %10.1f per s %12llu total\n", rule, rate(recent[i].first, 0), static_cast<unsigned long long>(a_now.ruleHits[rule]));
+		}
+		std::fflush(stdout);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	int interval = 1000;
+	long count = -1;
+	for (int i = 1; i < argc; ++i) {
+		const std::string argument = argv[i];
+		const bool hasValue = i + 1 < argc;
+		if (argument == "--interval" && hasValue) {
+			interval = std::max(50, std::atoi(argv[++i]));
+		}
+		else if (argument == "--count" && hasValue) {
+			count = std::atol(argv[++i]);
+		}
+		else {
+			std::fprintf(stderr, "unknown or incomplete argument %s\n", argument.c_str());
+			return 2;
+		}
+	}
+
+	const bool clear = isatty(fileno(stdout)) != 0;
+#ifdef _WIN32
+	if (clear) {
+		const auto console = ::GetStdHandle(STD_OUTPUT_HANDLE);
+		DWORD mode = 0;
+		if (::GetConsoleMode(console, &mode)) {
+			::SetConsoleMode(console, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+		}
+	}
+#endif
+
+	Profiling::SharedMemory memory{};
+	std::string error{};
+	bool waiting = false;
+	while (!memory.Open(Stats::mappingName, sizeof(Stats::Block), error) || !static_cast<const Stats::Block*>(memory.GetData())->IsValid()) {
+		if (memory.GetData()) {
+			const auto* block = static_cast<const Stats::Block*>(memory.GetData());
+			if (block->magic.load(std::memory_order_acquire) == Stats::magic && block->version != Stats::version) {
+				std::fprintf(stderr, "The plugin publishes layout version %u, this viewer reads version %u.\n", block->version, Stats::version);
+				return 1;
+			}
+		}
+		if (!waiting) {
+			std::fprintf(stderr, "Waiting for %s (set bLiveStats=true under [Profiling] in the plugin's INI)...\n", Stats::mappingName);
+			waiting = true;
+		}
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+	}
+
+	const auto& block = *static_cast<const Stats::Block*>(memory.GetData());
+	Sample then{};
+	Read(block, then);
+	auto lastRead = std::chrono::steady_clock::now();
+	for (long refresh = 0; count < 0 || refresh < count; ++refresh) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+		Sample now{};
+		Read(block, now);
+		const auto time = std::chrono::steady_clock::now();
+		Print(block, now, then, std::chrono::duration<double>(time - lastRead).count(), clear);
+		then = std::move(now);
+		lastRead = time;
+	}
+	return 0;
+}
\ No newline at end of file
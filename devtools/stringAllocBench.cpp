@@ -0,0 +1,141 @@
+//Counts heap allocations and time on the form string path ("0xID|Plugin.esp" -> id + plugin name)
+//and the "Name|Value" path of playerSkills/globals, comparing the old vector<string> split + std::stoul
+//helpers with the string_view split + from_chars ones in src/utilities/stringUtilities.h.
+
+#include "utilities/stringUtilities.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace
+{
+	std::atomic<size_t> allocations{ 0 };
+}
+
+void* operator new(size_t a_size)
+{
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* result = std::malloc(a_size ? a_size : 1)) {
+		return result;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* a_pointer) noexcept
+{
+	std::free(a_pointer);
+}
+
+void operator delete(void* a_pointer, size_t) noexcept
+{
+	std::free(a_pointer);
+}
+
+namespace
+{
+	//The helpers as they were before, for comparison.
+	namespace Legacy
+	{
+		std::vector<std::string> split(const std::string& a_str, const std::string& a_delimiter)
+		{
+			std::vector<std::string> result;
+			size_t start = 0;
+			size_t end = a_str.find(a_delimiter);
+			while (end != std::string::npos) {
+				result.push_back(a_str.substr(start, end - start));
+				start = end + a_delimiter.length();
+				end = a_str.find(a_delimiter, start);
+			}
+			result.push_back(a_str.substr(start));
+			return result;
+		}
+
+		uint32_t ParseFormString(const std::string& a_identifier, size_t& a_pluginLength)
+		{
+			const auto splitID = split(a_identifier, "|");
+			if (splitID.size() != 2 || !Utilities::String::is_only_hex(splitID[0])) return 0;
+			a_pluginLength = splitID[1].size();
+			return static_cast<uint32_t>(std::stoul(splitID[0], nullptr, 16));
+		}
+
+		float ParseValueString(const std::string& a_identifier, size_t& a_nameLength)
+		{
+			auto components = split(a_identifier, "|");
+			if (components.size() != 2) return -1.0f;
+			a_nameLength = components.at(0).size();
+			try {
+				return std::stof(components.at(1));
+			}
+			catch (std::exception&) {
+				return -1.0f;
+			}
+		}
+	}
+
+	namespace Current
+	{
+		uint32_t ParseFormString(std::string_view a_identifier, size_t& a_pluginLength)
+		{
+			const auto splitID = Utilities::String::split<2>(a_identifier, "|");
+			if (splitID.count != 2 || !Utilities::String::is_only_hex(splitID.parts[0])) return 0;
+			a_pluginLength = splitID.parts[1].size();
+			return Utilities::String::to_num<uint32_t>(splitID.parts[0], true).value_or(0);
+		}
+
+		float ParseValueString(std::string_view a_identifier, size_t& a_nameLength)
+		{
+			const auto components = Utilities::String::split<2>(a_identifier, "|");
+			if (components.count != 2) return -1.0f;
+			a_nameLength = components.parts[0].size();
+			return Utilities::String::to_num<float>(components.parts[1]).value_or(-1.0f);
+		}
+	}
+
+	constexpr size_t kIterations = 1'000'000;
+
+	template <class F>
+	void Measure(const char* a_name, const std::vector<std::string>& a_inputs, F&& a_parse)
+	{
+		size_t checksum = 0;
+		const auto before = allocations.load();
+		const auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < kIterations; ++i) {
+			size_t length = 0;
+			checksum += static_cast<size_t>(a_parse(a_inputs[i % a_inputs.size()], length)) + length;
+		}
+		const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+		const auto count = allocations.load() - before;
+		std::printf("%-26s %8.1f ns/op  %6.2f allocs/op  (checksum %zu)\n", a_name, elapsed.count() / kIterations, static_cast<double>(count) / kIterations, checksum);
+	}
+}
+
+int main()
+{
+	const std::vector<std::string> formStrings{
+		"0xF|Skyrim.esm",
+		"0xA|Skyrim.esm",
+		"0x3B42A|Dawnguard.esm",
+		"0x1CD6D|Dragonborn.esm",
+		"0x801|Unofficial Skyrim Special Edition Patch.esp",
+		"0x12AB4|Lux - Orbis - Complete Overhaul.esp",
+	};
+	const std::vector<std::string> valueStrings{
+		"OneHanded|50",
+		"Lockpicking|25.5",
+		"GameDaysPassed|100",
+		"CDFSomeModQuestProgressGlobal|3",
+	};
+
+	std::printf("%zu iterations each\n", kIterations);
+	Measure("form string, old", formStrings, [](const std::string& a_input, size_t& a_length) { return Legacy::ParseFormString(a_input, a_length); });
+	Measure("form string, current", formStrings, [](const std::string& a_input, size_t& a_length) { return Current::ParseFormString(a_input, a_length); });
+	Measure("name|value, old", valueStrings, [](const std::string& a_input, size_t& a_length) { return Legacy::ParseValueString(a_input, a_length); });
+	Measure("name|value, current", valueStrings, [](const std::string& a_input, size_t& a_length) { return Current::ParseValueString(a_input, a_length); });
+	return 0;
+}
\ No newline at end of file
@@ -3,11 +3,11 @@
 #include "RE/Skyrim.h"
 #include "SKSE/SKSE.h"
 
+#include <execution>
 #include <fstream>
+#include <future>
 #include <spdlog/sinks/basic_file_sink.h>
 
-#include <json/json.h>
-
 #include "Plugin.h"
 
 #define DLLEXPORT __declspec(dllexport)
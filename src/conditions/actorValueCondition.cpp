@@ -1,6 +1,7 @@
 #include "actorValueCondition.h"
 
 #include "RE/misc.h"
+#include "settings/ruleCache.h"
 
 namespace Conditions
 {
@@ -21,6 +22,17 @@ namespace Conditions
 		this->minValue = a_minValue;
 	}
 
+	ConditionType AVCondition::GetType()
+	{
+		return ConditionType::kActorValue;
+	}
+
+	size_t AVCondition::GetMemoryUsage()
+	{
+		//Names of up to 15 characters are stored in the string itself.
+		return sizeof(*this) + (value.capacity() > 15 ? value.capacity() + 1 : 0);
+	}
+
 	void AVCondition::Print()
 	{
 		logger::info("=================/");
@@ -29,4 +41,17 @@ namespace Conditions
 		logger::info("  ->{}{}: [{}]", inverted ? "Not " : "", value, minValue);
 		logger::info("");
 	}
+
+	void AVCondition::Serialize(Settings::Cache::Writer& a_writer)
+	{
+		a_writer.WriteString(value);
+		a_writer.Write(minValue);
+	}
+
+	std::unique_ptr<Condition> AVCondition::Deserialize(Settings::Cache::Reader& a_reader)
+	{
+		auto value = a_reader.ReadString();
+		const auto minValue = a_reader.Read<float>();
+		return std::make_unique<AVCondition>(std::move(value), minValue);
+	}
 }
\ No newline at end of file
@@ -10,7 +10,11 @@ namespace Conditions
 		bool IsValid(RE::TESObjectREFR* a_container) override;
 		AVCondition(std::string a_value, float a_minValue);
 
+		ConditionType GetType() override;
+		size_t GetMemoryUsage() override;
 		void Print() override;
+		void Serialize(Settings::Cache::Writer& a_writer) override;
+		static std::unique_ptr<Condition> Deserialize(Settings::Cache::Reader& a_reader);
 	private:
 		std::string value;
 		float minValue;
@@ -1,12 +1,74 @@
 #pragma once
 
+namespace Settings::Cache
+{
+	class Reader;
+	class Writer;
+}
+
 namespace Conditions
 {
+	enum class ConditionType
+	{
+		kActorValue,
+		kContainer,
+		kGlobal,
+		kLocation,
+		kLocationKeyword,
+		kQuest,
+		kReference,
+		kWorldspace
+	};
+
+	inline std::string_view GetConditionTypeName(ConditionType a_type)
+	{
+		switch (a_type) {
+		case ConditionType::kActorValue:
+			return "skill"sv;
+		case ConditionType::kContainer:
+			return "container"sv;
+		case ConditionType::kGlobal:
+			return "global"sv;
+		case ConditionType::kLocation:
+			return "location"sv;
+		case ConditionType::kLocationKeyword:
+			return "location keyword"sv;
+		case ConditionType::kQuest:
+			return "quest"sv;
+		case ConditionType::kReference:
+			return "reference"sv;
+		case ConditionType::kWorldspace:
+			return "worldspace"sv;
+		default:
+			return "unknown"sv;
+		}
+	}
+
 	class Condition 
 	{
 	public:
 		bool inverted;
 		virtual bool IsValid(RE::TESObjectREFR* a_container) = 0;
+		virtual ConditionType GetType() = 0;
 		virtual void Print() = 0;
+		//Bytes the condition takes, with the lists it owns. For the startup memory report.
+		virtual size_t GetMemoryUsage() = 0;
+
+		//Returns true if the condition evaluates the same way for every container, and writes
+		//that result to a_result. Used by the optimizer to fold conditions out of rules.
+		virtual bool IsConstant(bool& a_result) { (void)a_result; return false; }
+
+		//Static conditions only depend on the base container, so they can be checked once per base
+		//object at load instead of once per reference.
+		virtual bool IsStatic() { return false; }
+		virtual bool IsValidForBase(RE::TESObjectCONT* a_base) { (void)a_base; return true; }
+
+		//Writes the condition's data for the rule cache. Type and inverted are stored by the caller,
+		//each class reads its data back in a static Deserialize.
+		virtual void Serialize(Settings::Cache::Writer& a_writer) = 0;
 	};
+
+	//Conditions are shared: the optimizer's staged rules and every compiled snapshot the hooks may still
+	//be using point into the same list.
+	using ConditionList = std::vector<std::shared_ptr<Condition>>;
 }
\ No newline at end of file
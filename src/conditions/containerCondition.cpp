@@ -1,5 +1,6 @@
 #include "containerCondition.h"
 
+#include "settings/ruleCache.h"
 #include "utilities/utilities.h"
 
 namespace Conditions
@@ -7,10 +8,14 @@ namespace Conditions
 	bool ContainerCondition::IsValid(RE::TESObjectREFR* a_container)
 	{
 		const auto baseObj = a_container->GetBaseObject();
-		const auto baseContainer = baseObj ? baseObj->As<RE::TESObjectCONT>() : nullptr;
-		if (baseContainer) {
+		return IsValidForBase(baseObj ? baseObj->As<RE::TESObjectCONT>() : nullptr);
+	}
+
+	bool ContainerCondition::IsValidForBase(RE::TESObjectCONT* a_base)
+	{
+		if (a_base) {
 			for (const auto other : validContainers) {
-				if (other == baseContainer) {
+				if (other == a_base) {
 					return !inverted;
 				}
 			}
@@ -18,11 +23,40 @@ namespace Conditions
 		return inverted;
 	}
 
+	bool ContainerCondition::IsStatic()
+	{
+		return true;
+	}
+
 	ContainerCondition::ContainerCondition(std::vector<RE::TESObjectCONT*> a_containers)
 	{
 		this->validContainers = a_containers;
 	}
 
+	ConditionType ContainerCondition::GetType()
+	{
+		return ConditionType::kContainer;
+	}
+
+	size_t ContainerCondition::GetMemoryUsage()
+	{
+		return sizeof(*this) + validContainers.capacity() * sizeof(RE::TESObjectCONT*);
+	}
+
+	bool ContainerCondition::IsConstant(bool& a_result)
+	{
+		if (!validContainers.empty()) {
+			return false;
+		}
+		a_result = inverted;
+		return true;
+	}
+
+	const std::vector<RE::TESObjectCONT*>& ContainerCondition::GetContainers()
+	{
+		return validContainers;
+	}
+
 	void ContainerCondition::Print()
 	{
 		std::string litmus = Utilities::EDID::GetEditorID(validContainers.front());
@@ -39,4 +73,14 @@ namespace Conditions
 		}
 		logger::info("");
 	}
+
+	void ContainerCondition::Serialize(Settings::Cache::Writer& a_writer)
+	{
+		a_writer.WriteForms(validContainers);
+	}
+
+	std::unique_ptr<Condition> ContainerCondition::Deserialize(Settings::Cache::Reader& a_reader)
+	{
+		return std::make_unique<ContainerCondition>(a_reader.ReadForms<RE::TESObjectCONT>());
+	}
 }
\ No newline at end of file
@@ -11,7 +11,16 @@ namespace Conditions
 
 		ContainerCondition(std::vector<RE::TESObjectCONT*> a_containers);
 
+		ConditionType GetType() override;
+		size_t GetMemoryUsage() override;
+		bool IsConstant(bool& a_result) override;
+		bool IsStatic() override;
+		bool IsValidForBase(RE::TESObjectCONT* a_base) override;
 		void Print() override;
+		void Serialize(Settings::Cache::Writer& a_writer) override;
+		static std::unique_ptr<Condition> Deserialize(Settings::Cache::Reader& a_reader);
+
+		const std::vector<RE::TESObjectCONT*>& GetContainers();
 	private:
 		std::vector<RE::TESObjectCONT*> validContainers;
 	};
@@ -1,5 +1,7 @@
 #include "globalCondition.h"
 
+#include "settings/ruleCache.h"
+
 namespace Conditions
 {
 	bool GlobalCondition::IsValid(RE::TESObjectREFR* a_container)
@@ -17,6 +19,16 @@ namespace Conditions
 		this->value = a_value;
 	}
 
+	ConditionType GlobalCondition::GetType()
+	{
+		return ConditionType::kGlobal;
+	}
+
+	size_t GlobalCondition::GetMemoryUsage()
+	{
+		return sizeof(*this);
+	}
+
 	void GlobalCondition::Print()
 	{
 		logger::info("======================/");
@@ -25,4 +37,17 @@ namespace Conditions
 		logger::info("  ->{}{}: [{}]", inverted ? "Not " : "", global->GetFormEditorID(), value);
 		logger::info("");
 	}
+
+	void GlobalCondition::Serialize(Settings::Cache::Writer& a_writer)
+	{
+		a_writer.WriteForm(global);
+		a_writer.Write(value);
+	}
+
+	std::unique_ptr<Condition> GlobalCondition::Deserialize(Settings::Cache::Reader& a_reader)
+	{
+		const auto global = a_reader.ReadForm<RE::TESGlobal>();
+		const auto value = a_reader.Read<float>();
+		return std::make_unique<GlobalCondition>(global, value);
+	}
 }
\ No newline at end of file
@@ -11,7 +11,11 @@ namespace Conditions
 
 		GlobalCondition(RE::TESGlobal* a_global, float a_value);
 
+		ConditionType GetType() override;
+		size_t GetMemoryUsage() override;
 		void Print() override;
+		void Serialize(Settings::Cache::Writer& a_writer) override;
+		static std::unique_ptr<Condition> Deserialize(Settings::Cache::Reader& a_reader);
 	private:
 		RE::TESGlobal* global;
 		float value;
@@ -1,6 +1,7 @@
 #include "locationCondition.h"
 
 #include "hooks/hooks.h"
+#include "settings/ruleCache.h"
 
 namespace Conditions
 {
@@ -37,6 +38,25 @@ namespace Conditions
 		this->validLocations = a_locations;
 	}
 
+	ConditionType LocationCondition::GetType()
+	{
+		return ConditionType::kLocation;
+	}
+
+	size_t LocationCondition::GetMemoryUsage()
+	{
+		return sizeof(*this) + validLocations.capacity() * sizeof(RE::BGSLocation*);
+	}
+
+	bool LocationCondition::IsConstant(bool& a_result)
+	{
+		if (!validLocations.empty()) {
+			return false;
+		}
+		a_result = inverted;
+		return true;
+	}
+
 	void LocationCondition::Print()
 	{
 		std::string litmus = Utilities::EDID::GetEditorID(validLocations.front());
@@ -53,4 +73,14 @@ namespace Conditions
 		}
 		logger::info("");
 	}
+
+	void LocationCondition::Serialize(Settings::Cache::Writer& a_writer)
+	{
+		a_writer.WriteForms(validLocations);
+	}
+
+	std::unique_ptr<Condition> LocationCondition::Deserialize(Settings::Cache::Reader& a_reader)
+	{
+		return std::make_unique<LocationCondition>(a_reader.ReadForms<RE::BGSLocation>());
+	}
 }
\ No newline at end of file
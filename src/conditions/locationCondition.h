@@ -11,7 +11,12 @@ namespace Conditions
 
 		LocationCondition(std::vector<RE::BGSLocation*> a_locations);
 
+		ConditionType GetType() override;
+		size_t GetMemoryUsage() override;
+		bool IsConstant(bool& a_result) override;
 		void Print() override;
+		void Serialize(Settings::Cache::Writer& a_writer) override;
+		static std::unique_ptr<Condition> Deserialize(Settings::Cache::Reader& a_reader);
 	private:
 		std::vector<RE::BGSLocation*> validLocations;
 	};
@@ -1,6 +1,7 @@
 #include "locationKeywordCondition.h"
 
 #include "hooks/hooks.h"
+#include "settings/ruleCache.h"
 
 namespace Conditions
 {
@@ -35,6 +36,25 @@ namespace Conditions
 		this->validKeywords = a_keywords;
 	}
 
+	ConditionType LocationKeywordCondition::GetType()
+	{
+		return ConditionType::kLocationKeyword;
+	}
+
+	size_t LocationKeywordCondition::GetMemoryUsage()
+	{
+		return sizeof(*this) + validKeywords.capacity() * sizeof(RE::BGSKeyword*);
+	}
+
+	bool LocationKeywordCondition::IsConstant(bool& a_result)
+	{
+		if (!validKeywords.empty()) {
+			return false;
+		}
+		a_result = inverted;
+		return true;
+	}
+
 	void LocationKeywordCondition::Print()
 	{
 		logger::info("================================/");
@@ -45,4 +65,14 @@ namespace Conditions
 		}
 		logger::info("");
 	}
+
+	void LocationKeywordCondition::Serialize(Settings::Cache::Writer& a_writer)
+	{
+		a_writer.WriteForms(validKeywords);
+	}
+
+	std::unique_ptr<Condition> LocationKeywordCondition::Deserialize(Settings::Cache::Reader& a_reader)
+	{
+		return std::make_unique<LocationKeywordCondition>(a_reader.ReadForms<RE::BGSKeyword>());
+	}
 }
\ No newline at end of file
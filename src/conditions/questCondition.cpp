@@ -1,6 +1,7 @@
 #include "questCondition.h"
 
 #include "RE/misc.h"
+#include "settings/ruleCache.h"
 
 namespace Conditions
 {
@@ -58,6 +59,16 @@ namespace Conditions
 		}
 	}
 
+	ConditionType QuestCondition::GetType()
+	{
+		return ConditionType::kQuest;
+	}
+
+	size_t QuestCondition::GetMemoryUsage()
+	{
+		return sizeof(*this) + completedStages.capacity() * sizeof(uint16_t);
+	}
+
 	void QuestCondition::Print()
 	{
 		logger::info("=====================/");
@@ -72,4 +83,19 @@ namespace Conditions
 		}
 		logger::info("");
 	}
+
+	void QuestCondition::Serialize(Settings::Cache::Writer& a_writer)
+	{
+		a_writer.WriteForm(quest);
+		a_writer.WriteVector(completedStages);
+		a_writer.Write(state == kCompleted);
+	}
+
+	std::unique_ptr<Condition> QuestCondition::Deserialize(Settings::Cache::Reader& a_reader)
+	{
+		const auto quest = a_reader.ReadForm<RE::TESQuest>();
+		auto stages = a_reader.ReadVector<uint16_t>();
+		const auto completed = a_reader.Read<bool>();
+		return std::make_unique<QuestCondition>(quest, std::move(stages), completed);
+	}
 }
\ No newline at end of file
@@ -11,7 +11,11 @@ namespace Conditions
 
 		QuestCondition(RE::TESQuest* a_quest, std::vector<uint16_t> a_stages, bool a_completed);
 
+		ConditionType GetType() override;
+		size_t GetMemoryUsage() override;
 		void Print() override;
+		void Serialize(Settings::Cache::Writer& a_writer) override;
+		static std::unique_ptr<Condition> Deserialize(Settings::Cache::Reader& a_reader);
 	private:
 		enum QuestState {
 			kCompleted,
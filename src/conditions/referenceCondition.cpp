@@ -1,5 +1,7 @@
 #include "referenceCondition.h"
 
+#include "settings/ruleCache.h"
+
 namespace Conditions
 {
 	bool ReferenceCondition::IsValid(RE::TESObjectREFR* a_container)
@@ -18,6 +20,25 @@ namespace Conditions
 		this->validReferences = a_references;
 	}
 
+	ConditionType ReferenceCondition::GetType()
+	{
+		return ConditionType::kReference;
+	}
+
+	size_t ReferenceCondition::GetMemoryUsage()
+	{
+		return sizeof(*this) + validReferences.capacity() * sizeof(RE::FormID);
+	}
+
+	bool ReferenceCondition::IsConstant(bool& a_result)
+	{
+		if (!validReferences.empty()) {
+			return false;
+		}
+		a_result = inverted;
+		return true;
+	}
+
 	void ReferenceCondition::Print()
 	{
 		logger::info("=========================/");
@@ -28,4 +49,14 @@ namespace Conditions
 		}
 		logger::info("");
 	}
+
+	void ReferenceCondition::Serialize(Settings::Cache::Writer& a_writer)
+	{
+		a_writer.WriteVector(validReferences);
+	}
+
+	std::unique_ptr<Condition> ReferenceCondition::Deserialize(Settings::Cache::Reader& a_reader)
+	{
+		return std::make_unique<ReferenceCondition>(a_reader.ReadVector<RE::FormID>());
+	}
 }
\ No newline at end of file
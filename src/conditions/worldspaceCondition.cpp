@@ -1,5 +1,7 @@
 #include "worldspaceCondition.h"
 
+#include "settings/ruleCache.h"
+
 namespace Conditions
 {
 	bool WorldspaceCondition::IsValid(RE::TESObjectREFR* a_container)
@@ -30,6 +32,30 @@ namespace Conditions
 		this->validWorldSpaces = a_worldspaces;
 	}
 
+	ConditionType WorldspaceCondition::GetType()
+	{
+		return ConditionType::kWorldspace;
+	}
+
+	size_t WorldspaceCondition::GetMemoryUsage()
+	{
+		return sizeof(*this) + validWorldSpaces.capacity() * sizeof(RE::TESWorldSpace*);
+	}
+
+	bool WorldspaceCondition::IsConstant(bool& a_result)
+	{
+		if (!validWorldSpaces.empty()) {
+			return false;
+		}
+		a_result = inverted;
+		return true;
+	}
+
+	const std::vector<RE::TESWorldSpace*>& WorldspaceCondition::GetWorldspaces()
+	{
+		return validWorldSpaces;
+	}
+
 	void WorldspaceCondition::Print()
 	{
 		logger::info("==========================/");
@@ -40,4 +66,14 @@ namespace Conditions
 		}
 		logger::info("");
 	}
+
+	void WorldspaceCondition::Serialize(Settings::Cache::Writer& a_writer)
+	{
+		a_writer.WriteForms(validWorldSpaces);
+	}
+
+	std::unique_ptr<Condition> WorldspaceCondition::Deserialize(Settings::Cache::Reader& a_reader)
+	{
+		return std::make_unique<WorldspaceCondition>(a_reader.ReadForms<RE::TESWorldSpace>());
+	}
 }
\ No newline at end of file
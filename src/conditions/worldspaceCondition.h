@@ -11,7 +11,14 @@ namespace Conditions
 
 		WorldspaceCondition(std::vector<RE::TESWorldSpace*> a_worldspaces);
 
+		ConditionType GetType() override;
+		size_t GetMemoryUsage() override;
+		bool IsConstant(bool& a_result) override;
 		void Print() override;
+		void Serialize(Settings::Cache::Writer& a_writer) override;
+		static std::unique_ptr<Condition> Deserialize(Settings::Cache::Reader& a_reader);
+
+		const std::vector<RE::TESWorldSpace*>& GetWorldspaces();
 	private:
 		std::vector<RE::TESWorldSpace*> validWorldSpaces;
 	};
@@ -0,0 +1,158 @@
+#include "consoleCommands.h"
+
+#include "hooks/hooks.h"
+#include "profiling/latencyHistogram.h"
+#include "profiling/traceBuffer.h"
+#include "settings/JSONSettings.h"
+#include "settings/formDump.h"
+#include "utilities/utilities.h"
+
+namespace {
+	//Unused by the game, taken over the same way other SKSE plugins add console commands.
+	constexpr std::string_view replacedCommand = "TestSeenData"sv;
+
+	void Print(const std::string& a_message)
+	{
+		logger::info("Console: {}", a_message);
+		if (const auto console = RE::ConsoleLog::GetSingleton()) {
+			console->Print("%s", a_message.c_str());
+		}
+	}
+
+	void Reload(std::string_view)
+	{
+		Print(Settings::JSON::Reload());
+	}
+
+	void DumpForms(std::string_view)
+	{
+		const auto path = Settings::FormDump::GetPath();
+		std::string error{};
+		const auto count = path.empty() ? 0 : Settings::FormDump::Write(path, error);
+		if (count == 0) {
+			Print(fmt::format("Form dump failed: {}", error.empty() ? "no log directory" : error));
+			return;
+		}
+		Print(fmt::format("Wrote {} forms to {}", count, path.string()));
+	}
+
+	void Trace(std::string_view a_argument)
+	{
+		auto* traceBuffer = Profiling::TraceBuffer::GetSingleton();
+		const auto argument = Utilities::String::tolower(a_argument);
+		if (argument == "on" || argument == "off") {
+			traceBuffer->SetEnabled(argument == "on");
+			Print(fmt::format("Tracing is {}.", argument));
+			return;
+		}
+		Print(traceBuffer->FlushToLog());
+	}
+
+	void Latency(std::string_view)
+	{
+		const auto lines = Profiling::Latency::GetSingleton()->Report();
+		if (lines.empty()) {
+			Print("No containers processed yet.");
+			return;
+		}
+		for (const auto& line : lines) {
+			Print(line);
+		}
+	}
+
+	void Allocations(std::string_view)
+	{
+		const auto lines = Hooks::ContainerManager::GetSingleton()->ReportAllocations();
+		if (lines.empty()) {
+			Print("Allocation tracking is off or no container was processed yet, see bTrackAllocations in the INI.");
+			return;
+		}
+		for (const auto& line : lines) {
+			Print(line);
+		}
+	}
+
+	void Explain(std::string_view a_argument)
+	{
+		const auto selected = RE::Console::GetSelectedRef();
+		if (!selected) {
+			Print("Select a container in the console first.");
+			return;
+		}
+		const bool allRules = Utilities::String::tolower(a_argument) == "all";
+		for (const auto& line : Hooks::ContainerManager::GetSingleton()->Explain(selected.get(), allRules)) {
+			Print(line);
+		}
+	}
+
+	void Help(std::string_view);
+
+	struct Subcommand {
+		std::string_view name;
+		std::string_view help;
+		void (*handler)(std::string_view a_argument);
+	};
+
+	constexpr std::array subcommands{
+		Subcommand{ "reload"sv, "re-reads the config files that changed and applies their rules"sv, Reload },
+		Subcommand{ "trace"sv, "\"on\" or \"off\" records distribution events, without an argument writes them to a Chrome trace file"sv, Trace },
+		Subcommand{ "explain"sv, "dry-runs every rule on the selected container and shows why each would or wouldn't apply, \"all\" includes rules that can't match its base"sv, Explain },
+		Subcommand{ "latency"sv, "prints p50/p90/p99/p99.9/max processing times of the hooks and each rule type"sv, Latency },
+		Subcommand{ "allocations"sv, "prints the heap allocations made in the hooks per hook call, rule type and call site, and the rules that allocate the most"sv, Allocations },
+		Subcommand{ "dumpforms"sv, "writes the forms configs can use to a file for devtools/configLint"sv, DumpForms },
+		Subcommand{ "help"sv, "lists the subcommands"sv, Help }
+	};
+
+	void Help(std::string_view)
+	{
+		Print("Usage: cdf <subcommand> [argument]");
+		for (const auto& subcommand : subcommands) {
+			Print(fmt::format("  {} - {}", subcommand.name, subcommand.help));
+		}
+	}
+
+	bool Execute(const RE::SCRIPT_PARAMETER*, RE::SCRIPT_FUNCTION::ScriptData* a_scriptData, RE::TESObjectREFR*, RE::TESObjectREFR*, RE::Script*, RE::ScriptLocals*, double&, std::uint32_t&)
+	{
+		std::string name{};
+		std::string argument{};
+		if (a_scriptData->numParams > 0) {
+			const auto chunk = a_scriptData->GetStringChunk();
+			name = Utilities::String::tolower(chunk->GetString());
+			if (a_scriptData->numParams > 1) {
+				argument = chunk->GetNext()->AsString()->GetString();
+			}
+		}
+
+		const auto subcommand = std::ranges::find(subcommands, std::string_view(name), &Subcommand::name);
+		if (subcommand == subcommands.end()) {
+			Help({});
+			return true;
+		}
+		subcommand->handler(argument);
+		return true;
+	}
+}
+
+namespace Console {
+	void Install()
+	{
+		const auto command = RE::SCRIPT_FUNCTION::LocateConsoleCommand(replacedCommand);
+		if (!command) {
+			logger::warn("Failed to find the {} console command, cdf commands will not be available.", replacedCommand);
+			return;
+		}
+
+		static RE::SCRIPT_PARAMETER params[] = {
+			{ "Subcommand", RE::SCRIPT_PARAM_TYPE::kChar, true },
+			{ "Argument", RE::SCRIPT_PARAM_TYPE::kChar, true }
+		};
+		command->functionName = "ContainerDistributionFramework";
+		command->shortName = "cdf";
+		command->helpString = "Container Distribution Framework. Type \"cdf help\" for subcommands.";
+		command->referenceFunction = false;
+		command->SetParameters(params);
+		command->executeFunction = Execute;
+		command->conditionFunction = nullptr;
+		logger::info("Registered the cdf console command.");
+	}
+}
\ No newline at end of file
@@ -0,0 +1,6 @@
+#pragma once
+
+namespace Console {
+	//Registers the "cdf" console command. Needs kDataLoaded.
+	void Install();
+}
\ No newline at end of file
@@ -1,7 +1,13 @@
+#include "console/consoleCommands.h"
 #include "hooks/hooks.h"
 #include "settings/INISettings.h"
 #include "settings/JSONSettings.h"
 #include "merchantCache/merchantCache.h"
+#include "profiling/latencyHistogram.h"
+#include "profiling/startupReport.h"
+#include "profiling/statsBlock.h"
+#include "profiling/traceBuffer.h"
+#include "utilities/taskGraph.h"
 
 namespace
 {
@@ -28,6 +34,56 @@ namespace
 		spdlog::set_default_logger(std::move(log));
 		spdlog::set_pattern("[%^%l%$] %v"s);
 	}
+
+	//The phase table, then how the task graph ran them.
+	void LogTimings(const Utilities::TaskGraph& a_graph)
+	{
+		Profiling::StartupReport::GetSingleton()->Log();
+
+		std::vector<Utilities::TaskGraph::TaskID> path{};
+		const auto criticalPath = a_graph.GetCriticalPath(path);
+		std::string pathNames{};
+		for (const auto task : path) {
+			pathNames += pathNames.empty() ? a_graph.GetName(task) : " -> " + a_graph.GetName(task);
+		}
+		logger::info("  kDataLoaded work took {:.1f} ms, critical path {:.1f} ms: {}", a_graph.GetWallTime(), criticalPath, pathNames);
+	}
+
+	//Marker and merchant caches only read form arrays and persistent cells, so they run on workers.
+	//Config reading resolves forms and registers rules, and it and everything after it stays on the
+	//main thread.
+	void InitializeData()
+	{
+		using Affinity = Utilities::TaskGraph::Affinity;
+		using Profiling::StartupPhase;
+		using Profiling::StartupTimer;
+		auto* manager = Hooks::ContainerManager::GetSingleton();
+
+		Utilities::TaskGraph graph{};
+		graph.Add("Markers", Affinity::kWorker, [manager]() { manager->WarmCache(); });
+		graph.Add("Merchants", Affinity::kWorker, []() { MerchantCache::MerchantCache::GetSingleton()->BuildCache(); });
+		const auto read = graph.Add("Configs", Affinity::kMainThread, []() {
+			logger::info("If there are any config errors, they'll show here:");
+			Settings::JSON::Read();
+			logger::info("=================================================");
+			});
+		const auto optimize = graph.Add("Optimize", Affinity::kMainThread, [manager]() {
+			StartupTimer timer{ StartupPhase::kOptimize, manager->GetRuleCount() };
+			manager->Optimize();
+			}, { read });
+		const auto print = graph.Add("PrettyPrint", Affinity::kMainThread, [manager]() {
+			StartupTimer timer{ StartupPhase::kPrettyPrint, manager->GetOptimizedRuleCount() };
+			manager->PrettyPrint();
+			}, { optimize });
+		graph.Add("Compile", Affinity::kMainThread, [manager]() {
+			StartupTimer timer{ StartupPhase::kCompile, manager->GetOptimizedRuleCount() };
+			manager->Compile();
+			}, { print });
+		graph.Run();
+
+		LogTimings(graph);
+		manager->LogMemoryUsage();
+	}
 }
 
 extern "C" DLLEXPORT constinit auto SKSEPlugin_Version = []()
@@ -66,12 +122,14 @@ static void MessageEventCallback(SKSE::MessagingInterface::Message* a_msg)
 {
 	switch (a_msg->type) {
 	case SKSE::MessagingInterface::kDataLoaded:
-		Hooks::ContainerManager::GetSingleton()->WarmCache();
-		MerchantCache::MerchantCache::GetSingleton()->BuildCache();
-		logger::info("If there are any config errors, they'll show here:");
-		Settings::JSON::Read();
-		logger::info("=================================================");
-		Hooks::ContainerManager::GetSingleton()->PrettyPrint();
+		InitializeData();
+		Console::Install();
+		break;
+	case SKSE::MessagingInterface::kSaveGame:
+		Hooks::ContainerManager::GetSingleton()->LogStatistics();
+		if (Profiling::TraceBuffer::GetSingleton()->IsEnabled()) {
+			Profiling::TraceBuffer::GetSingleton()->FlushToLog();
+		}
 		break;
 	default:
 		break;
@@ -96,7 +154,26 @@ extern "C" DLLEXPORT bool SKSEAPI SKSEPlugin_Load(const SKSE::LoadInterface* a_s
 	const auto messaging = SKSE::GetMessagingInterface();
 	messaging->RegisterListener(&MessageEventCallback);
 
-	Hooks::Install();
-	Settings::INI::Read();
+	{
+		Profiling::StartupTimer timer{ Profiling::StartupPhase::kHookInstall, Profiling::Stats::hookCount };
+		Hooks::Install();
+	}
+	{
+		Profiling::StartupTimer timer{ Profiling::StartupPhase::kINIRead };
+		timer.SetItems(Settings::INI::Read() ? 1 : 0);
+	}
+	//Saving isn't the only way out of a session, statistics are logged on the way out too. Statics
+	//constructed after this registration are destroyed before the handler runs, so everything it
+	//touches is constructed first.
+	Hooks::ContainerManager::GetSingleton();
+	Profiling::Latency::GetSingleton();
+	Profiling::TraceBuffer::GetSingleton();
+	std::atexit([]() {
+		Hooks::ContainerManager::GetSingleton()->LogStatistics();
+		if (Profiling::TraceBuffer::GetSingleton()->IsEnabled()) {
+			Profiling::TraceBuffer::GetSingleton()->FlushToLog();
+		}
+		});
+	Settings::JSON::BeginRead();
 	return true;
 }
\ No newline at end of file
@@ -1,6 +1,17 @@
 #include "Hooks/hooks.h"
 
+#include "conditions/actorValueCondition.h"
+#include "conditions/containerCondition.h"
+#include "conditions/globalCondition.h"
+#include "conditions/locationCondition.h"
+#include "conditions/locationKeywordCondition.h"
+#include "conditions/questCondition.h"
+#include "conditions/referenceCondition.h"
+#include "conditions/worldspaceCondition.h"
 #include "merchantCache/merchantCache.h"
+#include "profiling/startupReport.h"
+#include "rules/keywordMatcher.h"
+#include "settings/ruleCache.h"
 #include "utilities/utilities.h"
 #include "RE/offset.h"
 
@@ -22,6 +33,8 @@ namespace {
 	}
 
 	void AddLeveledListToContainer(RE::TESLeveledList * list, RE::TESObjectREFR * a_container, uint32_t a_count) {
+		Profiling::TraceScope trace{ Profiling::TraceEvent::kLeveledList, a_container->GetFormID() };
+		Profiling::AllocationSiteScope allocations{ Profiling::AllocationSite::kLeveledList };
 		RE::BSScrapArray<RE::CALCED_OBJECT> result{};
 		ResolveLeveledList(list, &result, a_count);
 		if (result.size() < 1) return;
@@ -32,6 +45,69 @@ namespace {
 			a_container->AddObjectToContainer(thingToAdd, nullptr, obj.count, nullptr);
 		}
 	}
+
+	RE::TESObjectREFR::InventoryItemMap ReadInventory(RE::TESObjectREFR* a_container)
+	{
+		Profiling::AllocationSiteScope allocations{ Profiling::AllocationSite::kInventory };
+		return a_container->GetInventory();
+	}
+
+	std::string Describe(const RE::TESForm* a_form)
+	{
+		if (!a_form) {
+			return "none";
+		}
+		auto name = Utilities::EDID::GetEditorID(a_form);
+		if (name.empty()) {
+			name = a_form->GetName();
+		}
+		return fmt::format("{} [{:08X}]", name, a_form->GetFormID());
+	}
+
+	bool HasAllKeywords(RE::TESBoundObject* a_item, std::span<RE::BGSKeyword* const> a_keywords)
+	{
+		const auto keywordForm = a_item->As<RE::BGSKeywordForm>();
+		return keywordForm && std::ranges::all_of(a_keywords, [&](RE::BGSKeyword* a_keyword) { return keywordForm->HasKeyword(a_keyword); });
+	}
+
+	//What two rules must share to be merged. Lists are interned, so equal spans are equal lists. The last
+	//field is whatever else the type needs to match: the count of an add, the target of a (replace)
+	//remove, the keyword span of a keyword removal.
+	struct MergeKey
+	{
+		Rules::RuleType type;
+		uint8_t flags;
+		Rules::Span conditions;
+		uint64_t detail;
+
+		bool operator==(const MergeKey&) const = default;
+	};
+
+	struct MergeKeyHash
+	{
+		size_t operator()(const MergeKey& a_key) const
+		{
+			uint64_t hash = 14695981039346656037ull;
+			for (const uint64_t value : { static_cast<uint64_t>(a_key.type) << 8 | a_key.flags, static_cast<uint64_t>(a_key.conditions.offset) << 32 | a_key.conditions.size, a_key.detail }) {
+				hash = (hash ^ value) * 1099511628211ull;
+			}
+			return static_cast<size_t>(hash);
+		}
+	};
+
+	double Microseconds(std::chrono::steady_clock::time_point a_start)
+	{
+		return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - a_start).count();
+	}
+
+	static_assert(static_cast<size_t>(Rules::RuleType::kTotal) == Profiling::Stats::ruleTypeCount);
+
+	Profiling::LatencyPhase GetApplyPhase(Rules::RuleType a_type)
+	{
+		static_assert(static_cast<size_t>(Profiling::LatencyPhase::kApplyReplaceKeyword) - static_cast<size_t>(Profiling::LatencyPhase::kApplyAdd) ==
+			static_cast<size_t>(Rules::RuleType::kReplaceKeyword) - static_cast<size_t>(Rules::RuleType::kAdd));
+		return static_cast<Profiling::LatencyPhase>(static_cast<size_t>(Profiling::LatencyPhase::kApplyAdd) + static_cast<size_t>(a_type));
+	}
 }
 namespace Hooks {
 	void Install()
@@ -51,6 +127,7 @@ namespace Hooks {
 
 	RE::BGSLocation* ContainerManager::GetNearestMarkerLocation(RE::TESObjectREFR* a_container)
 	{
+		Profiling::TraceScope trace{ Profiling::TraceEvent::kMarkerLookup, a_container->GetFormID() };
 		const auto containerWorld = a_container->GetWorldspace();
 		if (containerWorld && this->worldspaceMarkers.contains(containerWorld)) {
 			const auto& vec = worldspaceMarkers[containerWorld];
@@ -79,103 +156,258 @@ namespace Hooks {
 		maxLookupDistance = a_newDistance;
 	}
 
-	void ContainerManager::RegisterRule(Json::Value& raw, std::vector<size_t> a_conditions, bool a_safe, bool a_vendors, bool a_onlyVendors, bool a_random)
+	size_t ContainerManager::RegisterSource(const std::string& a_path, const std::string& a_friendlyName)
+	{
+		ruleSources.push_back({ a_path, a_friendlyName });
+		return ruleSources.size() - 1;
+	}
+
+	Rules::Span ContainerManager::InternConditions(std::span<const size_t> a_conditions)
+	{
+		return lists.conditions.Intern(a_conditions);
+	}
+
+	void ContainerManager::RegisterRule(ResolvedChange a_change, Rules::Span a_conditions, bool a_safe, bool a_vendors, bool a_onlyVendors, bool a_random, size_t a_source)
 	{
-		//json is valid here, checked in Settings::JSON::Read()
-		const auto& add = raw["add"];
-		const auto& remove = raw["remove"];
-		const auto& removeKeywordsField = raw["removeByKeywords"];
-		const auto& count = raw["count"];
+		//forms are resolved and validated in Settings::JSON::Read()
+		const auto& add = a_change.add;
+		const auto& remove = a_change.remove;
+		const auto& removeKeywordsField = a_change.removeKeywords;
+		const auto& count = a_change.count;
+
+		if (a_conditions.size > Rules::maxRuleConditions) {
+			const auto& source = ruleSources.at(a_source);
+			logger::warn("<{}>/[{}] has {} conditions, more than the {} a rule can have. Skipping it.", source.path, source.friendlyName, a_conditions.size, Rules::maxRuleConditions);
+			return;
+		}
+
+		Rules::RuleData newRule{};
+		newRule.conditions = a_conditions;
+		newRule.source = static_cast<uint32_t>(a_source);
+		newRule.target = remove;
+		newRule.flags = Rules::RuleFlag::kNone;
+		if (a_safe) {
+			newRule.flags |= Rules::RuleFlag::kAllowSafeBypass;
+		}
+		if (a_vendors) {
+			newRule.flags |= Rules::RuleFlag::kAllowVendors;
+		}
+		if (a_onlyVendors) {
+			newRule.flags |= Rules::RuleFlag::kOnlyVendors;
+		}
+		if (a_random) {
+			newRule.flags |= Rules::RuleFlag::kRandomAdd;
+		}
+
+		newRule.forms = lists.forms.Intern(add ? *add : std::vector<RE::TESBoundObject*>{});
+		newRule.keywords = lists.keywords.Intern(removeKeywordsField ? *removeKeywordsField : std::vector<RE::BGSKeyword*>{});
 
 		if (add && removeKeywordsField) {
-			ReplaceKeywordRule newRule{};
-			newRule.conditions = a_conditions;
-			newRule.allowSafeBypass = a_safe;
-			newRule.allowVendors = a_vendors;
-			newRule.onlyVendors = a_onlyVendors;
-			newRule.randomAdd = a_random;
-			for (const auto& entry : add) {
-				const auto obj = Utilities::Forms::GetFormFromString<RE::TESBoundObject>(entry.asString());
-				newRule.newForms.push_back(obj);
-			}
-			for (const auto& entry : removeKeywordsField) {
-				const auto keyword = Utilities::Forms::GetFormFromString<RE::BGSKeyword>(entry.asString());
-				newRule.keywordsToRemove.push_back(keyword);
-			}
-			replaceKeywords.push_back(std::move(newRule));
+			newRule.type = Rules::RuleType::kReplaceKeyword;
+			newRule.target = nullptr;
+			newRule.count = 0;
 		}
 		else if (add && remove) {
-			ReplaceRule newRule{};
-			newRule.conditions = a_conditions;
-			newRule.allowSafeBypass = a_safe;
-			newRule.allowVendors = a_vendors;
-			newRule.onlyVendors = a_onlyVendors;
-			newRule.randomAdd = a_random;
-			for (const auto& entry : add) {
-				const auto obj = Utilities::Forms::GetFormFromString<RE::TESBoundObject>(entry.asString());
-				newRule.newForms.push_back(obj);
-			}
-			newRule.oldForm = Utilities::Forms::GetFormFromString<RE::TESBoundObject>(remove.asString());
-			replaces.push_back(std::move(newRule));
+			newRule.type = Rules::RuleType::kReplace;
+			newRule.count = 0;
 		}
 		else if (removeKeywordsField) {
-			RemoveKeywordRule newRule{};
-			newRule.conditions = a_conditions;
-			newRule.allowSafeBypass = a_safe;
-			newRule.allowVendors = a_vendors;
-			newRule.onlyVendors = a_onlyVendors;
-			newRule.randomAdd = a_random;
-			for (const auto& entry : removeKeywordsField) {
-				const auto keyword = Utilities::Forms::GetFormFromString<RE::BGSKeyword>(entry.asString());
-				newRule.keywordsToRemove.push_back(keyword);
-			}
-			removeKeywords.push_back(std::move(newRule));
+			newRule.type = Rules::RuleType::kRemoveKeyword;
+			newRule.target = nullptr;
+			newRule.count = 0;
 		}
 		else if (remove) {
-			RemoveRule newRule{};
-			newRule.conditions = a_conditions;
-			newRule.allowSafeBypass = a_safe;
-			newRule.allowVendors = a_vendors;
-			newRule.onlyVendors = a_onlyVendors;
-			newRule.randomAdd = a_random;
-			newRule.form = Utilities::Forms::GetFormFromString<RE::TESBoundObject>(remove.asString());
+			newRule.type = Rules::RuleType::kRemove;
+			newRule.count = count.value_or(0);
+		}
+		else if (add) {
+			newRule.type = Rules::RuleType::kAdd;
+			newRule.count = count.value_or(1);
+		}
+		else {
+			return;
+		}
+		rules.push_back(std::move(newRule));
+	}
+
+	bool ContainerManager::SerializeRules(Settings::Cache::Writer& a_writer)
+	{
+		a_writer.Write(static_cast<uint32_t>(ruleSources.size()));
+		for (const auto& source : ruleSources) {
+			a_writer.WriteString(source.path);
+			a_writer.WriteString(source.friendlyName);
+		}
+
+		a_writer.Write(static_cast<uint32_t>(storedConditions.size()));
+		for (const auto& condition : storedConditions) {
+			a_writer.Write(condition->GetType());
+			a_writer.Write(condition->inverted);
+			condition->Serialize(a_writer);
+		}
 
-			if (count) {
-				newRule.ruleCount = count.asUInt();
+		a_writer.Write(static_cast<uint32_t>(rules.size()));
+		for (const auto& rule : rules) {
+			a_writer.Write(rule.type);
+			a_writer.Write(rule.flags);
+			a_writer.Write(rule.count);
+			a_writer.WriteForm(rule.target);
+			a_writer.Write(rule.conditions.size);
+			for (const auto condition : lists.conditions.Get(rule.conditions)) {
+				a_writer.Write(condition);
 			}
-			else {
-				newRule.ruleCount = 0;
+			a_writer.WriteForms(lists.forms.Get(rule.forms));
+			a_writer.WriteForms(lists.keywords.Get(rule.keywords));
+			a_writer.Write(rule.source);
+		}
+		return !a_writer.Failed();
+	}
+
+	bool ContainerManager::DeserializeRules(Settings::Cache::Reader& a_reader)
+	{
+		//Everything is read into locals first, so a bad cache leaves the manager untouched.
+		std::vector<RuleSource> newSources{};
+		const auto sourceCount = a_reader.ReadCount(2 * sizeof(uint32_t));
+		for (uint32_t i = 0; i < sourceCount && !a_reader.Failed(); ++i) {
+			auto path = a_reader.ReadString();
+			auto friendlyName = a_reader.ReadString();
+			newSources.push_back({ std::move(path), std::move(friendlyName) });
+		}
+
+		Conditions::ConditionList newConditions{};
+		const auto conditionCount = a_reader.ReadCount(sizeof(Conditions::ConditionType) + sizeof(bool));
+		for (uint32_t i = 0; i < conditionCount && !a_reader.Failed(); ++i) {
+			const auto type = a_reader.Read<Conditions::ConditionType>();
+			const auto inverted = a_reader.Read<bool>();
+			std::unique_ptr<Conditions::Condition> condition{};
+			switch (type) {
+			case Conditions::ConditionType::kActorValue:
+				condition = Conditions::AVCondition::Deserialize(a_reader);
+				break;
+			case Conditions::ConditionType::kContainer:
+				condition = Conditions::ContainerCondition::Deserialize(a_reader);
+				break;
+			case Conditions::ConditionType::kGlobal:
+				condition = Conditions::GlobalCondition::Deserialize(a_reader);
+				break;
+			case Conditions::ConditionType::kLocation:
+				condition = Conditions::LocationCondition::Deserialize(a_reader);
+				break;
+			case Conditions::ConditionType::kLocationKeyword:
+				condition = Conditions::LocationKeywordCondition::Deserialize(a_reader);
+				break;
+			case Conditions::ConditionType::kQuest:
+				condition = Conditions::QuestCondition::Deserialize(a_reader);
+				break;
+			case Conditions::ConditionType::kReference:
+				condition = Conditions::ReferenceCondition::Deserialize(a_reader);
+				break;
+			case Conditions::ConditionType::kWorldspace:
+				condition = Conditions::WorldspaceCondition::Deserialize(a_reader);
+				break;
+			default:
+				a_reader.Fail("unknown condition type");
+				break;
+			}
+			if (condition) {
+				condition->inverted = inverted;
+				newConditions.push_back(std::move(condition));
 			}
-			removes.push_back(std::move(newRule));
 		}
-		else if (add) {
-			AddRule newRule{};
-			newRule.conditions = a_conditions;
-			newRule.allowSafeBypass = a_safe;
-			newRule.allowVendors = a_vendors;
-			newRule.onlyVendors = a_onlyVendors;
-			newRule.randomAdd = a_random;
-			for (const auto& entry : add) {
-				const auto obj = Utilities::Forms::GetFormFromString<RE::TESBoundObject>(entry.asString());
-				newRule.newForms.push_back(obj);
+
+		std::vector<Rules::RuleData> newRules{};
+		Rules::RuleLists newLists{};
+		const auto ruleCount = a_reader.ReadCount(sizeof(Rules::RuleType) + sizeof(uint8_t) + sizeof(uint32_t));
+		for (uint32_t i = 0; i < ruleCount && !a_reader.Failed(); ++i) {
+			Rules::RuleData rule{};
+			rule.type = a_reader.Read<Rules::RuleType>();
+			rule.flags = a_reader.Read<uint8_t>();
+			rule.count = a_reader.Read<uint32_t>();
+			rule.target = a_reader.ReadForm<RE::TESBoundObject>();
+			const auto conditions = a_reader.ReadVector<uint32_t>();
+			rule.conditions = newLists.conditions.Intern(conditions);
+			rule.forms = newLists.forms.Intern(a_reader.ReadForms<RE::TESBoundObject>());
+			rule.keywords = newLists.keywords.Intern(a_reader.ReadForms<RE::BGSKeyword>());
+			rule.source = a_reader.Read<uint32_t>();
+
+			const bool validConditions = conditions.size() <= Rules::maxRuleConditions &&
+				std::ranges::all_of(conditions, [&](uint32_t a_condition) { return a_condition < newConditions.size(); });
+			if (rule.type >= Rules::RuleType::kTotal || rule.source >= newSources.size() || !validConditions) {
+				a_reader.Fail("cache file is corrupt");
 			}
+			newRules.push_back(std::move(rule));
+		}
+
+		if (a_reader.Failed()) {
+			return false;
+		}
+		ruleSources = std::move(newSources);
+		storedConditions = std::move(newConditions);
+		rules = std::move(newRules);
+		lists = std::move(newLists);
+		return true;
+	}
+
+	void ContainerManager::RemoveSources(const std::unordered_set<std::string>& a_paths)
+	{
+		std::erase_if(rules, [&](const Rules::RuleData& a_rule) {
+			return a_paths.contains(ruleSources.at(a_rule.source).path);
+			});
+	}
 
-			if (count) {
-				newRule.ruleCount = count.asUInt();
+	void ContainerManager::SortAndCompact(const std::vector<std::string>& a_fileOrder)
+	{
+		//Rules from a reloaded file were registered last, but have to run where that file is read.
+		std::unordered_map<std::string_view, size_t> rank{};
+		for (size_t i = 0; i < a_fileOrder.size(); ++i) {
+			rank.emplace(a_fileOrder[i], i);
+		}
+		auto rankOf = [&](const Rules::RuleData& a_rule) {
+			const auto it = rank.find(ruleSources.at(a_rule.source).path);
+			return it != rank.end() ? it->second : a_fileOrder.size();
+		};
+		std::ranges::stable_sort(rules, [&](const Rules::RuleData& a_left, const Rules::RuleData& a_right) {
+			return rankOf(a_left) < rankOf(a_right);
+			});
+
+		//The lists are interned again too, which drops the ones only removed rules used.
+		constexpr auto unused = std::numeric_limits<uint32_t>::max();
+		std::vector<uint32_t> conditionMap(storedConditions.size(), unused);
+		std::vector<uint32_t> sourceMap(ruleSources.size(), unused);
+		Conditions::ConditionList newConditions{};
+		std::vector<RuleSource> newSources{};
+		Rules::RuleLists newLists{};
+		std::vector<uint32_t> conditions{};
+		for (auto& rule : rules) {
+			conditions.clear();
+			for (const auto condition : lists.conditions.Get(rule.conditions)) {
+				if (conditionMap[condition] == unused) {
+					conditionMap[condition] = static_cast<uint32_t>(newConditions.size());
+					newConditions.push_back(storedConditions[condition]);
+				}
+				conditions.push_back(conditionMap[condition]);
 			}
-			else {
-				newRule.ruleCount = 1;
+			rule.conditions = newLists.conditions.Intern(conditions);
+			rule.forms = newLists.forms.Intern(lists.forms.Get(rule.forms));
+			rule.keywords = newLists.keywords.Intern(lists.keywords.Get(rule.keywords));
+			if (sourceMap[rule.source] == unused) {
+				sourceMap[rule.source] = static_cast<uint32_t>(newSources.size());
+				newSources.push_back(std::move(ruleSources[rule.source]));
 			}
-			adds.push_back(std::move(newRule));
+			rule.source = sourceMap[rule.source];
 		}
+		storedConditions = std::move(newConditions);
+		ruleSources = std::move(newSources);
+		lists = std::move(newLists);
 	}
 
 	void ContainerManager::WarmCache()
 	{
 		auto& worldspaceArray = RE::TESDataHandler::GetSingleton()->GetFormArray<RE::TESWorldSpace>();
+		std::vector<Profiling::StartupReport::WorldspaceTiming> timings{};
 		for (auto* worldspace : worldspaceArray) {
 			auto* persistentCell = worldspace->persistentCell;
 			if (!persistentCell) continue;
+			const auto start = std::chrono::steady_clock::now();
 			std::vector<RE::TESObjectREFR*> references{};
 
 			persistentCell->ForEachReference([&](RE::TESObjectREFR* a_marker) {
@@ -186,8 +418,388 @@ namespace Hooks {
 				return RE::BSContainer::ForEachResult::kContinue;
 				});
 
+			const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+			timings.push_back({ fmt::format("{} ({:08X})", Utilities::EDID::GetEditorID(worldspace), worldspace->GetFormID()), elapsed.count(), references.size() });
 			this->worldspaceMarkers[worldspace] = references;
 		}
+		Profiling::StartupReport::GetSingleton()->AddWorldspaces(std::move(timings));
+	}
+
+	bool ContainerManager::FoldConditions(Rules::RuleData& a_rule, size_t& a_foldedCount)
+	{
+		bool canFire = true;
+		bool folded = false;
+		std::vector<uint32_t> remaining{};
+		for (const auto condition : lists.conditions.Get(a_rule.conditions)) {
+			bool result = false;
+			if (storedConditions.at(condition)->IsConstant(result)) {
+				++a_foldedCount;
+				folded = true;
+				if (!result) {
+					canFire = false;
+				}
+				continue;
+			}
+			remaining.push_back(condition);
+		}
+		if (folded) {
+			a_rule.conditions = lists.conditions.Intern(remaining);
+		}
+		if (!canFire) {
+			return false;
+		}
+
+		//containers + !containers: the rule can only fire for a container that is in every allowed
+		//list and in none of the excluded ones.
+		bool hasAllowed = false;
+		std::vector<RE::TESObjectCONT*> allowed{};
+		std::unordered_set<RE::TESObjectCONT*> excluded{};
+		for (const auto condition : remaining) {
+			auto* stored = storedConditions.at(condition).get();
+			if (stored->GetType() != Conditions::ConditionType::kContainer) {
+				continue;
+			}
+
+			const auto& containers = static_cast<Conditions::ContainerCondition*>(stored)->GetContainers();
+			if (stored->inverted) {
+				excluded.insert(containers.begin(), containers.end());
+			}
+			else if (!hasAllowed) {
+				allowed = containers;
+				hasAllowed = true;
+			}
+			else {
+				std::erase_if(allowed, [&](RE::TESObjectCONT* a_container) {
+					return std::find(containers.begin(), containers.end(), a_container) == containers.end();
+					});
+			}
+		}
+		if (hasAllowed) {
+			return std::ranges::any_of(allowed, [&](RE::TESObjectCONT* a_container) { return !excluded.contains(a_container); });
+		}
+		return true;
+	}
+
+	void ContainerManager::LogDroppedRule(const Rules::RuleData& a_rule, std::string_view a_reason)
+	{
+		const auto& source = ruleSources.at(a_rule.source);
+		logger::info("Optimizer: dropped {} rule from <{}>/[{}] - {}.", Rules::GetRuleTypeName(a_rule.type), source.path, source.friendlyName, a_reason);
+	}
+
+	void ContainerManager::Optimize()
+	{
+		//The registered rules stay as they are, a reload adds to and removes from them.
+		optimizedRules = rules;
+		const size_t totalRules = optimizedRules.size();
+		size_t foldedConditions = 0;
+		size_t deadRules = 0;
+		size_t mergedRules = 0;
+		size_t savedConditionChecks = 0;
+		size_t savedInventoryScans = 0;
+
+		//Pass 1: constant folding and dead rule elimination.
+		std::erase_if(optimizedRules, [&](Rules::RuleData& a_rule) {
+			const auto conditionCount = a_rule.conditions.size;
+			size_t folded = 0;
+			if (FoldConditions(a_rule, folded)) {
+				foldedConditions += folded;
+				savedConditionChecks += folded;
+				return false;
+			}
+
+			LogDroppedRule(a_rule, "its conditions can never be met");
+			++deadRules;
+			savedConditionChecks += conditionCount;
+			savedInventoryScans += a_rule.type != Rules::RuleType::kAdd ? 1 : 0;
+			return true;
+			});
+
+		//Pass 2: merging. Only rules of the same type gated by the exact same checks are candidates,
+		//and only where no rule running in between could change the outcome.
+		bool replacesCanReAdd = false;
+		std::unordered_set<RE::TESBoundObject*> reAddedForms{};
+		for (const auto& rule : optimizedRules) {
+			if (rule.type != Rules::RuleType::kReplace) {
+				continue;
+			}
+			for (const auto form : lists.forms.Get(rule.forms)) {
+				if (form->As<RE::TESLeveledList>()) {
+					replacesCanReAdd = true;
+				}
+				reAddedForms.insert(form);
+			}
+		}
+
+		std::vector<Rules::RuleData> merged{};
+		merged.reserve(optimizedRules.size());
+		//First mergeable rule for every key, by index in merged.
+		std::unordered_map<MergeKey, size_t, MergeKeyHash> partners{};
+		//Forms of merged adds, by index in merged. Interned once merging is done.
+		std::unordered_map<size_t, std::vector<RE::TESBoundObject*>> mergedForms{};
+		for (auto& rule : optimizedRules) {
+			MergeKey key{ rule.type, rule.flags, rule.conditions, 0 };
+			bool mergeable = true;
+			switch (rule.type) {
+			case Rules::RuleType::kAdd:
+				//Random adds pick from their own list, so they stay apart.
+				mergeable = !rule.HasFlag(Rules::RuleFlag::kRandomAdd);
+				key.detail = rule.count;
+				break;
+			case Rules::RuleType::kRemove:
+				//Only removes run between two removes, so counts for the same form add up.
+				key.detail = reinterpret_cast<uintptr_t>(rule.target);
+				break;
+			case Rules::RuleType::kRemoveKeyword:
+				//The first keyword removal takes every matching item, nothing is left for an identical one.
+				key.detail = static_cast<uint64_t>(rule.keywords.offset) << 32 | rule.keywords.size;
+				break;
+			case Rules::RuleType::kReplace:
+				//Same as above, as long as no replace rule can put the old form back.
+				mergeable = !replacesCanReAdd && !reAddedForms.contains(rule.target);
+				key.detail = reinterpret_cast<uintptr_t>(rule.target);
+				break;
+			default:
+				mergeable = false;
+				break;
+			}
+
+			const auto partner = mergeable ? partners.find(key) : partners.end();
+			if (partner == partners.end()) {
+				if (mergeable) {
+					partners.emplace(key, merged.size());
+				}
+				merged.push_back(std::move(rule));
+				continue;
+			}
+
+			auto it = merged.begin() + static_cast<std::ptrdiff_t>(partner->second);
+			if (rule.type == Rules::RuleType::kAdd) {
+				auto [forms, first] = mergedForms.try_emplace(partner->second);
+				if (first) {
+					const auto existing = lists.forms.Get(it->forms);
+					forms->second.assign(existing.begin(), existing.end());
+				}
+				const auto added = lists.forms.Get(rule.forms);
+				forms->second.insert(forms->second.end(), added.begin(), added.end());
+			}
+			else if (rule.type == Rules::RuleType::kRemove) {
+				it->count = it->count == 0 || rule.count == 0 ? 0 : it->count + rule.count;
+			}
+			LogDroppedRule(rule, "merged into an identical rule");
+			++mergedRules;
+			savedConditionChecks += rule.conditions.size;
+			savedInventoryScans += rule.type != Rules::RuleType::kAdd ? 1 : 0;
+		}
+		for (const auto& [index, forms] : mergedForms) {
+			merged[index].forms = lists.forms.Intern(forms);
+		}
+		optimizedRules = std::move(merged);
+
+		logger::info("Optimizer: {} -> {} rules ({} never fire, {} merged), {} constant conditions folded.",
+			totalRules, optimizedRules.size(), deadRules, mergedRules, foldedConditions);
+		logger::info("Optimizer: saves {} rule visits, {} inventory scans and up to {} condition checks per container.",
+			totalRules - optimizedRules.size(), savedInventoryScans, savedConditionChecks);
+	}
+
+	void ContainerManager::Compile()
+	{
+		auto newSnapshot = std::make_shared<Snapshot>();
+		newSnapshot->conditions = storedConditions;
+		newSnapshot->table.Build(optimizedRules, lists, newSnapshot->conditions);
+		newSnapshot->prefilter.Build(newSnapshot->table, newSnapshot->conditions);
+		newSnapshot->candidateIndex.Build(newSnapshot->table, newSnapshot->conditions);
+
+		auto* traceBuffer = Profiling::TraceBuffer::GetSingleton();
+		constexpr auto unlabeled = std::numeric_limits<uint32_t>::max();
+		std::vector<uint32_t> sourceLabels(ruleSources.size(), unlabeled);
+		newSnapshot->traceLabels.reserve(newSnapshot->table.size());
+		for (const auto source : newSnapshot->table.sources) {
+			if (sourceLabels[source] == unlabeled) {
+				sourceLabels[source] = traceBuffer->RegisterLabel(fmt::format("<{}>/[{}]", ruleSources[source].path, ruleSources[source].friendlyName));
+			}
+			newSnapshot->traceLabels.push_back(sourceLabels[source]);
+		}
+		if (Profiling::IsActive() || Profiling::IsTrackingAllocations()) {
+			std::vector<std::string> labels{};
+			labels.reserve(newSnapshot->table.size());
+			for (size_t rule = 0; rule < newSnapshot->table.size(); ++rule) {
+				const auto& source = ruleSources.at(newSnapshot->table.sources[rule]);
+				labels.push_back(fmt::format("<{}>/[{}] ({})", source.path, source.friendlyName, Rules::GetRuleTypeName(newSnapshot->table.types[rule])));
+			}
+			if (Profiling::IsTrackingAllocations()) {
+				newSnapshot->allocations.Build(labels);
+			}
+			if (Profiling::IsActive()) {
+				newSnapshot->counters.Build(std::move(labels), newSnapshot->table, newSnapshot->conditions);
+			}
+		}
+
+		//The replaced rules' profile would be lost with their snapshot.
+		if (const auto stats = Profiling::GetLiveStats()) {
+			stats->ResetRules(newSnapshot->table.size());
+		}
+		const auto previous = snapshot.exchange(std::move(newSnapshot));
+		if (previous) {
+			previous->counters.Log();
+		}
+	}
+
+	void ContainerManager::LogStatistics()
+	{
+		if (const auto current = snapshot.load()) {
+			current->prefilter.LogStatistics();
+			current->counters.Log();
+		}
+		Profiling::Latency::GetSingleton()->Log();
+		for (const auto& line : ReportAllocations()) {
+			logger::info("{}", line);
+		}
+	}
+
+	std::vector<std::string> ContainerManager::ReportAllocations()
+	{
+		auto lines = Profiling::ReportAllocations();
+		if (lines.empty()) {
+			return lines;
+		}
+		lines.insert(lines.begin(), "Allocations:"s);
+		if (const auto current = snapshot.load()) {
+			for (auto& line : current->allocations.Report()) {
+				lines.push_back("  " + line);
+			}
+		}
+		return lines;
+	}
+
+	void ContainerManager::LogMemoryUsage()
+	{
+		const auto current = snapshot.load();
+		if (!current) {
+			return;
+		}
+		auto kib = [](size_t a_bytes) { return static_cast<double>(a_bytes) / 1024.0; };
+		size_t total = 0;
+		logger::info("Memory:");
+
+		//A compiled rule's share: its entries in the parallel arrays, and the lists no earlier rule
+		//shares with it.
+		const auto& table = current->table;
+		std::array<size_t, static_cast<size_t>(Rules::RuleType::kTotal)> typeRules{};
+		std::array<size_t, static_cast<size_t>(Rules::RuleType::kTotal)> typeBytes{};
+		std::unordered_set<uint32_t> seenConditions{};
+		std::unordered_set<uint32_t> seenForms{};
+		std::unordered_set<uint32_t> seenKeywords{};
+		for (size_t rule = 0; rule < table.size(); ++rule) {
+			const auto type = static_cast<size_t>(table.types[rule]);
+			++typeRules[type];
+			typeBytes[type] += Rules::RuleTable::bytesPerRule;
+			if (seenConditions.insert(table.conditions[rule].offset).second) {
+				typeBytes[type] += table.conditions[rule].size * sizeof(uint32_t);
+			}
+			if (seenForms.insert(table.forms[rule].offset).second) {
+				typeBytes[type] += table.forms[rule].size * sizeof(RE::TESBoundObject*);
+			}
+			if (seenKeywords.insert(table.keywords[rule].offset).second) {
+				typeBytes[type] += table.keywords[rule].size * sizeof(RE::BGSKeyword*);
+			}
+		}
+		for (size_t type = 0; type < typeRules.size(); ++type) {
+			if (typeRules[type] > 0) {
+				logger::info("  {:<28} {:>6} rules {:>10.1f} KiB", fmt::format("{} rules", Rules::GetRuleTypeName(static_cast<Rules::RuleType>(type))), typeRules[type], kib(typeBytes[type]));
+			}
+		}
+
+		//Conditions are shared by the registered rules and every snapshot, each is counted once.
+		constexpr size_t conditionTypeCount = static_cast<size_t>(Conditions::ConditionType::kWorldspace) + 1;
+		std::array<size_t, conditionTypeCount> typeConditions{};
+		std::array<size_t, conditionTypeCount> conditionBytes{};
+		for (const auto& condition : storedConditions) {
+			const auto type = static_cast<size_t>(condition->GetType());
+			++typeConditions[type];
+			conditionBytes[type] += condition->GetMemoryUsage();
+		}
+		size_t allConditions = storedConditions.capacity() * sizeof(std::shared_ptr<Conditions::Condition>);
+		for (size_t type = 0; type < conditionTypeCount; ++type) {
+			allConditions += conditionBytes[type];
+			if (typeConditions[type] > 0) {
+				logger::info("  {:<28} {:>6} conds {:>10.1f} KiB", fmt::format("{} conditions", Conditions::GetConditionTypeName(static_cast<Conditions::ConditionType>(type))), typeConditions[type], kib(conditionBytes[type]));
+			}
+		}
+		total += allConditions;
+
+		size_t markerBytes = Utilities::Memory::GetHashMapMemoryUsage(worldspaceMarkers);
+		for (const auto& [worldspace, markers] : worldspaceMarkers) {
+			markerBytes += markers.capacity() * sizeof(RE::TESObjectREFR*);
+		}
+		size_t sourceBytes = ruleSources.capacity() * sizeof(RuleSource);
+		for (const auto& source : ruleSources) {
+			sourceBytes += source.path.capacity() + source.friendlyName.capacity();
+		}
+		const std::pair<std::string_view, size_t> parts[] = {
+			{ "registered rules"sv, (rules.capacity() + optimizedRules.capacity()) * sizeof(Rules::RuleData) },
+			{ "registered rule lists"sv, lists.conditions.GetMemoryUsage() + lists.forms.GetMemoryUsage() + lists.keywords.GetMemoryUsage() },
+			{ "rule sources"sv, sourceBytes },
+			{ "compiled rule table"sv, table.GetMemoryUsage() },
+			{ "prefilter"sv, current->prefilter.GetMemoryUsage() },
+			{ "candidate index"sv, current->candidateIndex.GetMemoryUsage() },
+			{ "nearest marker cache"sv, markerBytes },
+			{ "merchant cache"sv, MerchantCache::MerchantCache::GetSingleton()->GetMemoryUsage() }
+		};
+		for (const auto& [name, bytes] : parts) {
+			logger::info("  {:<41} {:>10.1f} KiB", name, kib(bytes));
+			total += bytes;
+		}
+		logger::info("  {:<41} {:>10.1f} KiB ({} rules, {} conditions, {} interned list entries)", "total"sv, kib(total), table.size(), storedConditions.size(),
+			lists.conditions.GetValueCount() + lists.forms.GetValueCount() + lists.keywords.GetValueCount());
+	}
+
+	void ContainerManager::PrintRule(const Rules::RuleData& a_rule)
+	{
+		if (a_rule.conditions.size > 0) {
+			logger::info("Conditions:");
+			for (const auto condition : lists.conditions.Get(a_rule.conditions)) {
+				storedConditions.at(condition)->Print();
+			}
+		}
+		logger::info("----------------------------");
+		switch (a_rule.type) {
+		case Rules::RuleType::kAdd:
+			logger::info("Count: {}", a_rule.count);
+			logger::info("Forms:");
+			for (const auto form : lists.forms.Get(a_rule.forms)) {
+				logger::info("  ->{}", form->GetName());
+			}
+			break;
+		case Rules::RuleType::kRemove:
+			logger::info("Count: {}", a_rule.count == 0 ? "All" : std::to_string(a_rule.count));
+			logger::info("Form: {}", a_rule.target->GetName());
+			break;
+		case Rules::RuleType::kRemoveKeyword:
+			logger::info("If an item has all of these keywords, it will be removed:");
+			for (const auto keyword : lists.keywords.Get(a_rule.keywords)) {
+				logger::info("  ->{}", keyword->GetFormEditorID());
+			}
+			break;
+		case Rules::RuleType::kReplace:
+			logger::info("Form to remove: {}", a_rule.target->GetName());
+			logger::info("Replaced by:");
+			for (const auto form : lists.forms.Get(a_rule.forms)) {
+				logger::info("  ->{}", form->GetName());
+			}
+			break;
+		case Rules::RuleType::kReplaceKeyword:
+			logger::info("If an item has all of these keywords, it will be removed:");
+			for (const auto keyword : lists.keywords.Get(a_rule.keywords)) {
+				logger::info("  ->{}", keyword->GetFormEditorID());
+			}
+			logger::info("And replaced by:");
+			for (const auto form : lists.forms.Get(a_rule.forms)) {
+				logger::info("  ->{}", form->GetName());
+			}
+			break;
+		default:
+			break;
+		}
 	}
 
 	void ContainerManager::PrettyPrint()
@@ -195,41 +807,238 @@ namespace Hooks {
 		logger::info("=================================================");
 		logger::info("Finished reading settings. Information to follow:");
 		logger::info("=================================================");
-		if (!adds.empty()) {
-			logger::info("New add rules:");
-			for (auto& rule : adds) {
-				rule.Print();
+
+		constexpr std::array headers{
+			"New add rules:"sv,
+			"New remove rules:"sv,
+			"New remove by keyword rules:"sv,
+			"New replace rules:"sv,
+			"New replace by keyword rules:"sv
+		};
+		for (size_t type = 0; type < headers.size(); ++type) {
+			bool printedHeader = false;
+			for (const auto& rule : optimizedRules) {
+				if (rule.type != static_cast<Rules::RuleType>(type)) {
+					continue;
+				}
+				if (!printedHeader) {
+					logger::info("{}", headers[type]);
+					printedHeader = true;
+				}
+				PrintRule(rule);
 				logger::info("=================================");
 			}
 		}
-		if (!removes.empty()) {
-			logger::info("New remove rules:");
-			for (auto& rule : removes) {
-				rule.Print();
-				logger::info("=================================");
-			}
+	}
+
+	std::vector<std::string> ContainerManager::Explain(RE::TESObjectREFR* a_container, bool a_allRules)
+	{
+		using Clock = std::chrono::steady_clock;
+		std::vector<std::string> lines{};
+		const auto base = a_container->GetBaseObject() ? a_container->GetBaseObject()->As<RE::TESObjectCONT>() : nullptr;
+		if (!base) {
+			lines.push_back(fmt::format("{} is not a container.", Describe(a_container)));
+			return lines;
 		}
-		if (!replaces.empty()) {
-			logger::info("New replace rules:");
-			for (auto& rule : replaces) {
-				rule.Print();
-				logger::info("=================================");
+		const auto current = snapshot.load();
+		if (!current || current->table.empty()) {
+			lines.push_back("No rules are loaded.");
+			return lines;
+		}
+		const auto& table = current->table;
+		const auto totalStart = Clock::now();
+
+		auto start = Clock::now();
+		ContainerFacts facts{};
+		ResolveFacts(a_container, facts, false);
+		const auto factsTime = Microseconds(start);
+		start = Clock::now();
+		const auto marker = GetNearestMarkerLocation(a_container);
+		const auto markerTime = Microseconds(start);
+		lines.push_back(fmt::format("Container {} (base {})", Describe(a_container), Describe(base)));
+		lines.push_back(fmt::format("Facts ({:.1f} us): vendor {}, safe {}, location {}, worldspace {}, nearest marker location {} ({:.1f} us)",
+			factsTime, facts.isMerchant ? "yes" : "no", facts.isSafe ? "yes" : "no", Describe(a_container->GetCurrentLocation()),
+			Describe(a_container->GetWorldspace()), Describe(marker), markerTime));
+
+		start = Clock::now();
+		const bool mayApply = current->prefilter.Test(a_container, facts.isMerchant, facts.isSafe);
+		std::span<const uint32_t> candidates{};
+		const bool indexed = current->candidateIndex.Find(base, candidates);
+		lines.push_back(fmt::format("Prefilter and candidate index ({:.1f} us): {}, {}", Microseconds(start),
+			mayApply ? "prefilter passes" : "prefilter skips this container, no rule would run",
+			indexed ? fmt::format("{} of {} rules are candidates for this base", candidates.size(), table.size()) : "base not indexed, every rule is checked"s));
+		const std::unordered_set<uint32_t> candidateSet(candidates.begin(), candidates.end());
+
+		auto inventory = a_container->GetInventoryCounts();
+		std::map<RE::TESBoundObject*, int64_t> changes{};
+		auto add = [&](RE::TESBoundObject* a_form, int64_t a_count, std::vector<std::string>& a_effects) {
+			inventory[a_form] += static_cast<int32_t>(a_count);
+			changes[a_form] += a_count;
+			a_effects.push_back(fmt::format("add {} x{}{}", Describe(a_form), a_count, a_form->As<RE::TESLeveledList>() ? " (leveled list)" : ""));
+		};
+		auto remove = [&](RE::TESBoundObject* a_form, int64_t a_count, std::vector<std::string>& a_effects) {
+			inventory[a_form] -= static_cast<int32_t>(a_count);
+			if (inventory[a_form] <= 0) {
+				inventory.erase(a_form);
+			}
+			changes[a_form] -= a_count;
+			a_effects.push_back(fmt::format("remove {} x{}", Describe(a_form), a_count));
+		};
+		auto addForms = [&](size_t a_rule, int64_t a_count, std::vector<std::string>& a_effects) {
+			const auto forms = table.GetForms(a_rule);
+			if (table.HasFlag(a_rule, Rules::RuleFlag::kRandomAdd)) {
+				a_effects.push_back(fmt::format("add {} random picks from {} forms", a_count, forms.size()));
+				return;
+			}
+			for (const auto form : forms) {
+				add(form, a_count, a_effects);
+			}
+		};
+		auto matchKeywords = [&](size_t a_rule) {
+			std::vector<std::pair<RE::TESBoundObject*, int32_t>> matches{};
+			for (const auto& [item, count] : inventory) {
+				if (count > 0 && HasAllKeywords(item, table.GetKeywords(a_rule))) {
+					matches.emplace_back(item, count);
+				}
+			}
+			return matches;
+		};
+
+		size_t hidden = 0;
+		size_t applied = 0;
+		for (const auto rule : table.allRules) {
+			const bool candidate = !indexed || candidateSet.contains(rule);
+			if (!candidate && !a_allRules) {
+				++hidden;
+				continue;
+			}
+
+			const auto ruleStart = Clock::now();
+			const auto& source = ruleSources.at(table.sources[rule]);
+			const auto type = table.types[rule];
+			lines.push_back(fmt::format("#{} {} <{}>/[{}]{}", rule, Rules::GetRuleTypeName(type), source.path, source.friendlyName,
+				candidate ? "" : ", not a candidate for this base"));
+
+			std::string_view flagFailure{};
+			if (facts.isMerchant && !table.HasFlag(rule, Rules::RuleFlag::kAllowVendors)) {
+				flagFailure = "vendor container without allowVendors"sv;
+			}
+			else if (!facts.isMerchant && table.HasFlag(rule, Rules::RuleFlag::kOnlyVendors)) {
+				flagFailure = "onlyVendors, not a vendor container"sv;
+			}
+			else if (facts.isSafe && !table.HasFlag(rule, Rules::RuleFlag::kAllowSafeBypass)) {
+				flagFailure = "safe container without bypassUnsafeContainers"sv;
+			}
+			if (!flagFailure.empty()) {
+				lines.push_back(fmt::format("    FAIL {}", flagFailure));
+			}
+
+			//Every condition is evaluated, not just up to the first failure like PreCheck does.
+			bool conditionsPass = true;
+			for (const auto condition : table.GetConditions(rule)) {
+				const auto conditionStart = Clock::now();
+				const auto& stored = current->conditions[condition];
+				const bool valid = stored->IsValid(a_container);
+				conditionsPass = conditionsPass && valid;
+				lines.push_back(fmt::format("    {} {}{} condition #{} ({:.1f} us)", valid ? "pass" : "FAIL", stored->inverted ? "inverted " : "",
+					Conditions::GetConditionTypeName(stored->GetType()), condition, Microseconds(conditionStart)));
+			}
+
+			std::vector<std::string> effects{};
+			std::string_view nothing{};
+			if (!mayApply || !candidate || !flagFailure.empty() || !conditionsPass) {
+				nothing = "checks fail"sv;
+			}
+			else {
+				const auto count = table.counts[rule];
+				switch (type) {
+				case Rules::RuleType::kAdd:
+					addForms(rule, count, effects);
+					break;
+				case Rules::RuleType::kRemove:
+				case Rules::RuleType::kReplace:
+					{
+						const auto target = table.targets[rule];
+						const auto it = inventory.find(target);
+						if (it == inventory.end()) {
+							nothing = "form not in the inventory"sv;
+							break;
+						}
+						const int64_t present = it->second;
+						const int64_t removed = type == Rules::RuleType::kRemove && count != 0 && count < present ? count : present;
+						remove(target, removed, effects);
+						if (type == Rules::RuleType::kReplace) {
+							addForms(rule, removed, effects);
+						}
+					}
+					break;
+				case Rules::RuleType::kRemoveKeyword:
+				case Rules::RuleType::kReplaceKeyword:
+					{
+						const auto matches = matchKeywords(rule);
+						if (matches.empty()) {
+							nothing = "no item has all the keywords"sv;
+							break;
+						}
+						int64_t removed = 0;
+						for (const auto& [item, itemCount] : matches) {
+							remove(item, itemCount, effects);
+							removed += itemCount;
+						}
+						if (type == Rules::RuleType::kReplaceKeyword) {
+							addForms(rule, removed, effects);
+						}
+					}
+					break;
+				default:
+					break;
+				}
+			}
+
+			if (effects.empty()) {
+				lines.push_back(fmt::format("    -> nothing, {} ({:.1f} us)", nothing.empty() ? "no forms"sv : nothing, Microseconds(ruleStart)));
+				continue;
+			}
+			++applied;
+			for (const auto& effect : effects) {
+				lines.push_back(fmt::format("    -> would {}", effect));
 			}
+			lines.push_back(fmt::format("    ({:.1f} us)", Microseconds(ruleStart)));
 		}
-		if (!replaceKeywords.empty()) {
-			logger::info("New replace by keyword rules:");
-			for (auto& rule : replaceKeywords) {
-				rule.Print();
-				logger::info("=================================");
+
+		std::string summary{};
+		for (const auto& [form, change] : changes) {
+			if (change != 0) {
+				summary += fmt::format("{}{}{} {}", summary.empty() ? "" : ", ", change > 0 ? "+" : "", change, Describe(form));
 			}
 		}
+		lines.push_back(fmt::format("{} rules would change the inventory: {}", applied, summary.empty() ? "no net change"s : summary));
+		if (hidden > 0) {
+			lines.push_back(fmt::format("{} rules can't match this base and are hidden, \"cdf explain all\" lists them.", hidden));
+		}
+		lines.push_back(fmt::format("Dry run took {:.1f} us, the inventory was not changed.", Microseconds(totalStart)));
+		return lines;
 	}
 
 	void ContainerManager::Initialize(RE::TESObjectREFR* a_container, bool a3)
 	{
 		_initialize(a_container, a3);
 		if (a_container && a_container->GetBaseObject() && a_container->GetBaseObject()->As<RE::TESObjectCONT>()) {
-			ContainerManager::GetSingleton()->ProcessContainer(a_container);
+			Profiling::TraceScope trace{ Profiling::TraceEvent::kInitialize, a_container->GetFormID() };
+			Profiling::LatencyTimer latency{ Profiling::LatencyPhase::kInitialize };
+			if (const auto stats = Profiling::GetLiveStats()) {
+				stats->hookCalls[0].fetch_add(1, std::memory_order_relaxed);
+			}
+			auto* manager = ContainerManager::GetSingleton();
+			const auto current = manager->snapshot.load();
+			if (!current) {
+				return;
+			}
+			Profiling::AllocationHookScope allocations{ 0, current->allocations };
+			ContainerFacts facts{};
+			if (manager->ShouldProcess(*current, a_container, facts)) {
+				manager->ProcessContainer(*current, a_container, facts);
+			}
 		}
 	}
 
@@ -237,278 +1046,372 @@ namespace Hooks {
 	{
 		_reset(a_container, a3);
 		if (a_container && a_container->GetBaseObject() && a_container->GetBaseObject()->As<RE::TESObjectCONT>()) {
-			ContainerManager::GetSingleton()->ProcessContainer(a_container);
+			Profiling::TraceScope trace{ Profiling::TraceEvent::kReset, a_container->GetFormID() };
+			Profiling::LatencyTimer latency{ Profiling::LatencyPhase::kReset };
+			if (const auto stats = Profiling::GetLiveStats()) {
+				stats->hookCalls[1].fetch_add(1, std::memory_order_relaxed);
+			}
+			auto* manager = ContainerManager::GetSingleton();
+			const auto current = manager->snapshot.load();
+			if (!current) {
+				return;
+			}
+			Profiling::AllocationHookScope allocations{ 1, current->allocations };
+			ContainerFacts facts{};
+			if (manager->ShouldProcess(*current, a_container, facts)) {
+				manager->ProcessContainer(*current, a_container, facts);
+			}
+		}
+	}
+
+	bool ContainerManager::ShouldProcess(Snapshot& a_snapshot, RE::TESObjectREFR* a_container, ContainerFacts& a_facts)
+	{
+		if (a_snapshot.table.empty()) {
+			return false;
+		}
+
+		ResolveFacts(a_container, a_facts);
+		const bool mayApply = a_snapshot.prefilter.MayApply(a_container, a_facts.isMerchant, a_facts.isSafe);
+		if (const auto stats = Profiling::GetLiveStats()) {
+			(mayApply ? stats->prefilterPassed : stats->prefilterRejected).fetch_add(1, std::memory_order_relaxed);
 		}
+		return mayApply;
 	}
 
-	void ContainerManager::ProcessContainer(RE::TESObjectREFR* a_container)
+	void ContainerManager::ProcessContainer(Snapshot& a_snapshot, RE::TESObjectREFR* a_container, ContainerFacts& a_facts)
 	{
 #ifdef DEBUG
 		const auto then = std::chrono::high_resolution_clock::now();
 #endif
-		for (auto& add : adds) {
-			add.Apply(a_container);
+		Profiling::TraceScope trace{ Profiling::TraceEvent::kProcessContainer, a_container->GetFormID() };
+		Profiling::LatencyTimer latency{ Profiling::LatencyPhase::kProcessContainer };
+		if (a_snapshot.counters.IsBuilt() && Profiling::ShouldSample()) {
+			a_facts.probe = Profiling::Probe{ &a_snapshot.counters };
+		}
+		const auto profileStart = a_facts.probe.Now();
+		const auto stats = Profiling::GetLiveStats();
+		if (stats) {
+			stats->BeginProcessing();
+		}
+		auto dispatch = [&](size_t a_rule) {
+			Profiling::TraceScope ruleTrace{ Profiling::TraceEvent::kApplyRule, a_container->GetFormID(), a_snapshot.traceLabels[a_rule], static_cast<uint8_t>(a_snapshot.table.types[a_rule]) };
+			Profiling::RuleTimer timer{ a_facts.probe, a_rule };
+			Profiling::LatencyTimer ruleLatency{ GetApplyPhase(a_snapshot.table.types[a_rule]), static_cast<bool>(a_facts.probe) };
+			Profiling::AllocationRuleScope allocations{ a_rule, static_cast<size_t>(a_snapshot.table.types[a_rule]) };
+			a_facts.probe.Visit(a_rule);
+			if (stats) {
+				stats->ruleVisits[static_cast<size_t>(a_snapshot.table.types[a_rule])].fetch_add(1, std::memory_order_relaxed);
+			}
+			switch (a_snapshot.table.types[a_rule]) {
+			case Rules::RuleType::kAdd:
+				ApplyAdd(a_snapshot, a_rule, a_container, a_facts);
+				break;
+			case Rules::RuleType::kRemove:
+				ApplyRemove(a_snapshot, a_rule, a_container, a_facts);
+				break;
+			case Rules::RuleType::kReplace:
+				ApplyReplace(a_snapshot, a_rule, a_container, a_facts);
+				break;
+			case Rules::RuleType::kReplaceKeyword:
+				ApplyReplaceKeyword(a_snapshot, a_rule, a_container, a_facts);
+				break;
+			default:
+				break;
+			}
+		};
+
+		//Base containers known at load have a precomputed candidate list with their static checks
+		//already done. Anything else goes through the whole a_snapshot.table.
+		const auto base = a_container->GetBaseObject()->As<RE::TESObjectCONT>();
+		std::span<const uint32_t> rulesToRun = a_snapshot.table.allRules;
+		std::span<const uint32_t> candidates{};
+		if (a_snapshot.candidateIndex.Find(base, candidates)) {
+			a_facts.staticChecked = true;
+			rulesToRun = candidates;
 		}
-		for (auto& remove : removes) {
-			remove.Apply(a_container);
+		if (stats) {
+			(a_facts.staticChecked ? stats->candidateHits : stats->candidateMisses).fetch_add(1, std::memory_order_relaxed);
 		}
-		for (auto& remove : removeKeywords) {
-			remove.Apply(a_container);
+
+		for (size_t i = 0; i < rulesToRun.size(); ++i) {
+			//Keyword removals only remove, so consecutive ones are matched together in one go.
+			if (a_snapshot.table.types[rulesToRun[i]] == Rules::RuleType::kRemoveKeyword) {
+				size_t end = i + 1;
+				while (end < rulesToRun.size() && a_snapshot.table.types[rulesToRun[end]] == Rules::RuleType::kRemoveKeyword) {
+					++end;
+				}
+				const auto batch = rulesToRun.subspan(i, end - i);
+				const auto start = a_facts.probe.Now();
+				if (stats) {
+					stats->ruleVisits[static_cast<size_t>(Rules::RuleType::kRemoveKeyword)].fetch_add(batch.size(), std::memory_order_relaxed);
+				}
+				{
+					//One sample per batch, that is what a container waits for.
+					Profiling::LatencyTimer batchLatency{ Profiling::LatencyPhase::kApplyRemoveKeyword, static_cast<bool>(a_facts.probe) };
+					Profiling::AllocationRuleScope allocations{ Profiling::AllocationContext::noRule, static_cast<size_t>(Rules::RuleType::kRemoveKeyword) };
+					ApplyRemoveKeywords(a_snapshot, batch, a_container, a_facts);
+				}
+				if (a_facts.probe) {
+					//Matching is done for the whole batch, its time is split evenly.
+					const auto share = Profiling::Since(start) / batch.size();
+					for (const auto rule : batch) {
+						a_facts.probe->Visit(rule);
+						a_facts.probe->AddTime(rule, share);
+					}
+				}
+				i = end - 1;
+				continue;
+			}
+			dispatch(rulesToRun[i]);
 		}
-		for (auto& replace : replaces) {
-			replace.Apply(a_container);
+		if (a_facts.probe) {
+			a_facts.probe->AddContainer(Profiling::Since(profileStart));
 		}
-		for (auto& replace : replaceKeywords) {
-			replace.Apply(a_container);
+		if (stats) {
+			stats->EndProcessing();
 		}
 #ifdef DEBUG
 		const auto now = std::chrono::high_resolution_clock::now();
 		const auto timespan = now - then;
 		const auto durationSpan = timespan.count();
 		if (durationSpan > 10000) {
+			Profiling::AllocationSiteScope allocations{ Profiling::AllocationSite::kLogging };
 			logger::debug("Processed {} in {}ns", Utilities::EDID::GetEditorID(a_container->GetBaseObject()), durationSpan);
 		}
 #endif
 	}
 
-	void ContainerManager::AddRule::Apply(RE::TESObjectREFR* a_container)
-	{		
-		if (!PreCheck(a_container)) {
-			return;
+	void ContainerManager::ResolveFacts(RE::TESObjectREFR* a_container, ContainerFacts& a_facts, bool a_countStats)
+	{
+		Profiling::AllocationSiteScope allocations{ Profiling::AllocationSite::kFacts };
+		const auto owner = a_container->GetFactionOwner();
+		a_facts.isMerchant = owner ? owner->IsVendor() : false;
+		if (!a_facts.isMerchant) {
+			a_facts.isMerchant = MerchantCache::MerchantCache::GetSingleton()->IsMerchantContainer(a_container);
+			if (const auto stats = a_countStats ? Profiling::GetLiveStats() : nullptr) {
+				stats->merchantLookups.fetch_add(1, std::memory_order_relaxed);
+				stats->merchantHits.fetch_add(a_facts.isMerchant ? 1 : 0, std::memory_order_relaxed);
+			}
 		}
 
-		uint32_t count = ruleCount;
-		if (randomAdd) {
-			size_t upper = newForms.size() - 1;
-			for (auto i = (size_t)0; i < count; ++i) {
-				const auto index = clib_util::RNG().generate((size_t)0, upper);
-				const auto obj = newForms.at(index);
-				if (const auto leveledList = obj->As<RE::TESLeveledList>()) {
-					AddLeveledListToContainer(leveledList, a_container, 1);
-				}
-				else {
-					a_container->AddObjectToContainer(newForms.at(index), nullptr, 1, nullptr);
-				}
-			}
+		const auto containerBase = a_container->GetBaseObject()->As<RE::TESObjectCONT>();
+		a_facts.isSafe = false;
+		if (containerBase && !(containerBase->data.flags & RE::CONT_DATA::Flag::kRespawn)) {
+			a_facts.isSafe = true;
 		}
-		else {
-			for (const auto baseObj : newForms) {
-				if (const auto leveledList = baseObj->As<RE::TESLeveledList>()) {
-					AddLeveledListToContainer(leveledList, a_container, count);
-				}
-				else {
-					a_container->AddObjectToContainer(baseObj, nullptr, count, nullptr);
-				}
-			}
+
+		bool hasParentCell = a_container->parentCell ? true : false;
+		auto* parentEncounterZone = hasParentCell ? a_container->parentCell->extraList.GetEncounterZone() : nullptr;
+		if (parentEncounterZone && parentEncounterZone->data.flags & RE::ENCOUNTER_ZONE_DATA::Flag::kNeverResets) {
+			a_facts.isSafe = true;
 		}
+		a_facts.resolved = true;
 	}
 
-	void ContainerManager::AddRule::Print()
+	bool ContainerManager::PreCheck(Snapshot& a_snapshot, size_t a_rule, RE::TESObjectREFR* a_container, ContainerFacts& a_facts)
 	{
-		const auto singleton = ContainerManager::GetSingleton();
-		if (!conditions.empty()) {
-			logger::info("Conditions:");
-			for (const auto condition : conditions) {
-				singleton->storedConditions.at(condition)->Print();
-			}
-		}
-		logger::info("----------------------------");
-		logger::info("Count: {}", ruleCount);
-		logger::info("Forms:");
-		for (const auto& form : newForms) {
-			logger::info("  ->{}", form->GetName());
+		if (!a_facts.resolved) {
+			ResolveFacts(a_container, a_facts);
 		}
-	}
 
-	void ContainerManager::RemoveRule::Apply(RE::TESObjectREFR* a_container)
-	{
-		auto inventory = a_container->GetInventory();
-		if (!inventory.contains(form)) {
-			return;
+		if (a_facts.isMerchant && !a_snapshot.table.HasFlag(a_rule, Rules::RuleFlag::kAllowVendors)) {
+			return false;
 		}
-		if (!PreCheck(a_container)) {
-			return;
+		if (!a_facts.isMerchant && a_snapshot.table.HasFlag(a_rule, Rules::RuleFlag::kOnlyVendors)) {
+			return false;
+		}
+		if (a_facts.isSafe && !a_snapshot.table.HasFlag(a_rule, Rules::RuleFlag::kAllowSafeBypass)) {
+			return false;
 		}
 
-		int32_t countToRemove = ruleCount;
-		if (countToRemove == 0 || countToRemove > inventory[form].first) {
-			countToRemove = inventory[form].first;
+		const auto conditions = a_facts.staticChecked ? a_snapshot.table.GetDynamicConditions(a_rule) : a_snapshot.table.GetConditions(a_rule);
+		Profiling::AllocationSiteScope allocations{ Profiling::AllocationSite::kConditions };
+		for (const auto condition : conditions) {
+			const auto start = a_facts.probe.Now();
+			const bool valid = a_snapshot.conditions[condition]->IsValid(a_container);
+			a_facts.probe.Evaluate(condition, valid, start);
+			if (!valid) {
+				return false;
+			}
 		}
-		a_container->RemoveItem(form, countToRemove, RE::ITEM_REMOVE_REASON::kRemove, nullptr, nullptr);
+		a_facts.probe.Pass(a_rule);
+		return true;
 	}
 
-	void ContainerManager::RemoveRule::Print()
+	void ContainerManager::CountApply(Snapshot& a_snapshot, size_t a_rule, ContainerFacts& a_facts)
 	{
-		const auto singleton = ContainerManager::GetSingleton();
-		if (!conditions.empty()) {
-			logger::info("Conditions:");
-			for (const auto condition : conditions) {
-				singleton->storedConditions.at(condition)->Print();
-			}
+		a_facts.probe.Apply(a_rule);
+		if (const auto stats = Profiling::GetLiveStats()) {
+			stats->RuleApplied(a_rule, static_cast<size_t>(a_snapshot.table.types[a_rule]));
 		}
-		logger::info("----------------------------");
-		logger::info("Count: {}", ruleCount == 0 ? "All" : std::to_string(ruleCount));
-		logger::info("Form: {}", form->GetName());
 	}
 
-	void ContainerManager::ReplaceRule::Apply(RE::TESObjectREFR* a_container)
+	uint64_t ContainerManager::AddForms(Snapshot& a_snapshot, size_t a_rule, RE::TESObjectREFR* a_container, uint32_t a_count)
 	{
-		auto inventory = a_container->GetInventory();
-		if (!inventory.contains(oldForm)) {
-			return;
-		}
-		if (!PreCheck(a_container)) {
-			return;
-		}
-		int32_t count = inventory[oldForm].first;
-		a_container->RemoveItem(oldForm, count, RE::ITEM_REMOVE_REASON::kRemove, nullptr, nullptr);
-		if (randomAdd) {
+		//Returns the number of items added, a leveled list counts as its count whatever it resolved to.
+		const auto newForms = a_snapshot.table.GetForms(a_rule);
+		if (a_snapshot.table.HasFlag(a_rule, Rules::RuleFlag::kRandomAdd)) {
 			size_t upper = newForms.size() - 1;
-			for (auto i = (size_t)0; i < count; ++i) {
+			for (auto i = (size_t)0; i < a_count; ++i) {
 				const auto index = clib_util::RNG().generate((size_t)0, upper);
-				const auto obj = newForms.at(index);
+				const auto obj = newForms[index];
 				if (const auto leveledList = obj->As<RE::TESLeveledList>()) {
 					AddLeveledListToContainer(leveledList, a_container, 1);
 				}
 				else {
-					a_container->AddObjectToContainer(newForms.at(index), nullptr, 1, nullptr);
+					a_container->AddObjectToContainer(obj, nullptr, 1, nullptr);
 				}
 			}
+			return a_count;
 		}
 		else {
 			for (const auto baseObj : newForms) {
 				if (const auto leveledList = baseObj->As<RE::TESLeveledList>()) {
-					AddLeveledListToContainer(leveledList, a_container, count);
+					AddLeveledListToContainer(leveledList, a_container, a_count);
 				}
 				else {
-					a_container->AddObjectToContainer(baseObj, nullptr, count, nullptr);
+					a_container->AddObjectToContainer(baseObj, nullptr, a_count, nullptr);
 				}
 			}
+			return static_cast<uint64_t>(a_count) * newForms.size();
 		}
 	}
 
-	void ContainerManager::ReplaceRule::Print()
+	void ContainerManager::ApplyAdd(Snapshot& a_snapshot, size_t a_rule, RE::TESObjectREFR* a_container, ContainerFacts& a_facts)
 	{
-		const auto singleton = ContainerManager::GetSingleton();
-		if (!conditions.empty()) {
-			logger::info("Conditions:");
-			for (const auto condition : conditions) {
-				singleton->storedConditions.at(condition)->Print();
-			}
-		}
-		logger::info("----------------------------");
-		logger::info("Form to remove: {}", oldForm->GetName());
-		logger::info("Replaced by:");
-		for (const auto& form : newForms) {
-			logger::info("  ->{}", form->GetName());
+		if (!PreCheck(a_snapshot, a_rule, a_container, a_facts)) {
+			return;
 		}
+		a_facts.probe.AddItems(a_rule, AddForms(a_snapshot, a_rule, a_container, a_snapshot.table.counts[a_rule]));
+		CountApply(a_snapshot, a_rule, a_facts);
 	}
 
-	bool ContainerManager::Rule::PreCheck(RE::TESObjectREFR* a_container)
+	void ContainerManager::ApplyRemove(Snapshot& a_snapshot, size_t a_rule, RE::TESObjectREFR* a_container, ContainerFacts& a_facts)
 	{
-		const auto owner = a_container->GetFactionOwner();
-		auto isMerchant = owner ? owner->IsVendor() : false;
-		if (!isMerchant) {
-			isMerchant = MerchantCache::MerchantCache::GetSingleton()->IsMerchantContainer(a_container);
-		}
-		if (isMerchant && !allowVendors) {
-			return false;
-		}
-		if (!isMerchant && onlyVendors) {
-			return false;
+		const auto form = a_snapshot.table.targets[a_rule];
+		auto inventory = ReadInventory(a_container);
+		a_facts.probe.ScanInventory(a_rule, inventory.size());
+		const auto entry = inventory.find(form);
+		if (entry == inventory.end()) {
+			return;
 		}
-
-		const auto containerBase = a_container->GetBaseObject()->As<RE::TESObjectCONT>();
-		bool isSafeContainer = false;
-		if (containerBase && !(containerBase->data.flags & RE::CONT_DATA::Flag::kRespawn)) {
-			isSafeContainer = true;
+		if (!PreCheck(a_snapshot, a_rule, a_container, a_facts)) {
+			return;
 		}
 
-		bool hasParentCell = a_container->parentCell ? true : false;
-		auto* parentEncounterZone = hasParentCell ? a_container->parentCell->extraList.GetEncounterZone() : nullptr;
-		if (parentEncounterZone && parentEncounterZone->data.flags & RE::ENCOUNTER_ZONE_DATA::Flag::kNeverResets) {
-			isSafeContainer = true;
+		int32_t countToRemove = a_snapshot.table.counts[a_rule];
+		if (countToRemove == 0 || countToRemove > entry->second.first) {
+			countToRemove = entry->second.first;
 		}
+		a_container->RemoveItem(form, countToRemove, RE::ITEM_REMOVE_REASON::kRemove, nullptr, nullptr);
+		a_facts.probe.RemoveItems(a_rule, countToRemove);
+		CountApply(a_snapshot, a_rule, a_facts);
+	}
 
-		if (isSafeContainer && !allowSafeBypass) {
-			return false;
+	void ContainerManager::ApplyReplace(Snapshot& a_snapshot, size_t a_rule, RE::TESObjectREFR* a_container, ContainerFacts& a_facts)
+	{
+		const auto oldForm = a_snapshot.table.targets[a_rule];
+		auto inventory = ReadInventory(a_container);
+		a_facts.probe.ScanInventory(a_rule, inventory.size());
+		const auto entry = inventory.find(oldForm);
+		if (entry == inventory.end()) {
+			return;
 		}
-
-		for (auto& condition : conditions) {
-			if (!ContainerManager::GetSingleton()->storedConditions.at(condition)->IsValid(a_container)) {
-				return false;
-			}
+		if (!PreCheck(a_snapshot, a_rule, a_container, a_facts)) {
+			return;
 		}
 
-		return true;
+		int32_t count = entry->second.first;
+		a_container->RemoveItem(oldForm, count, RE::ITEM_REMOVE_REASON::kRemove, nullptr, nullptr);
+		a_facts.probe.AddItems(a_rule, AddForms(a_snapshot, a_rule, a_container, count));
+		a_facts.probe.RemoveItems(a_rule, count);
+		CountApply(a_snapshot, a_rule, a_facts);
 	}
 
-	void ContainerManager::RemoveKeywordRule::Apply(RE::TESObjectREFR* a_container)
+	void ContainerManager::ApplyRemoveKeywords(Snapshot& a_snapshot, std::span<const uint32_t> a_rules, RE::TESObjectREFR* a_container, ContainerFacts& a_facts)
 	{
-		auto inventory = a_container->GetInventory();
+		auto inventory = ReadInventory(a_container);
+		for (const auto rule : a_rules) {
+			a_facts.probe.ScanInventory(rule, inventory.size());
+		}
 		if (inventory.empty()) {
 			return;
 		}
 
-		//This is a awkward one. Results are mixed on whether it is faster to iterate through the inventory
-		//first or the rules. When I get around to the rule matching algorithm, rules should be faster on
-		//average.
-		std::vector<std::pair<RE::TESBoundObject*, uint32_t>> removals{};
+		Profiling::AllocationSiteScope allocations{ Profiling::AllocationSite::kKeywordMatch };
+		std::vector<RE::TESBoundObject*> items{};
+		std::vector<int32_t> counts{};
+		items.reserve(inventory.size());
+		counts.reserve(inventory.size());
 		for (const auto& inventoryEntry : inventory) {
-			bool shouldSkip = false;
-			for (auto it = keywordsToRemove.begin(); !shouldSkip && it != keywordsToRemove.end(); ++it) {
-				const auto keywordForm = inventoryEntry.first->As<RE::BGSKeywordForm>();
-				if (!keywordForm || !keywordForm->HasKeyword(*it)) {
-					shouldSkip = true;
+			items.push_back(inventoryEntry.first);
+			counts.push_back(inventoryEntry.second.first);
+		}
+
+		//Which way round is fastest depends on the inventory size and the number of rules, see
+		//Rules::KeywordMatching::Choose.
+		const auto strategy = Rules::KeywordMatching::Choose({ items.size(), a_rules.size() });
+		std::vector<std::vector<uint32_t>> matches{};
+		Rules::KeywordMatching::Match<RE::TESBoundObject*, RE::BGSKeyword*>(
+			strategy, std::span<RE::TESBoundObject* const>(items), a_rules.size(),
+			[&](size_t a_rule) { return a_snapshot.table.GetKeywords(a_rules[a_rule]); },
+			[](RE::TESBoundObject* a_item, RE::BGSKeyword* a_keyword) {
+				const auto keywordForm = a_item->As<RE::BGSKeywordForm>();
+				return keywordForm && keywordForm->HasKeyword(a_keyword);
+			},
+			[](RE::TESBoundObject* a_item, auto&& a_callback) {
+				const auto keywordForm = a_item->As<RE::BGSKeywordForm>();
+				if (!keywordForm) {
+					return;
 				}
+				for (uint32_t i = 0; i < keywordForm->numKeywords; ++i) {
+					if (keywordForm->keywords[i]) {
+						a_callback(keywordForm->keywords[i]);
+					}
+				}
+			},
+			matches);
+
+		//Rules still apply in order, an item taken by an earlier rule is gone for the later ones.
+		std::vector<bool> removed(items.size(), false);
+		for (size_t rule = 0; rule < a_rules.size(); ++rule) {
+			auto& removals = matches[rule];
+			std::erase_if(removals, [&](uint32_t a_item) { return removed[a_item]; });
+			if (removals.empty()) {
+				continue;
 			}
-			if (shouldSkip) {
+			//Matching is shared by the batch, a rule's event only covers its own checks and removals.
+			Profiling::TraceScope trace{ Profiling::TraceEvent::kApplyRule, a_container->GetFormID(), a_snapshot.traceLabels[a_rules[rule]], static_cast<uint8_t>(Rules::RuleType::kRemoveKeyword) };
+			Profiling::AllocationRuleScope ruleAllocations{ a_rules[rule], static_cast<size_t>(Rules::RuleType::kRemoveKeyword) };
+			if (!PreCheck(a_snapshot, a_rules[rule], a_container, a_facts)) {
 				continue;
 			}
 
-			removals.push_back({ inventoryEntry.first, inventoryEntry.second.first });
-		}
-		if (removals.empty()) {
-			return;
-		}
-		if (!PreCheck(a_container)) {
-			return;
-		}
-
-		for (const auto& pair : removals) {
-			a_container->RemoveItem(pair.first, pair.second, RE::ITEM_REMOVE_REASON::kRemove, nullptr, nullptr);
-		}
-	}
-
-	void ContainerManager::RemoveKeywordRule::Print()
-	{
-		const auto singleton = ContainerManager::GetSingleton();
-		if (!conditions.empty()) {
-			logger::info("Conditions:");
-			for (const auto condition : conditions) {
-				singleton->storedConditions.at(condition)->Print();
+			for (const auto item : removals) {
+				a_container->RemoveItem(items[item], counts[item], RE::ITEM_REMOVE_REASON::kRemove, nullptr, nullptr);
+				removed[item] = true;
+				a_facts.probe.RemoveItems(a_rules[rule], counts[item]);
 			}
-		}
-		logger::info("----------------------------");
-		logger::info("If an item has all of these keywords, it will be removed:");
-		for (const auto keyword : keywordsToRemove) {
-			logger::info("  ->{}", keyword->GetFormEditorID());
+			CountApply(a_snapshot, a_rules[rule], a_facts);
 		}
 	}
 
-	void ContainerManager::ReplaceKeywordRule::Apply(RE::TESObjectREFR* a_container)
+	void ContainerManager::ApplyReplaceKeyword(Snapshot& a_snapshot, size_t a_rule, RE::TESObjectREFR* a_container, ContainerFacts& a_facts)
 	{
-		auto inventory = a_container->GetInventory();
+		auto inventory = ReadInventory(a_container);
+		a_facts.probe.ScanInventory(a_rule, inventory.size());
 		if (inventory.empty()) {
 			return;
 		}
 
+		const auto keywordsToRemove = a_snapshot.table.GetKeywords(a_rule);
 		uint32_t count = (size_t)0;
 		std::vector<std::pair<RE::TESBoundObject*, uint32_t>> removals{};
+		Profiling::AllocationSiteScope allocations{ Profiling::AllocationSite::kKeywordMatch };
 		for (const auto& inventoryEntry : inventory) {
+			const auto keywordForm = inventoryEntry.first->As<RE::BGSKeywordForm>();
 			bool shouldSkip = false;
 			for (auto it = keywordsToRemove.begin(); !shouldSkip && it != keywordsToRemove.end(); ++it) {
-				const auto keywordForm = inventoryEntry.first->As<RE::BGSKeywordForm>();
 				if (!keywordForm || !keywordForm->HasKeyword(*it)) {
 					shouldSkip = true;
 				}
@@ -523,55 +1426,15 @@ namespace Hooks {
 		if (removals.empty()) {
 			return;
 		}
-		if (!PreCheck(a_container)) {
+		if (!PreCheck(a_snapshot, a_rule, a_container, a_facts)) {
 			return;
 		}
 
 		for (const auto& pair : removals) {
 			a_container->RemoveItem(pair.first, pair.second, RE::ITEM_REMOVE_REASON::kRemove, nullptr, nullptr);
 		}
-		if (randomAdd) {
-			size_t upper = newForms.size() - 1;
-			for (auto i = (size_t)0; i < count; ++i) {
-				const auto index = clib_util::RNG().generate((size_t)0, upper);
-				const auto obj = newForms.at(index);
-				if (const auto leveledList = obj->As<RE::TESLeveledList>()) {
-					AddLeveledListToContainer(leveledList, a_container, 1);
-				}
-				else {
-					a_container->AddObjectToContainer(newForms.at(index), nullptr, 1, nullptr);
-				}
-			}
-		}
-		else {
-			for (const auto baseObj : newForms) {
-				if (const auto leveledList = baseObj->As<RE::TESLeveledList>()) {
-					AddLeveledListToContainer(leveledList, a_container, count);
-				}
-				else {
-					a_container->AddObjectToContainer(baseObj, nullptr, count, nullptr);
-				}
-			}
-		}
-	}
-
-	void ContainerManager::ReplaceKeywordRule::Print()
-	{
-		const auto singleton = ContainerManager::GetSingleton();
-		if (!conditions.empty()) {
-			logger::info("Conditions:");
-			for (const auto condition : conditions) {
-				singleton->storedConditions.at(condition)->Print();
-			}
-		}
-		logger::info("----------------------------");
-		logger::info("If an item has all of these keywords, it will be removed:");
-		for (const auto keyword : keywordsToRemove) {
-			logger::info("  ->{}", keyword->GetFormEditorID());
-		}
-		logger::info("And replaced by:");
-		for (const auto form : newForms) {
-			logger::info("  ->{}", form->GetName());
-		}
+		a_facts.probe.AddItems(a_rule, AddForms(a_snapshot, a_rule, a_container, count));
+		a_facts.probe.RemoveItems(a_rule, count);
+		CountApply(a_snapshot, a_rule, a_facts);
 	}
 }
\ No newline at end of file
@@ -2,6 +2,14 @@
 
 #include "ClibUtil/rng.hpp"
 #include "conditions/condition.h"
+#include "profiling/allocationTracker.h"
+#include "profiling/latencyHistogram.h"
+#include "profiling/liveStats.h"
+#include "profiling/ruleProfiler.h"
+#include "profiling/traceBuffer.h"
+#include "rules/candidateIndex.h"
+#include "rules/prefilter.h"
+#include "rules/ruleTable.h"
 #include "utilities/utilities.h"
 
 namespace Hooks {
@@ -14,56 +22,73 @@ namespace Hooks {
 
 		RE::BGSLocation* GetNearestMarkerLocation(RE::TESObjectREFR* a_container);
 		void RegisterDistance(float a_newDistance);
-		void RegisterRule(Json::Value& raw, std::vector<size_t> a_conditions, bool a_safe, bool a_vendors, bool a_onlyVendors, bool a_random);
+		//A config change with its forms resolved. Presence matters, an empty add list still makes a
+		//replace, so the lists are optional. remove is only set when present.
+		struct ResolvedChange {
+			std::optional<std::vector<RE::TESBoundObject*>> add;
+			RE::TESBoundObject* remove{ nullptr };
+			std::optional<std::vector<RE::BGSKeyword*>> removeKeywords;
+			std::optional<uint32_t> count;
+		};
+
+		size_t RegisterSource(const std::string& a_path, const std::string& a_friendlyName);
+		//Stores the condition list of a config entry once, all of its changes are registered with the result.
+		Rules::Span InternConditions(std::span<const size_t> a_conditions);
+		void RegisterRule(ResolvedChange a_change, Rules::Span a_conditions, bool a_safe, bool a_vendors, bool a_onlyVendors, bool a_random, size_t a_source);
+		bool SerializeRules(Settings::Cache::Writer& a_writer);
+		bool DeserializeRules(Settings::Cache::Reader& a_reader);
+		//Hot reload: drops the rules registered from these files, so their new contents can be registered
+		//again. Finish with SortAndCompact, then Optimize and Compile.
+		void RemoveSources(const std::unordered_set<std::string>& a_paths);
+		//Puts the registered rules back in config file order and drops conditions and sources no rule uses.
+		void SortAndCompact(const std::vector<std::string>& a_fileOrder);
 		void WarmCache();
+		void Optimize();
+		void Compile();
 		void PrettyPrint();
-
-		std::vector<std::unique_ptr<Conditions::Condition>> storedConditions;
+		//Registered rules, and what is left of them after Optimize.
+		size_t GetRuleCount() const { return rules.size(); }
+		size_t GetOptimizedRuleCount() const { return optimizedRules.size(); }
+		//Bytes per rule type, condition type and cache, after Compile.
+		void LogMemoryUsage();
+		void LogStatistics();
+		//Allocation tracking report, see Profiling::AllocationHookScope. Empty unless tracking is on.
+		std::vector<std::string> ReportAllocations();
+		//Console dry run of every rule on one container. Conditions and facts are evaluated for real, the
+		//changes only go to a copy of the inventory counts. Returns the lines to print. Main thread.
+		std::vector<std::string> Explain(RE::TESObjectREFR* a_container, bool a_allRules);
+
+		Conditions::ConditionList storedConditions;
 	private:
-		struct Rule {
-			std::vector<size_t> conditions;
-
-			bool allowVendors;
-			bool onlyVendors;
-			bool allowSafeBypass;
-			bool randomAdd;
-			uint32_t ruleCount;
-
-			bool PreCheck(RE::TESObjectREFR* a_container);
-			virtual void Apply(RE::TESObjectREFR* a_container) = 0;
-			virtual void Print() = 0;
-		};
-
-		struct AddRule : public Rule {
-			std::vector<RE::TESBoundObject*> newForms;
-			void Apply(RE::TESObjectREFR* a_container) override;
-			void Print() override;
-		};
-
-		struct RemoveRule : public Rule {
-			RE::TESBoundObject* form;
-			void Apply(RE::TESObjectREFR* a_container) override;
-			void Print() override;
+		struct RuleSource {
+			std::string path;
+			std::string friendlyName;
 		};
 
-		struct RemoveKeywordRule : public Rule {
-			std::vector<RE::BGSKeyword*> keywordsToRemove;
-			void Apply(RE::TESObjectREFR* a_container) override;
-			void Print() override;
+		//Everything the Initialize/Reset hooks read. Compile builds a new one and swaps it in whole, a hook
+		//keeps the snapshot it started with alive until it returns.
+		struct Snapshot {
+			Conditions::ConditionList conditions;
+			Rules::RuleTable table;
+			Rules::Prefilter prefilter;
+			Rules::CandidateIndex candidateIndex;
+			//Only filled in profiling builds or with sampling on. Counters belong to the rules they count, a
+			//reload starts over.
+			Profiling::RuleCounters counters;
+			//Trace label of each rule, see Profiling::TraceBuffer.
+			std::vector<uint32_t> traceLabels;
+			//Only filled with allocation tracking on.
+			Profiling::RuleAllocations allocations;
 		};
 
-		struct ReplaceRule : public Rule {
-			RE::TESBoundObject* oldForm;
-			std::vector<RE::TESBoundObject*> newForms;
-			void Apply(RE::TESObjectREFR* a_container) override;
-			void Print() override;
-		};
-
-		struct ReplaceKeywordRule : public Rule {
-			std::vector<RE::BGSKeyword*> keywordsToRemove;
-			std::vector<RE::TESBoundObject*> newForms;
-			void Apply(RE::TESObjectREFR* a_container) override;
-			void Print() override;
+		//Facts about the container that every rule's PreCheck needs. Resolved at most once per container.
+		struct ContainerFacts {
+			bool resolved{ false };
+			bool isMerchant{ false };
+			bool isSafe{ false };
+			bool staticChecked{ false };
+			//Set when this container is profiled, see Profiling::ShouldSample.
+			Profiling::Probe probe;
 		};
 
 		static void Initialize(RE::TESObjectREFR* a_container, bool a3);
@@ -72,13 +97,31 @@ namespace Hooks {
 		inline static REL::Relocation<decltype(&Initialize)> _initialize;
 		inline static REL::Relocation<decltype(&Reset)> _reset;
 
-		void ProcessContainer(RE::TESObjectREFR* a_container);
-
-		std::vector<AddRule> adds;
-		std::vector<RemoveRule> removes;
-		std::vector<RemoveKeywordRule> removeKeywords;
-		std::vector<ReplaceRule> replaces;
-		std::vector<ReplaceKeywordRule> replaceKeywords;
+		bool ShouldProcess(Snapshot& a_snapshot, RE::TESObjectREFR* a_container, ContainerFacts& a_facts);
+		void ProcessContainer(Snapshot& a_snapshot, RE::TESObjectREFR* a_container, ContainerFacts& a_facts);
+		//a_countStats false keeps the lookup out of the live statistics, for the console dry run.
+		void ResolveFacts(RE::TESObjectREFR* a_container, ContainerFacts& a_facts, bool a_countStats = true);
+		bool PreCheck(Snapshot& a_snapshot, size_t a_rule, RE::TESObjectREFR* a_container, ContainerFacts& a_facts);
+		void CountApply(Snapshot& a_snapshot, size_t a_rule, ContainerFacts& a_facts);
+		uint64_t AddForms(Snapshot& a_snapshot, size_t a_rule, RE::TESObjectREFR* a_container, uint32_t a_count);
+		void ApplyAdd(Snapshot& a_snapshot, size_t a_rule, RE::TESObjectREFR* a_container, ContainerFacts& a_facts);
+		void ApplyRemove(Snapshot& a_snapshot, size_t a_rule, RE::TESObjectREFR* a_container, ContainerFacts& a_facts);
+		void ApplyRemoveKeywords(Snapshot& a_snapshot, std::span<const uint32_t> a_rules, RE::TESObjectREFR* a_container, ContainerFacts& a_facts);
+		void ApplyReplace(Snapshot& a_snapshot, size_t a_rule, RE::TESObjectREFR* a_container, ContainerFacts& a_facts);
+		void ApplyReplaceKeyword(Snapshot& a_snapshot, size_t a_rule, RE::TESObjectREFR* a_container, ContainerFacts& a_facts);
+
+		bool FoldConditions(Rules::RuleData& a_rule, size_t& a_foldedCount);
+		void LogDroppedRule(const Rules::RuleData& a_rule, std::string_view a_reason);
+		void PrintRule(const Rules::RuleData& a_rule);
+
+		//Rules as registered from the configs, kept for the rule cache and hot reload. Optimize works on
+		//a copy, which Compile turns into the snapshot.
+		std::vector<Rules::RuleData> rules;
+		std::vector<Rules::RuleData> optimizedRules;
+		//Lists of both of the above.
+		Rules::RuleLists lists;
+		std::atomic<std::shared_ptr<Snapshot>> snapshot;
+		std::vector<RuleSource> ruleSources;
 
 		float maxLookupDistance;
 		std::unordered_map<RE::TESWorldSpace*, std::vector<RE::TESObjectREFR*>> worldspaceMarkers;
@@ -1,8 +1,11 @@
 #include "merchantCache.h"
 
+#include "profiling/startupReport.h"
+
 namespace MerchantCache {
 	void MerchantCache::BuildCache()
 	{
+		Profiling::StartupTimer timer{ Profiling::StartupPhase::kMerchantCache };
 		auto* dataHandler = RE::TESDataHandler::GetSingleton();
 		if (!dataHandler) return;
 
@@ -15,6 +18,7 @@ namespace MerchantCache {
 
 			storedReferences.try_emplace(vendorContainer, true);
 		}
+		timer.SetItems(storedReferences.size());
 	}
 	bool MerchantCache::IsMerchantContainer(RE::TESObjectREFR* a_container)
 	{
@@ -7,6 +7,7 @@ namespace MerchantCache {
 	public:
 		void BuildCache();
 		bool IsMerchantContainer(RE::TESObjectREFR* a_container);
+		size_t GetMemoryUsage() const { return Utilities::Memory::GetHashMapMemoryUsage(storedReferences); }
 	private:
 		std::unordered_map<RE::TESObjectREFR*, bool> storedReferences;
 	};
@@ -0,0 +1,219 @@
+#include "allocationTracker.h"
+
+#include "profiling/ruleProfiler.h"
+
+namespace
+{
+	using Profiling::AllocationContext;
+	using Profiling::AllocationSite;
+
+	struct Totals
+	{
+		std::atomic<uint64_t> count{ 0 };
+		std::atomic<uint64_t> bytes{ 0 };
+	};
+
+	struct HookTotals
+	{
+		std::atomic<uint64_t> calls{ 0 };
+		std::atomic<uint64_t> allocationFree{ 0 };
+		std::atomic<uint64_t> count{ 0 };
+		std::atomic<uint64_t> bytes{ 0 };
+		std::atomic<uint64_t> maxCount{ 0 };
+		std::atomic<uint64_t> maxBytes{ 0 };
+	};
+
+	//Constant initialized, operator new can run before any dynamic initializer.
+	constinit std::atomic<bool> trackAllocations{ false };
+	constinit std::array<HookTotals, Profiling::Stats::hookCount> hooks{};
+	constinit std::array<Totals, Profiling::Stats::ruleTypeCount> ruleTypes{};
+	constinit std::array<Totals, static_cast<size_t>(AllocationSite::kTotal)> sites{};
+
+	constexpr std::array<std::string_view, static_cast<size_t>(AllocationSite::kTotal)> siteNames{
+		"hook"sv, "container facts"sv, "conditions"sv, "GetInventory"sv, "leveled lists"sv, "keyword matching"sv, "logging"sv
+	};
+
+	void Add(Totals& a_totals, uint64_t a_bytes)
+	{
+		a_totals.count.fetch_add(1, std::memory_order_relaxed);
+		a_totals.bytes.fetch_add(a_bytes, std::memory_order_relaxed);
+	}
+
+	void StoreMax(std::atomic<uint64_t>& a_max, uint64_t a_value)
+	{
+		auto current = a_max.load(std::memory_order_relaxed);
+		while (a_value > current && !a_max.compare_exchange_weak(current, a_value, std::memory_order_relaxed)) {}
+	}
+
+	//Only called inside a tracked hook call. Must not allocate.
+	void Count(size_t a_bytes)
+	{
+		auto& context = Profiling::allocationContext;
+		++context.count;
+		context.bytes += a_bytes;
+		Add(sites[static_cast<size_t>(context.site)], a_bytes);
+		if (context.ruleType != AllocationContext::noRuleType) {
+			Add(ruleTypes[context.ruleType], a_bytes);
+			if (context.rule != AllocationContext::noRule && context.rules) {
+				context.rules->Add(context.rule, a_bytes);
+			}
+		}
+	}
+
+	double PerCall(uint64_t a_total, uint64_t a_calls)
+	{
+		return a_calls ? static_cast<double>(a_total) / a_calls : 0.0;
+	}
+}
+
+//Replaces operator new and delete for the plugin's own code, which is what std containers, strings and
+//CommonLibSSE helpers like GetInventory allocate through. The game's heap (BSScrapArray, the extra data
+//AddObjectToContainer creates) is separate and not seen here. The array and nothrow forms forward to these.
+void* operator new(std::size_t a_size)
+{
+	if (Profiling::allocationContext.active) {
+		Count(a_size);
+	}
+	while (true) {
+		if (auto* memory = std::malloc(a_size > 0 ? a_size : 1)) {
+			return memory;
+		}
+		const auto handler = std::get_new_handler();
+		if (!handler) {
+			throw std::bad_alloc{};
+		}
+		handler();
+	}
+}
+
+void operator delete(void* a_memory) noexcept
+{
+	std::free(a_memory);
+}
+
+void operator delete(void* a_memory, std::size_t) noexcept
+{
+	std::free(a_memory);
+}
+
+namespace Profiling
+{
+	void SetTrackAllocations(bool a_enabled)
+	{
+		trackAllocations.store(a_enabled, std::memory_order_relaxed);
+	}
+
+	bool IsTrackingAllocations()
+	{
+		return trackAllocations.load(std::memory_order_relaxed);
+	}
+
+	AllocationHookScope::AllocationHookScope(size_t a_hook, RuleAllocations& a_rules) :
+		hook(a_hook)
+	{
+		auto& context = allocationContext;
+		if (context.active || !IsTrackingAllocations()) {
+			return;
+		}
+		owner = true;
+		context = AllocationContext{};
+		context.rules = a_rules.IsBuilt() ? &a_rules : nullptr;
+		context.active = true;
+	}
+
+	AllocationHookScope::~AllocationHookScope()
+	{
+		if (!owner) {
+			return;
+		}
+		auto& context = allocationContext;
+		context.active = false;
+		auto& totals = hooks[hook];
+		totals.calls.fetch_add(1, std::memory_order_relaxed);
+		if (context.count == 0) {
+			totals.allocationFree.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		totals.count.fetch_add(context.count, std::memory_order_relaxed);
+		totals.bytes.fetch_add(context.bytes, std::memory_order_relaxed);
+		StoreMax(totals.maxCount, context.count);
+		StoreMax(totals.maxBytes, context.bytes);
+	}
+
+	void RuleAllocations::Build(std::vector<std::string> a_ruleLabels)
+	{
+		counts = std::make_unique<std::atomic<uint64_t>[]>(a_ruleLabels.size());
+		bytes = std::make_unique<std::atomic<uint64_t>[]>(a_ruleLabels.size());
+		labels = std::move(a_ruleLabels);
+	}
+
+	std::vector<std::string> RuleAllocations::Report() const
+	{
+		std::vector<std::string> lines{};
+		std::vector<size_t> order{};
+		for (size_t rule = 0; rule < labels.size(); ++rule) {
+			if (bytes[rule].load(std::memory_order_relaxed) > 0) {
+				order.push_back(rule);
+			}
+		}
+		if (order.empty()) {
+			return lines;
+		}
+
+		const auto size = std::min(order.size(), GetReportSize());
+		std::partial_sort(order.begin(), order.begin() + size, order.end(), [&](size_t a_left, size_t a_right) {
+			return bytes[a_left].load(std::memory_order_relaxed) > bytes[a_right].load(std::memory_order_relaxed);
+		});
+		lines.push_back(fmt::format("{} of {} rules allocate, the {} that allocate the most:", order.size(), labels.size(), size));
+		for (size_t i = 0; i < size; ++i) {
+			const auto rule = order[i];
+			lines.push_back(fmt::format("  {:>10} bytes in {:>8} allocations  {}", bytes[rule].load(std::memory_order_relaxed), counts[rule].load(std::memory_order_relaxed), labels[rule]));
+		}
+		return lines;
+	}
+
+	std::vector<std::string> ReportAllocations()
+	{
+		std::vector<std::string> lines{};
+		for (size_t hook = 0; hook < hooks.size(); ++hook) {
+			const auto& totals = hooks[hook];
+			const auto calls = totals.calls.load(std::memory_order_relaxed);
+			if (calls == 0) {
+				continue;
+			}
+			const auto count = totals.count.load(std::memory_order_relaxed);
+			const auto bytes = totals.bytes.load(std::memory_order_relaxed);
+			lines.push_back(fmt::format("{}: {} calls, {:.1f}% without allocations, {:.1f} allocations ({:.0f} bytes) per call, at most {} allocations and {} bytes in one call",
+				Stats::hookNames[hook], calls, 100.0 * totals.allocationFree.load(std::memory_order_relaxed) / calls, PerCall(count, calls), PerCall(bytes, calls),
+				totals.maxCount.load(std::memory_order_relaxed), totals.maxBytes.load(std::memory_order_relaxed)));
+		}
+		if (lines.empty()) {
+			return lines;
+		}
+
+		auto report = [&](std::string_view a_kind, std::string_view a_name, const Totals& a_totals) {
+			if (const auto count = a_totals.count.load(std::memory_order_relaxed); count > 0) {
+				lines.push_back(fmt::format("  {} {}: {} allocations, {} bytes", a_kind, a_name, count, a_totals.bytes.load(std::memory_order_relaxed)));
+			}
+		};
+		for (size_t type = 0; type < ruleTypes.size(); ++type) {
+			report("rule type"sv, Stats::ruleTypeNames[type], ruleTypes[type]);
+		}
+		for (size_t site = 0; site < sites.size(); ++site) {
+			report("site"sv, siteNames[site], sites[site]);
+		}
+		return lines;
+	}
+
+	void LogAllocations()
+	{
+		const auto lines = ReportAllocations();
+		if (lines.empty()) {
+			return;
+		}
+		logger::info("Allocations:");
+		for (const auto& line : lines) {
+			logger::info("  {}", line);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "profiling/statsBlock.h"
+
+namespace Profiling
+{
+	//Where in the hooks an allocation was made.
+	enum class AllocationSite : uint8_t
+	{
+		//Anything not covered by a narrower site.
+		kHook,
+		kFacts,
+		kConditions,
+		kInventory,
+		kLeveledList,
+		kKeywordMatch,
+		kLogging,
+
+		kTotal
+	};
+
+	//Allocations per rule of one compiled snapshot, indexed like its rule table. Only built with
+	//allocation tracking on.
+	class RuleAllocations
+	{
+	public:
+		//a_ruleLabels: "<path>/[friendlyName] (type)" for every rule in the table.
+		void Build(std::vector<std::string> a_ruleLabels);
+		bool IsBuilt() const { return !labels.empty(); }
+		//The rules that allocated the most bytes, one line each.
+		std::vector<std::string> Report() const;
+
+		//Called from operator new, must not allocate.
+		void Add(size_t a_rule, uint64_t a_bytes)
+		{
+			counts[a_rule].fetch_add(1, std::memory_order_relaxed);
+			bytes[a_rule].fetch_add(a_bytes, std::memory_order_relaxed);
+		}
+
+	private:
+		std::unique_ptr<std::atomic<uint64_t>[]> counts;
+		std::unique_ptr<std::atomic<uint64_t>[]> bytes;
+		std::vector<std::string> labels;
+	};
+
+	//What the current thread's allocations are charged to. Only hook calls are tracked, allocations
+	//anywhere else (loading, the console, other threads) are never counted.
+	struct AllocationContext
+	{
+		static constexpr uint8_t noRuleType = 0xFF;
+		static constexpr uint32_t noRule = 0xFFFFFFFF;
+
+		bool active{ false };
+		AllocationSite site{ AllocationSite::kHook };
+		uint8_t ruleType{ noRuleType };
+		uint32_t rule{ noRule };
+		RuleAllocations* rules{ nullptr };
+		//This hook call so far.
+		uint64_t count{ 0 };
+		uint64_t bytes{ 0 };
+	};
+
+	inline thread_local constinit AllocationContext allocationContext{};
+
+	//Read from [Profiling] bTrackAllocations in the INI. Off, the plugin's operator new only reads a
+	//thread local flag.
+	void SetTrackAllocations(bool a_enabled);
+	bool IsTrackingAllocations();
+	//Per hook, rule type and site, one line each.
+	std::vector<std::string> ReportAllocations();
+	void LogAllocations();
+
+	//Counts the allocations of one Initialize or Reset call. Does nothing with tracking off or inside
+	//another hook call on the same thread.
+	class AllocationHookScope
+	{
+	public:
+		AllocationHookScope(size_t a_hook, RuleAllocations& a_rules);
+		~AllocationHookScope();
+
+		AllocationHookScope(const AllocationHookScope&) = delete;
+		AllocationHookScope& operator=(const AllocationHookScope&) = delete;
+
+	private:
+		size_t hook;
+		bool owner{ false };
+	};
+
+	class AllocationSiteScope
+	{
+	public:
+		explicit AllocationSiteScope(AllocationSite a_site) :
+			previous(allocationContext.site)
+		{
+			allocationContext.site = a_site;
+		}
+
+		~AllocationSiteScope() { allocationContext.site = previous; }
+
+		AllocationSiteScope(const AllocationSiteScope&) = delete;
+		AllocationSiteScope& operator=(const AllocationSiteScope&) = delete;
+
+	private:
+		AllocationSite previous;
+	};
+
+	//Charges allocations to a rule and its type. A batch of rules sharing work passes noRule, only
+	//its type is charged then.
+	class AllocationRuleScope
+	{
+	public:
+		AllocationRuleScope(size_t a_rule, size_t a_ruleType) :
+			previousRule(allocationContext.rule),
+			previousType(allocationContext.ruleType)
+		{
+			allocationContext.rule = static_cast<uint32_t>(a_rule);
+			allocationContext.ruleType = static_cast<uint8_t>(a_ruleType);
+		}
+
+		~AllocationRuleScope()
+		{
+			allocationContext.rule = previousRule;
+			allocationContext.ruleType = previousType;
+		}
+
+		AllocationRuleScope(const AllocationRuleScope&) = delete;
+		AllocationRuleScope& operator=(const AllocationRuleScope&) = delete;
+
+	private:
+		uint32_t previousRule;
+		uint8_t previousType;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "latencyHistogram.h"
+
+namespace
+{
+	std::string_view GetPhaseName(Profiling::LatencyPhase a_phase)
+	{
+		switch (a_phase) {
+		case Profiling::LatencyPhase::kInitialize:
+			return "Initialize"sv;
+		case Profiling::LatencyPhase::kReset:
+			return "Reset"sv;
+		case Profiling::LatencyPhase::kProcessContainer:
+			return "ProcessContainer"sv;
+		case Profiling::LatencyPhase::kApplyAdd:
+			return "Apply add"sv;
+		case Profiling::LatencyPhase::kApplyRemove:
+			return "Apply remove"sv;
+		case Profiling::LatencyPhase::kApplyRemoveKeyword:
+			return "Apply remove by keyword"sv;
+		case Profiling::LatencyPhase::kApplyReplace:
+			return "Apply replace"sv;
+		case Profiling::LatencyPhase::kApplyReplaceKeyword:
+			return "Apply replace by keyword"sv;
+		default:
+			return "Unknown"sv;
+		}
+	}
+
+	double Microseconds(uint64_t a_nanoseconds)
+	{
+		return static_cast<double>(a_nanoseconds) / 1000.0;
+	}
+}
+
+namespace Profiling
+{
+	uint64_t LatencyHistogram::GetCount() const
+	{
+		uint64_t count = 0;
+		for (const auto& bucket : buckets) {
+			count += bucket.load(std::memory_order_relaxed);
+		}
+		return count;
+	}
+
+	uint64_t LatencyHistogram::GetPercentile(double a_percentile) const
+	{
+		const auto count = GetCount();
+		if (count == 0) {
+			return 0;
+		}
+		const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(a_percentile / 100.0 * static_cast<double>(count))));
+		uint64_t seen = 0;
+		for (uint32_t bucket = 0; bucket < bucketCount; ++bucket) {
+			seen += buckets[bucket].load(std::memory_order_relaxed);
+			if (seen >= rank) {
+				return std::min(GetUpperBound(bucket), GetMax());
+			}
+		}
+		return GetMax();
+	}
+
+	std::vector<std::string> Latency::Report() const
+	{
+		std::vector<std::string> lines{};
+		for (size_t phase = 0; phase < histograms.size(); ++phase) {
+			const auto& histogram = histograms[phase];
+			const auto count = histogram.GetCount();
+			if (count == 0) {
+				continue;
+			}
+			lines.push_back(fmt::format("{:<24} {:>9} samples  p50 {:.1f} us  p90 {:.1f} us  p99 {:.1f} us  p99.9 {:.1f} us  max {:.1f} us",
+				GetPhaseName(static_cast<LatencyPhase>(phase)), count,
+				Microseconds(histogram.GetPercentile(50.0)), Microseconds(histogram.GetPercentile(90.0)),
+				Microseconds(histogram.GetPercentile(99.0)), Microseconds(histogram.GetPercentile(99.9)),
+				Microseconds(histogram.GetMax())));
+		}
+		return lines;
+	}
+
+	void Latency::Log() const
+	{
+		const auto lines = Report();
+		if (lines.empty()) {
+			return;
+		}
+		logger::info("Latency:");
+		for (const auto& line : lines) {
+			logger::info("  {}", line);
+		}
+	}
+}
\ No newline at end of file
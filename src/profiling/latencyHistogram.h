@@ -0,0 +1,122 @@
+#pragma once
+
+#include "profiling/liveStats.h"
+#include "utilities/utilities.h"
+
+namespace Profiling
+{
+	//Log-linear buckets in the style of HdrHistogram: each power of two is split into 8 sub-buckets,
+	//so a percentile is exact to within 12.5% from nanoseconds up to hours. Recording is two relaxed
+	//atomic operations and never allocates.
+	class LatencyHistogram
+	{
+	public:
+		static constexpr uint32_t subBucketBits = 3;
+		static constexpr uint32_t subBuckets = 1 << subBucketBits;
+		//Values below 2 * subBuckets get a bucket each.
+		static constexpr uint32_t linearBuckets = 2 * subBuckets;
+		static constexpr uint32_t bucketCount = linearBuckets + (64 - subBucketBits - 1) * subBuckets;
+
+		void Record(uint64_t a_nanoseconds)
+		{
+			buckets[GetBucket(a_nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+			auto current = max.load(std::memory_order_relaxed);
+			while (a_nanoseconds > current && !max.compare_exchange_weak(current, a_nanoseconds, std::memory_order_relaxed)) {}
+		}
+
+		uint64_t GetCount() const;
+		uint64_t GetMax() const { return max.load(std::memory_order_relaxed); }
+		//Highest value the bucket holding the a_percentile'th sample can contain, capped at the maximum.
+		uint64_t GetPercentile(double a_percentile) const;
+
+	private:
+		static constexpr uint32_t GetBucket(uint64_t a_value)
+		{
+			if (a_value < linearBuckets) {
+				return static_cast<uint32_t>(a_value);
+			}
+			const auto magnitude = static_cast<uint32_t>(std::bit_width(a_value)) - 1;
+			const auto subBucket = static_cast<uint32_t>(a_value >> (magnitude - subBucketBits)) & (subBuckets - 1);
+			return linearBuckets + (magnitude - subBucketBits - 1) * subBuckets + subBucket;
+		}
+
+		static constexpr uint64_t GetUpperBound(uint32_t a_bucket)
+		{
+			if (a_bucket < linearBuckets) {
+				return a_bucket;
+			}
+			const auto magnitude = (a_bucket - linearBuckets) / subBuckets + subBucketBits + 1;
+			const auto subBucket = static_cast<uint64_t>((a_bucket - linearBuckets) % subBuckets);
+			const auto width = uint64_t{ 1 } << (magnitude - subBucketBits);
+			return (uint64_t{ 1 } << magnitude) + (subBucket + 1) * width - 1;
+		}
+
+		std::array<std::atomic<uint64_t>, bucketCount> buckets{};
+		std::atomic<uint64_t> max{ 0 };
+	};
+
+	enum class LatencyPhase : uint8_t
+	{
+		kInitialize,
+		kReset,
+		kProcessContainer,
+		//One per Rules::RuleType, in its order.
+		kApplyAdd,
+		kApplyRemove,
+		kApplyRemoveKeyword,
+		kApplyReplace,
+		kApplyReplaceKeyword,
+
+		kTotal
+	};
+	static_assert(static_cast<size_t>(LatencyPhase::kTotal) == Stats::phaseCount);
+
+	//Histograms for the hooks and each rule type's Apply. Only CDF's own work is timed, not the game
+	//function a hook wraps. The hooks are always timed, Apply only in profiled containers (see
+	//Profiling::Probe), so visiting a rule reads no clock by default.
+	class Latency : public Utilities::Singleton::ISingleton<Latency>
+	{
+	public:
+		void Record(LatencyPhase a_phase, uint64_t a_nanoseconds)
+		{
+			histograms[static_cast<size_t>(a_phase)].Record(a_nanoseconds);
+			if (const auto stats = GetLiveStats()) {
+				stats->RecordLatency(static_cast<size_t>(a_phase), a_nanoseconds);
+			}
+		}
+		//One line per phase that has samples.
+		std::vector<std::string> Report() const;
+		void Log() const;
+
+	private:
+		std::array<LatencyHistogram, static_cast<size_t>(LatencyPhase::kTotal)> histograms;
+	};
+
+	//Records the time until it goes out of scope. A disabled timer reads no clock.
+	class LatencyTimer
+	{
+	public:
+		explicit LatencyTimer(LatencyPhase a_phase, bool a_enabled = true) :
+			phase(a_phase),
+			enabled(a_enabled),
+			start(a_enabled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{})
+		{}
+
+		~LatencyTimer()
+		{
+			if (!enabled) {
+				return;
+			}
+			const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+			Latency::GetSingleton()->Record(phase, static_cast<uint64_t>(elapsed));
+		}
+
+		LatencyTimer(const LatencyTimer&) = delete;
+		LatencyTimer& operator=(const LatencyTimer&) = delete;
+
+	private:
+		LatencyPhase phase;
+		bool enabled;
+		std::chrono::steady_clock::time_point start;
+	};
+}
\ No newline at end of file
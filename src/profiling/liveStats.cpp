@@ -0,0 +1,21 @@
+#include "liveStats.h"
+
+#include <process.h>
+
+namespace Profiling
+{
+	void LiveStats::Publish()
+	{
+		if (block) {
+			return;
+		}
+		std::string error{};
+		if (!memory.Create(Stats::mappingName, sizeof(Stats::Block), error)) {
+			logger::warn("Live statistics are off: {}", error);
+			return;
+		}
+		block = static_cast<Stats::Block*>(memory.GetData());
+		block->Publish(static_cast<uint32_t>(::_getpid()));
+		logger::info("Publishing live statistics in {} ({} bytes, layout version {}).", Stats::mappingName, sizeof(Stats::Block), Stats::version);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "profiling/sharedMemory.h"
+#include "profiling/statsBlock.h"
+#include "utilities/utilities.h"
+
+namespace Profiling
+{
+	//Publishes Stats::Block in shared memory for devtools/statsViewer, when [Profiling] bLiveStats is set
+	//in the INI. Until then every call is a null check.
+	class LiveStats : public Utilities::Singleton::ISingleton<LiveStats>
+	{
+	public:
+		//At plugin load, before any hook can run.
+		void Publish();
+		Stats::Block* Get() const { return block; }
+
+	private:
+		SharedMemory memory;
+		Stats::Block* block{ nullptr };
+	};
+
+	inline Stats::Block* GetLiveStats()
+	{
+		return LiveStats::GetSingleton()->Get();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "ruleProfiler.h"
+
+namespace
+{
+	size_t reportSize{ 20 };
+	uint32_t sampleRate{ 0 };
+
+	std::unique_ptr<std::atomic<uint64_t>[]> MakeColumn(size_t a_size)
+	{
+		//Value-initialized, so every counter starts at 0.
+		return std::make_unique<std::atomic<uint64_t>[]>(a_size);
+	}
+
+	//Indices sorted by a_key, largest first, cut to the report size. Entries with a zero key are left out.
+	template <class Key>
+	std::vector<size_t> Top(size_t a_count, Key a_key)
+	{
+		std::vector<size_t> order{};
+		for (size_t i = 0; i < a_count; ++i) {
+			if (a_key(i) > 0) {
+				order.push_back(i);
+			}
+		}
+		const auto size = std::min(order.size(), reportSize);
+		std::partial_sort(order.begin(), order.begin() + size, order.end(), [&](size_t a_left, size_t a_right) { return a_key(a_left) > a_key(a_right); });
+		order.resize(size);
+		return order;
+	}
+}
+
+namespace Profiling
+{
+	void SetReportSize(size_t a_size)
+	{
+		reportSize = a_size;
+	}
+
+	size_t GetReportSize()
+	{
+		return reportSize;
+	}
+
+	void SetSampleRate(uint32_t a_rate)
+	{
+		sampleRate = a_rate;
+	}
+
+	uint32_t GetSampleRate()
+	{
+		return enabled ? 1 : sampleRate;
+	}
+
+	bool IsActive()
+	{
+		return GetSampleRate() > 0;
+	}
+
+	bool ShouldSample()
+	{
+		if constexpr (enabled) {
+			return true;
+		}
+		else {
+			if (sampleRate == 0) {
+				return false;
+			}
+			thread_local uint32_t countdown{ 0 };
+			if (countdown > 0) {
+				--countdown;
+				return false;
+			}
+			countdown = sampleRate - 1;
+			return true;
+		}
+	}
+
+	void RuleCounters::Build(std::vector<std::string> a_ruleLabels, const Rules::RuleTable& a_table, const Conditions::ConditionList& a_conditions)
+	{
+		const auto ruleCount = a_table.size();
+		for (auto* column : { &rules.visited, &rules.passed, &rules.applied, &rules.itemsAdded, &rules.itemsRemoved, &rules.nanoseconds, &rules.scans, &rules.scannedEntries }) {
+			*column = MakeColumn(ruleCount);
+		}
+		for (auto* column : { &conditions.evaluations, &conditions.passes, &conditions.nanoseconds }) {
+			*column = MakeColumn(a_conditions.size());
+		}
+		ruleLabels = std::move(a_ruleLabels);
+
+		//Conditions are shared between the rules of one config entry, the first rule using one names it.
+		conditionLabels.assign(a_conditions.size(), {});
+		for (size_t rule = 0; rule < ruleCount; ++rule) {
+			for (const auto condition : a_table.GetConditions(rule)) {
+				if (conditionLabels[condition].empty()) {
+					conditionLabels[condition] = fmt::format("{}{} condition of {}", a_conditions[condition]->inverted ? "inverted " : "",
+						Conditions::GetConditionTypeName(a_conditions[condition]->GetType()), ruleLabels[rule]);
+				}
+			}
+		}
+	}
+
+	void RuleCounters::Log() const
+	{
+		const auto profiled = containers.load(std::memory_order_relaxed);
+		if (!IsBuilt() || profiled == 0) {
+			return;
+		}
+
+		//Counts and times are scaled up to every container, ratios and per-call times are measured.
+		const auto scale = GetSampleRate();
+		const auto total = containerNanoseconds.load(std::memory_order_relaxed);
+		if (scale > 1) {
+			logger::info("Profile: 1 in {} containers sampled, {} profiled. Totals below are extrapolated to about {} containers.", scale, profiled, profiled * scale);
+		}
+		logger::info("Profile: ProcessContainer took {:.3f} ms in total, {:.1f} us per container.", total * scale / 1e6, total / 1e3 / profiled);
+
+		const auto topRules = Top(ruleLabels.size(), [&](size_t a_rule) { return Get(rules.nanoseconds, a_rule); });
+		logger::info("Profile: {} most expensive of {} rules:", topRules.size(), ruleLabels.size());
+		for (const auto rule : topRules) {
+			const auto visited = Get(rules.visited, rule);
+			const auto passed = Get(rules.passed, rule);
+			const auto nanoseconds = Get(rules.nanoseconds, rule);
+			const auto scans = Get(rules.scans, rule);
+			logger::info("  {:>10.3f} ms  {} visits ({:.0f} ns each), {} passed ({:.1f}%), {} applied, +{}/-{} items, {:.1f} inventory entries per scan  {}",
+				nanoseconds * scale / 1e6, visited * scale, visited ? static_cast<double>(nanoseconds) / visited : 0.0, passed * scale, visited ? 100.0 * passed / visited : 0.0,
+				Get(rules.applied, rule) * scale, Get(rules.itemsAdded, rule) * scale, Get(rules.itemsRemoved, rule) * scale,
+				scans ? static_cast<double>(Get(rules.scannedEntries, rule)) / scans : 0.0, ruleLabels[rule]);
+		}
+
+		const auto topConditions = Top(conditionLabels.size(), [&](size_t a_condition) { return Get(conditions.nanoseconds, a_condition); });
+		logger::info("Profile: {} most expensive of {} conditions:", topConditions.size(), conditionLabels.size());
+		for (const auto condition : topConditions) {
+			const auto evaluations = Get(conditions.evaluations, condition);
+			const auto nanoseconds = Get(conditions.nanoseconds, condition);
+			logger::info("  {:>10.3f} ms  {} evaluations ({:.0f} ns each), {:.1f}% true  {}",
+				nanoseconds * scale / 1e6, evaluations * scale, evaluations ? static_cast<double>(nanoseconds) / evaluations : 0.0,
+				evaluations ? 100.0 * Get(conditions.passes, condition) / evaluations : 0.0, conditionLabels[condition]);
+		}
+	}
+}
\ No newline at end of file
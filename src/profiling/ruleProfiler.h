@@ -0,0 +1,154 @@
+#pragma once
+
+#include "conditions/condition.h"
+#include "rules/ruleTable.h"
+
+namespace Profiling
+{
+	//Set by the BUILD_PROFILE CMake option: every container is profiled. Other builds only profile the
+	//containers picked by the sampler, and nothing at all with sampling off.
+#ifdef CDF_PROFILE
+	inline constexpr bool enabled = true;
+#else
+	inline constexpr bool enabled = false;
+#endif
+
+	using Clock = std::chrono::steady_clock;
+
+	inline uint64_t Since(Clock::time_point a_start)
+	{
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - a_start).count());
+	}
+
+	//Number of rules and conditions listed by Log, read from the INI.
+	void SetReportSize(size_t a_size);
+	size_t GetReportSize();
+	//Profile 1 in a_rate ProcessContainer calls, 0 turns sampling off. Read from the INI before the first
+	//compile. Profiling builds always use 1.
+	void SetSampleRate(uint32_t a_rate);
+	uint32_t GetSampleRate();
+	//Whether compiled snapshots need counters at all.
+	bool IsActive();
+	//Counter based, per thread, so picking a container costs no shared write.
+	bool ShouldSample();
+
+	//Per-rule and per-condition counters for one compiled snapshot, indexed like its rule table and
+	//condition list. Containers can be processed on several threads, so every counter is a relaxed atomic.
+	//Only profiled containers are counted, Log scales the totals back up by the sample rate.
+	class RuleCounters
+	{
+	public:
+		//a_ruleLabels: "<path>/[friendlyName] (type)" for every rule in the table.
+		void Build(std::vector<std::string> a_ruleLabels, const Rules::RuleTable& a_table, const Conditions::ConditionList& a_conditions);
+		bool IsBuilt() const { return !ruleLabels.empty(); }
+		void Log() const;
+
+		void AddContainer(uint64_t a_nanoseconds)
+		{
+			containers.fetch_add(1, std::memory_order_relaxed);
+			containerNanoseconds.fetch_add(a_nanoseconds, std::memory_order_relaxed);
+		}
+
+		void Visit(size_t a_rule) { Add(rules.visited, a_rule, 1); }
+		void Pass(size_t a_rule) { Add(rules.passed, a_rule, 1); }
+		void Apply(size_t a_rule) { Add(rules.applied, a_rule, 1); }
+		void AddItems(size_t a_rule, uint64_t a_count) { Add(rules.itemsAdded, a_rule, a_count); }
+		void RemoveItems(size_t a_rule, uint64_t a_count) { Add(rules.itemsRemoved, a_rule, a_count); }
+		void AddTime(size_t a_rule, uint64_t a_nanoseconds) { Add(rules.nanoseconds, a_rule, a_nanoseconds); }
+		void ScanInventory(size_t a_rule, uint64_t a_entries)
+		{
+			Add(rules.scans, a_rule, 1);
+			Add(rules.scannedEntries, a_rule, a_entries);
+		}
+
+		void Evaluate(size_t a_condition, bool a_result, uint64_t a_nanoseconds)
+		{
+			Add(conditions.nanoseconds, a_condition, a_nanoseconds);
+			Add(conditions.evaluations, a_condition, 1);
+			Add(conditions.passes, a_condition, a_result ? 1 : 0);
+		}
+
+	private:
+		using Column = std::unique_ptr<std::atomic<uint64_t>[]>;
+
+		struct RuleColumns {
+			Column visited;
+			Column passed;
+			Column applied;
+			Column itemsAdded;
+			Column itemsRemoved;
+			Column nanoseconds;
+			Column scans;
+			Column scannedEntries;
+		};
+
+		struct ConditionColumns {
+			Column evaluations;
+			Column passes;
+			Column nanoseconds;
+		};
+
+		static void Add(const Column& a_column, size_t a_index, uint64_t a_value) { a_column[a_index].fetch_add(a_value, std::memory_order_relaxed); }
+		static uint64_t Get(const Column& a_column, size_t a_index) { return a_column[a_index].load(std::memory_order_relaxed); }
+
+		RuleColumns rules;
+		ConditionColumns conditions;
+		std::atomic<uint64_t> containers{ 0 };
+		std::atomic<uint64_t> containerNanoseconds{ 0 };
+		std::vector<std::string> ruleLabels;
+		std::vector<std::string> conditionLabels;
+	};
+
+	//What the hooks count through while processing one container. Empty unless the container is
+	//profiled, every call is then a branch on a null pointer and the clock is never read.
+	class Probe
+	{
+	public:
+		Probe() = default;
+		explicit Probe(RuleCounters* a_counters) :
+			counters(a_counters)
+		{}
+
+		explicit operator bool() const { return counters != nullptr; }
+		RuleCounters* operator->() const { return counters; }
+
+		Clock::time_point Now() const { return counters ? Clock::now() : Clock::time_point{}; }
+
+		void Visit(size_t a_rule) const { if (counters) counters->Visit(a_rule); }
+		void Pass(size_t a_rule) const { if (counters) counters->Pass(a_rule); }
+		void Apply(size_t a_rule) const { if (counters) counters->Apply(a_rule); }
+		void AddItems(size_t a_rule, uint64_t a_count) const { if (counters) counters->AddItems(a_rule, a_count); }
+		void RemoveItems(size_t a_rule, uint64_t a_count) const { if (counters) counters->RemoveItems(a_rule, a_count); }
+		void ScanInventory(size_t a_rule, uint64_t a_entries) const { if (counters) counters->ScanInventory(a_rule, a_entries); }
+		void Evaluate(size_t a_condition, bool a_result, Clock::time_point a_start) const { if (counters) counters->Evaluate(a_condition, a_result, Since(a_start)); }
+
+	private:
+		RuleCounters* counters{ nullptr };
+	};
+
+	//Adds the time until it goes out of scope to a rule of a profiled container.
+	class RuleTimer
+	{
+	public:
+		RuleTimer(Probe a_probe, size_t a_rule) :
+			probe(a_probe),
+			rule(a_rule),
+			start(a_probe.Now())
+		{}
+
+		~RuleTimer()
+		{
+			if (probe) {
+				probe->AddTime(rule, Since(start));
+			}
+		}
+
+		RuleTimer(const RuleTimer&) = delete;
+		RuleTimer& operator=(const RuleTimer&) = delete;
+
+	private:
+		Probe probe;
+		size_t rule;
+		Clock::time_point start;
+	};
+}
\ No newline at end of file
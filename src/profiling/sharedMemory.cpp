@@ -0,0 +1,152 @@
+#include "sharedMemory.h"
+
+#ifdef _WIN32
+#	define WIN32_LEAN_AND_MEAN
+#	define NOMINMAX
+#	include <Windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+namespace Profiling
+{
+	SharedMemory::~SharedMemory()
+	{
+		Close();
+	}
+
+#ifdef _WIN32
+	bool SharedMemory::Create(const std::string& a_name, size_t a_size, std::string& a_error)
+	{
+		Close();
+		const auto mapping = ::CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, static_cast<DWORD>(a_size), a_name.c_str());
+		if (!mapping) {
+			a_error = "Failed to create shared memory <" + a_name + ">.";
+			return false;
+		}
+		if (::GetLastError() == ERROR_ALREADY_EXISTS) {
+			::CloseHandle(mapping);
+			a_error = "Shared memory <" + a_name + "> is already in use.";
+			return false;
+		}
+		mappingHandle = mapping;
+
+		data = ::MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, a_size);
+		if (!data) {
+			a_error = "Failed to map shared memory <" + a_name + ">.";
+			Close();
+			return false;
+		}
+		size = a_size;
+		return true;
+	}
+
+	bool SharedMemory::Open(const std::string& a_name, size_t a_size, std::string& a_error)
+	{
+		Close();
+		const auto mapping = ::OpenFileMappingA(FILE_MAP_READ, FALSE, a_name.c_str());
+		if (!mapping) {
+			a_error = "Shared memory <" + a_name + "> does not exist.";
+			return false;
+		}
+		mappingHandle = mapping;
+
+		data = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		MEMORY_BASIC_INFORMATION info{};
+		if (!data || !::VirtualQuery(data, &info, sizeof(info)) || info.RegionSize < a_size) {
+			a_error = "Failed to map shared memory <" + a_name + ">.";
+			Close();
+			return false;
+		}
+		size = a_size;
+		return true;
+	}
+
+	void SharedMemory::Close()
+	{
+		if (data) {
+			::UnmapViewOfFile(data);
+		}
+		if (mappingHandle) {
+			::CloseHandle(mappingHandle);
+		}
+		data = nullptr;
+		size = 0;
+		mappingHandle = nullptr;
+		ownedName.clear();
+	}
+#else
+	bool SharedMemory::Create(const std::string& a_name, size_t a_size, std::string& a_error)
+	{
+		Close();
+		const int file = ::shm_open(a_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+		if (file < 0) {
+			a_error = "Failed to create shared memory <" + a_name + ">.";
+			return false;
+		}
+		//ftruncate zero fills.
+		if (::ftruncate(file, static_cast<off_t>(a_size)) != 0) {
+			::close(file);
+			::shm_unlink(a_name.c_str());
+			a_error = "Failed to size shared memory <" + a_name + ">.";
+			return false;
+		}
+
+		void* view = ::mmap(nullptr, a_size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+		::close(file);
+		if (view == MAP_FAILED) {
+			::shm_unlink(a_name.c_str());
+			a_error = "Failed to map shared memory <" + a_name + ">.";
+			return false;
+		}
+		data = view;
+		size = a_size;
+		ownedName = a_name;
+		return true;
+	}
+
+	bool SharedMemory::Open(const std::string& a_name, size_t a_size, std::string& a_error)
+	{
+		Close();
+		const int file = ::shm_open(a_name.c_str(), O_RDONLY, 0);
+		if (file < 0) {
+			a_error = "Shared memory <" + a_name + "> does not exist.";
+			return false;
+		}
+
+		struct stat info{};
+		if (::fstat(file, &info) != 0 || static_cast<size_t>(info.st_size) < a_size) {
+			::close(file);
+			a_error = "Shared memory <" + a_name + "> is smaller than expected.";
+			return false;
+		}
+
+		void* view = ::mmap(nullptr, a_size, PROT_READ, MAP_SHARED, file, 0);
+		::close(file);
+		if (view == MAP_FAILED) {
+			a_error = "Failed to map shared memory <" + a_name + ">.";
+			return false;
+		}
+		data = view;
+		size = a_size;
+		return true;
+	}
+
+	void SharedMemory::Close()
+	{
+		if (data) {
+			::munmap(data, size);
+		}
+		if (!ownedName.empty()) {
+			::shm_unlink(ownedName.c_str());
+		}
+		data = nullptr;
+		size = 0;
+		mappingHandle = nullptr;
+		ownedName.clear();
+	}
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace Profiling
+{
+	//Named shared memory. Game independent, also used by devtools. The creator owns the name: on Linux
+	//it is unlinked again when the creator closes it.
+	class SharedMemory
+	{
+	public:
+		SharedMemory() = default;
+		SharedMemory(const SharedMemory&) = delete;
+		SharedMemory& operator=(const SharedMemory&) = delete;
+		~SharedMemory();
+
+		//Creates a zeroed, writable mapping of a_size bytes. Returns false and fills a_error on failure.
+		bool Create(const std::string& a_name, size_t a_size, std::string& a_error);
+		//Maps an existing mapping read only. Fails if it is smaller than a_size.
+		bool Open(const std::string& a_name, size_t a_size, std::string& a_error);
+		void Close();
+
+		void* GetData() const { return data; }
+
+	private:
+		void* data{ nullptr };
+		size_t size{ 0 };
+		void* mappingHandle{ nullptr };
+		std::string ownedName;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "startupReport.h"
+
+namespace
+{
+	struct PhaseInfo
+	{
+		std::string_view name;
+		std::string_view unit;
+	};
+
+	constexpr std::array<PhaseInfo, static_cast<size_t>(Profiling::StartupPhase::kTotal)> phases{ {
+		{ "Hook install"sv, "hooks"sv },
+		{ "INI read"sv, "files"sv },
+		{ "Config file discovery"sv, "files"sv },
+		{ "JSON parse (worker time)"sv, "files"sv },
+		{ "Nearest marker cache"sv, "worldspaces"sv },
+		{ "Merchant cache"sv, "containers"sv },
+		{ "Compiled rule cache"sv, "rules"sv },
+		{ "Form resolution"sv, "form strings"sv },
+		{ "Rule registration"sv, "rules"sv },
+		{ "Optimize"sv, "rules"sv },
+		{ "PrettyPrint"sv, "rules"sv },
+		{ "Compile"sv, "rules"sv }
+	} };
+
+	//How many of the slowest files and worldspaces are called out.
+	constexpr size_t outlierCount = 5;
+}
+
+namespace Profiling
+{
+	void StartupReport::Add(StartupPhase a_phase, double a_milliseconds, size_t a_items)
+	{
+		std::scoped_lock guard{ lock };
+		auto& row = rows[static_cast<size_t>(a_phase)];
+		row.milliseconds += a_milliseconds;
+		row.items += a_items;
+		row.recorded = true;
+	}
+
+	void StartupReport::AddFile(std::string a_path, const FileTiming& a_timing)
+	{
+		Add(StartupPhase::kParse, a_timing.parse, 1);
+		if (a_timing.resolution > 0.0 || a_timing.registration > 0.0) {
+			Add(StartupPhase::kFormResolution, a_timing.resolution, 0);
+			Add(StartupPhase::kRegistration, a_timing.registration, a_timing.rules);
+		}
+		std::scoped_lock guard{ lock };
+		files.emplace_back(std::move(a_path), a_timing);
+	}
+
+	void StartupReport::AddWorldspaces(std::vector<WorldspaceTiming> a_worldspaces)
+	{
+		double total = 0.0;
+		for (const auto& worldspace : a_worldspaces) {
+			total += worldspace.milliseconds;
+		}
+		Add(StartupPhase::kMarkerCache, total, a_worldspaces.size());
+		std::scoped_lock guard{ lock };
+		worldspaces.insert(worldspaces.end(), std::make_move_iterator(a_worldspaces.begin()), std::make_move_iterator(a_worldspaces.end()));
+	}
+
+	void StartupReport::Log() const
+	{
+		std::scoped_lock guard{ lock };
+		logger::info("Startup phases:");
+		logger::info("  {:<28} {:>10}  {}", "Phase"sv, "Time"sv, "Items"sv);
+		double total = 0.0;
+		for (size_t phase = 0; phase < rows.size(); ++phase) {
+			const auto& row = rows[phase];
+			if (!row.recorded) {
+				continue;
+			}
+			logger::info("  {:<28} {:>7.1f} ms  {} {}", phases[phase].name, row.milliseconds, row.items, phases[phase].unit);
+			total += row.milliseconds;
+		}
+		//Worker phases overlap the main thread ones, so this is more than the wall time.
+		logger::info("  {:<28} {:>7.1f} ms", "Sum"sv, total);
+
+		if (!files.empty()) {
+			auto slowest = files;
+			const auto count = std::min(slowest.size(), outlierCount);
+			std::partial_sort(slowest.begin(), slowest.begin() + count, slowest.end(), [](const auto& a_left, const auto& a_right) { return a_left.second.Total() > a_right.second.Total(); });
+			logger::info("  Slowest {} of {} config files:", count, files.size());
+			for (size_t i = 0; i < count; ++i) {
+				const auto& [path, timing] = slowest[i];
+				logger::info("    {:>7.1f} ms  parse {:.1f}, resolve {:.1f}, register {:.1f}, {} rules  <{}>", timing.Total(), timing.parse, timing.resolution, timing.registration, timing.rules, path);
+			}
+		}
+
+		if (!worldspaces.empty()) {
+			auto slowest = worldspaces;
+			const auto count = std::min(slowest.size(), outlierCount);
+			std::partial_sort(slowest.begin(), slowest.begin() + count, slowest.end(), [](const WorldspaceTiming& a_left, const WorldspaceTiming& a_right) { return a_left.milliseconds > a_right.milliseconds; });
+			logger::info("  Slowest {} of {} worldspaces:", count, worldspaces.size());
+			for (size_t i = 0; i < count; ++i) {
+				logger::info("    {:>7.1f} ms  {} markers  {}", slowest[i].milliseconds, slowest[i].markers, slowest[i].name);
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "utilities/utilities.h"
+
+namespace Profiling
+{
+	//What CDF does between plugin load and the main menu, in the order it happens.
+	enum class StartupPhase : uint8_t
+	{
+		kHookInstall,
+		kINIRead,
+		kFileDiscovery,
+		kParse,
+		kMarkerCache,
+		kMerchantCache,
+		kRuleCache,
+		kFormResolution,
+		kRegistration,
+		kOptimize,
+		kPrettyPrint,
+		kCompile,
+
+		kTotal
+	};
+
+	//Collects startup timings and item counts from every phase, and logs them as one table once
+	//kDataLoaded work is done. Phases can run on worker threads.
+	class StartupReport : public Utilities::Singleton::ISingleton<StartupReport>
+	{
+	public:
+		struct FileTiming
+		{
+			double parse{ 0.0 };
+			double resolution{ 0.0 };
+			double registration{ 0.0 };
+			size_t rules{ 0 };
+
+			double Total() const { return parse + resolution + registration; }
+		};
+
+		struct WorldspaceTiming
+		{
+			std::string name;
+			double milliseconds{ 0.0 };
+			size_t markers{ 0 };
+		};
+
+		//Adds to the phase, a phase recorded more than once sums up.
+		void Add(StartupPhase a_phase, double a_milliseconds, size_t a_items);
+		//Also adds to kParse, kFormResolution and kRegistration.
+		void AddFile(std::string a_path, const FileTiming& a_timing);
+		//Also adds to kMarkerCache.
+		void AddWorldspaces(std::vector<WorldspaceTiming> a_worldspaces);
+		void Log() const;
+
+	private:
+		struct Row
+		{
+			double milliseconds{ 0.0 };
+			size_t items{ 0 };
+			bool recorded{ false };
+		};
+
+		mutable std::mutex lock;
+		std::array<Row, static_cast<size_t>(StartupPhase::kTotal)> rows;
+		std::vector<std::pair<std::string, FileTiming>> files;
+		std::vector<WorldspaceTiming> worldspaces;
+	};
+
+	//Adds the time until it goes out of scope to a startup phase.
+	class StartupTimer
+	{
+	public:
+		explicit StartupTimer(StartupPhase a_phase, size_t a_items = 0) :
+			phase(a_phase),
+			items(a_items),
+			start(std::chrono::steady_clock::now())
+		{}
+
+		~StartupTimer()
+		{
+			const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+			StartupReport::GetSingleton()->Add(phase, elapsed.count(), items);
+		}
+
+		void SetItems(size_t a_items) { items = a_items; }
+
+		StartupTimer(const StartupTimer&) = delete;
+		StartupTimer& operator=(const StartupTimer&) = delete;
+
+	private:
+		StartupPhase phase;
+		size_t items;
+		std::chrono::steady_clock::time_point start;
+	};
+}
\ No newline at end of file
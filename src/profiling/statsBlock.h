@@ -0,0 +1,128 @@
+#pragma once
+
+//Layout of the live statistics block the plugin publishes in shared memory (see Profiling::LiveStats),
+//read by devtools/statsViewer. Game independent. Every counter is a relaxed 64-bit atomic, so a reader
+//sees each value whole but not all of them from the same instant. Any change to the layout bumps
+//version.
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace Profiling::Stats
+{
+	inline constexpr uint32_t magic = 0x53464443;  //"CDFS"
+	inline constexpr uint32_t version = 1;
+#ifdef _WIN32
+	inline constexpr const char* mappingName = "Local\\ContainerDistributionFramework.Stats";
+#else
+	inline constexpr const char* mappingName = "/ContainerDistributionFramework.Stats";
+#endif
+
+	//Initialize, Reset.
+	inline constexpr size_t hookCount = 2;
+	//In Rules::RuleType order.
+	inline constexpr size_t ruleTypeCount = 5;
+	//In Profiling::LatencyPhase order.
+	inline constexpr size_t phaseCount = 8;
+	//Bucket i holds latencies in [2^i, 2^(i+1)) nanoseconds, the last one everything above.
+	inline constexpr size_t latencyBucketCount = 40;
+	//Rules past this index in the rule table aren't counted individually.
+	inline constexpr size_t trackedRuleCount = 4096;
+
+	inline constexpr const char* hookNames[hookCount] = { "Initialize", "Reset" };
+	inline constexpr const char* ruleTypeNames[ruleTypeCount] = { "add", "remove", "remove by keyword", "replace", "replace by keyword" };
+	inline constexpr const char* phaseNames[phaseCount] = { "Initialize", "Reset", "ProcessContainer", "Apply add", "Apply remove",
+		"Apply remove by keyword", "Apply replace", "Apply replace by keyword" };
+
+	using Counter = std::atomic<uint64_t>;
+	static_assert(Counter::is_always_lock_free, "shared counters must not need a lock");
+
+	constexpr size_t GetLatencyBucket(uint64_t a_nanoseconds)
+	{
+		return a_nanoseconds > 0 ? std::min<size_t>(std::bit_width(a_nanoseconds) - 1, latencyBucketCount - 1) : 0;
+	}
+
+	struct Block
+	{
+		//Written by Publish, magic last, so a reader that sees magic sees the rest of the header.
+		std::atomic<uint32_t> magic;
+		uint32_t version;
+		uint32_t size;
+		uint32_t processID;
+
+		//Bumped when the rules are recompiled, per-rule counts restart then.
+		Counter generation;
+		Counter ruleCount;
+
+		Counter hookCalls[hookCount];
+		//Containers that went through the rules, and how many are being processed right now. There is no
+		//queue, hooks run rules inline on whichever thread initializes the container.
+		Counter processed;
+		Counter inFlight;
+		Counter maxInFlight;
+
+		Counter prefilterPassed;
+		Counter prefilterRejected;
+		Counter candidateHits;
+		Counter candidateMisses;
+		Counter merchantLookups;
+		Counter merchantHits;
+
+		Counter ruleVisits[ruleTypeCount];
+		Counter ruleApplications[ruleTypeCount];
+		Counter latency[phaseCount][latencyBucketCount];
+		Counter ruleHits[trackedRuleCount];
+
+		//Call on zeroed memory.
+		void Publish(uint32_t a_processID)
+		{
+			version = Stats::version;
+			size = sizeof(Block);
+			processID = a_processID;
+			magic.store(Stats::magic, std::memory_order_release);
+		}
+
+		bool IsValid() const
+		{
+			return magic.load(std::memory_order_acquire) == Stats::magic && version == Stats::version && size == sizeof(Block);
+		}
+
+		void ResetRules(size_t a_ruleCount)
+		{
+			for (auto& hits : ruleHits) {
+				hits.store(0, std::memory_order_relaxed);
+			}
+			ruleCount.store(a_ruleCount, std::memory_order_relaxed);
+			generation.fetch_add(1, std::memory_order_release);
+		}
+
+		void BeginProcessing()
+		{
+			const auto current = inFlight.fetch_add(1, std::memory_order_relaxed) + 1;
+			auto highest = maxInFlight.load(std::memory_order_relaxed);
+			while (current > highest && !maxInFlight.compare_exchange_weak(highest, current, std::memory_order_relaxed)) {}
+		}
+
+		void EndProcessing()
+		{
+			inFlight.fetch_sub(1, std::memory_order_relaxed);
+			processed.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		void RuleApplied(size_t a_rule, size_t a_type)
+		{
+			ruleApplications[a_type].fetch_add(1, std::memory_order_relaxed);
+			if (a_rule < trackedRuleCount) {
+				ruleHits[a_rule].fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		void RecordLatency(size_t a_phase, uint64_t a_nanoseconds)
+		{
+			latency[a_phase][GetLatencyBucket(a_nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+		}
+	};
+}
\ No newline at end of file
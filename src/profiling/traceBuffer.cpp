@@ -0,0 +1,193 @@
+#include "traceBuffer.h"
+
+#include "rules/ruleTable.h"
+
+namespace
+{
+	std::string_view GetEventName(Profiling::TraceEvent a_event)
+	{
+		switch (a_event) {
+		case Profiling::TraceEvent::kInitialize:
+			return "Initialize"sv;
+		case Profiling::TraceEvent::kReset:
+			return "Reset"sv;
+		case Profiling::TraceEvent::kProcessContainer:
+			return "ProcessContainer"sv;
+		case Profiling::TraceEvent::kApplyRule:
+			return "Apply"sv;
+		case Profiling::TraceEvent::kLeveledList:
+			return "Resolve leveled list"sv;
+		case Profiling::TraceEvent::kMarkerLookup:
+			return "Nearest marker lookup"sv;
+		default:
+			return "Unknown"sv;
+		}
+	}
+
+	std::string EscapeJSON(std::string_view a_text)
+	{
+		std::string result{};
+		result.reserve(a_text.size());
+		for (const auto character : a_text) {
+			switch (character) {
+			case '"':
+				result += "\\\"";
+				break;
+			case '\\':
+				result += "\\\\";
+				break;
+			default:
+				if (static_cast<unsigned char>(character) < 0x20) {
+					result += fmt::format("\\u{:04x}", static_cast<unsigned char>(character));
+				}
+				else {
+					result += character;
+				}
+				break;
+			}
+		}
+		return result;
+	}
+
+	//Small per-thread numbers read better in a trace viewer than OS thread IDs.
+	uint16_t GetThreadNumber()
+	{
+		static std::atomic<uint16_t> nextThread{ 1 };
+		thread_local const uint16_t thread = nextThread.fetch_add(1, std::memory_order_relaxed);
+		return thread;
+	}
+}
+
+namespace Profiling
+{
+	void TraceBuffer::SetEnabled(bool a_enabled)
+	{
+		if (a_enabled && !slots) {
+			slots = std::make_unique<Slot[]>(capacity);
+		}
+		enabled.store(a_enabled, std::memory_order_release);
+	}
+
+	uint32_t TraceBuffer::RegisterLabel(const std::string& a_label)
+	{
+		const std::lock_guard lock{ labelLock };
+		const auto [it, inserted] = labelIndex.try_emplace(a_label, static_cast<uint32_t>(labels.size()));
+		if (inserted) {
+			labels.push_back(a_label);
+		}
+		return it->second;
+	}
+
+	void TraceBuffer::Record(TraceEvent a_event, Clock::time_point a_start, RE::FormID a_container, uint32_t a_label, uint8_t a_detail)
+	{
+		const auto end = Clock::now();
+		const auto index = head.fetch_add(1, std::memory_order_relaxed);
+		auto& slot = slots[index & (capacity - 1)];
+
+		//Sequence 0 marks the slot as being written until the event is complete.
+		slot.sequence.store(0, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		slot.start.store(std::chrono::duration_cast<std::chrono::nanoseconds>(a_start.time_since_epoch()).count(), std::memory_order_relaxed);
+		slot.duration.store(std::chrono::duration_cast<std::chrono::nanoseconds>(end - a_start).count(), std::memory_order_relaxed);
+		slot.container.store(a_container, std::memory_order_relaxed);
+		slot.label.store(a_label, std::memory_order_relaxed);
+		slot.thread.store(GetThreadNumber(), std::memory_order_relaxed);
+		slot.event.store(static_cast<uint8_t>(a_event), std::memory_order_relaxed);
+		slot.detail.store(a_detail, std::memory_order_relaxed);
+		slot.sequence.store(index + 1, std::memory_order_release);
+	}
+
+	std::filesystem::path TraceBuffer::GetPath()
+	{
+		auto path = logger::log_directory();
+		if (!path) {
+			return {};
+		}
+		*path /= fmt::format("{}.trace.json"sv, Plugin::NAME);
+		return *path;
+	}
+
+	size_t TraceBuffer::Flush(const std::filesystem::path& a_path, std::string& a_error)
+	{
+		if (!slots) {
+			a_error = "tracing was never enabled";
+			return 0;
+		}
+
+		std::ofstream file{ a_path, std::ios::binary | std::ios::trunc };
+		if (!file) {
+			a_error = fmt::format("could not open {}", a_path.string());
+			return 0;
+		}
+
+		//Labels are copied first, events recorded meanwhile only refer to labels that already exist.
+		std::vector<std::string> labelNames{};
+		{
+			const std::lock_guard lock{ labelLock };
+			labelNames.reserve(labels.size());
+			for (const auto& label : labels) {
+				labelNames.push_back(EscapeJSON(label));
+			}
+		}
+
+		file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		const auto end = head.load(std::memory_order_acquire);
+		const auto begin = end > capacity ? end - capacity : 0;
+		size_t written = 0;
+		for (auto index = begin; index < end; ++index) {
+			const auto& slot = slots[index & (capacity - 1)];
+			if (slot.sequence.load(std::memory_order_acquire) != index + 1) {
+				continue;
+			}
+			const auto start = slot.start.load(std::memory_order_relaxed);
+			const auto duration = slot.duration.load(std::memory_order_relaxed);
+			const auto container = slot.container.load(std::memory_order_relaxed);
+			const auto label = slot.label.load(std::memory_order_relaxed);
+			const auto thread = slot.thread.load(std::memory_order_relaxed);
+			const auto event = static_cast<TraceEvent>(slot.event.load(std::memory_order_relaxed));
+			const auto detail = slot.detail.load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (slot.sequence.load(std::memory_order_relaxed) != index + 1) {
+				continue;
+			}
+
+			std::string name{ GetEventName(event) };
+			if (event == TraceEvent::kApplyRule) {
+				name += fmt::format(" {}", Rules::GetRuleTypeName(static_cast<Rules::RuleType>(detail)));
+			}
+			std::string args = fmt::format("\"container\":\"{:08X}\"", container);
+			if (label < labelNames.size()) {
+				args += fmt::format(",\"rule\":\"{}\"", labelNames[label]);
+			}
+			//Timestamps are steady clock microseconds, the same clock frame captures on Windows use.
+			file << fmt::format("{}{{\"name\":\"{}\",\"cat\":\"cdf\",\"ph\":\"X\",\"ts\":{:.3f},\"dur\":{:.3f},\"pid\":1,\"tid\":{},\"args\":{{{}}}}}",
+				written ? ",\n" : "", name, start / 1000.0, duration / 1000.0, thread, args);
+			++written;
+		}
+		file << "\n]}\n";
+		if (!file) {
+			a_error = fmt::format("failed to write {}", a_path.string());
+			return 0;
+		}
+		return written;
+	}
+
+	std::string TraceBuffer::FlushToLog()
+	{
+		const auto path = GetPath();
+		std::string error{};
+		const auto count = path.empty() ? 0 : Flush(path, error);
+		if (path.empty()) {
+			error = "no log directory";
+		}
+		std::string message{};
+		if (count > 0) {
+			message = fmt::format("Wrote {} trace events to {}", count, path.string());
+		}
+		else {
+			message = fmt::format("Trace flush failed: {}", error.empty() ? "no events recorded" : error);
+		}
+		logger::info("{}", message);
+		return message;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "utilities/utilities.h"
+
+namespace Profiling
+{
+	enum class TraceEvent : uint8_t
+	{
+		kInitialize,
+		kReset,
+		kProcessContainer,
+		kApplyRule,
+		kLeveledList,
+		kMarkerLookup
+	};
+
+	//Fixed size ring of the latest distribution events, written to Chrome trace-event JSON on request.
+	//Recording is off until enabled from the INI or the console. Writers claim a slot with one atomic
+	//increment and publish it through the slot's sequence number, so hooks on any thread never wait
+	//and a flush skips slots that are being overwritten.
+	class TraceBuffer : public Utilities::Singleton::ISingleton<TraceBuffer>
+	{
+	public:
+		static constexpr size_t capacity = 1 << 16;
+		static constexpr uint32_t noLabel = std::numeric_limits<uint32_t>::max();
+
+		using Clock = std::chrono::steady_clock;
+
+		void SetEnabled(bool a_enabled);
+		bool IsEnabled() const { return enabled.load(std::memory_order_acquire); }
+
+		//Rule labels are interned once per compile, events only carry the index. Never shrinks, so
+		//labels outlive the snapshot that registered them.
+		uint32_t RegisterLabel(const std::string& a_label);
+
+		//a_detail is the rule type for kApplyRule.
+		void Record(TraceEvent a_event, Clock::time_point a_start, RE::FormID a_container, uint32_t a_label = noLabel, uint8_t a_detail = 0);
+
+		static std::filesystem::path GetPath();
+		//Writes the buffered events, oldest first. Returns the number written, a_error is set on failure.
+		size_t Flush(const std::filesystem::path& a_path, std::string& a_error);
+		//Flushes to GetPath and logs the outcome, which is also returned for the console.
+		std::string FlushToLog();
+
+	private:
+		struct Slot {
+			std::atomic<uint64_t> sequence{ 0 };
+			std::atomic<int64_t> start{ 0 };
+			std::atomic<int64_t> duration{ 0 };
+			std::atomic<uint32_t> container{ 0 };
+			std::atomic<uint32_t> label{ noLabel };
+			std::atomic<uint16_t> thread{ 0 };
+			std::atomic<uint8_t> event{ 0 };
+			std::atomic<uint8_t> detail{ 0 };
+		};
+
+		std::atomic<bool> enabled{ false };
+		std::atomic<uint64_t> head{ 0 };
+		std::unique_ptr<Slot[]> slots;
+
+		std::mutex labelLock;
+		std::vector<std::string> labels;
+		std::unordered_map<std::string, uint32_t> labelIndex;
+	};
+
+	//Records one event covering its own lifetime, if tracing was on when it started.
+	class TraceScope
+	{
+	public:
+		TraceScope(TraceEvent a_event, RE::FormID a_container, uint32_t a_label = TraceBuffer::noLabel, uint8_t a_detail = 0) :
+			buffer(TraceBuffer::GetSingleton()),
+			active(buffer->IsEnabled()),
+			event(a_event),
+			detail(a_detail),
+			container(a_container),
+			label(a_label)
+		{
+			if (active) {
+				start = TraceBuffer::Clock::now();
+			}
+		}
+
+		~TraceScope()
+		{
+			if (active) {
+				buffer->Record(event, start, container, label, detail);
+			}
+		}
+
+		TraceScope(const TraceScope&) = delete;
+		TraceScope& operator=(const TraceScope&) = delete;
+
+	private:
+		TraceBuffer* buffer;
+		bool active;
+		TraceEvent event;
+		uint8_t detail;
+		RE::FormID container;
+		uint32_t label;
+		TraceBuffer::Clock::time_point start{};
+	};
+}
\ No newline at end of file
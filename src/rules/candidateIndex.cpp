@@ -0,0 +1,199 @@
+#include "candidateIndex.h"
+
+namespace
+{
+	bool IsRespawning(RE::TESObjectCONT* a_base)
+	{
+		if (a_base->data.flags & RE::CONT_DATA::Flag::kRespawn) {
+			return true;
+		}
+		return false;
+	}
+
+	//Adds the form and, for leveled lists, everything the list can ever resolve to.
+	void CollectReachable(RE::TESForm* a_form, std::unordered_set<RE::TESForm*>& a_result)
+	{
+		if (!a_form || !a_result.insert(a_form).second) {
+			return;
+		}
+
+		if (const auto leveledList = a_form->As<RE::TESLeveledList>()) {
+			for (auto& entry : leveledList->entries) {
+				CollectReachable(entry.form, a_result);
+			}
+		}
+	}
+
+	void CollectContents(RE::TESObjectCONT* a_base, std::unordered_set<RE::TESForm*>& a_result)
+	{
+		for (uint32_t i = 0; i < a_base->numContainerObjects; ++i) {
+			const auto entry = a_base->containerObjects[i];
+			if (entry) {
+				CollectReachable(entry->obj, a_result);
+			}
+		}
+	}
+}
+
+namespace Rules
+{
+	bool CandidateIndex::IsPrunable(const RuleTable& a_table, uint32_t a_rule)
+	{
+		const auto type = a_table.types[a_rule];
+		return (type == RuleType::kRemove || type == RuleType::kReplace) && !a_table.HasFlag(a_rule, RuleFlag::kAllowSafeBypass);
+	}
+
+	void CandidateIndex::Build(const RuleTable& a_table, const Conditions::ConditionList& a_conditions)
+	{
+		const auto then = std::chrono::steady_clock::now();
+		Clear();
+
+		auto* dataHandler = RE::TESDataHandler::GetSingleton();
+		if (!dataHandler) {
+			return;
+		}
+
+		//Rules without static conditions are the same for every base container, apart from the respawn
+		//flag: a container that never respawns is always safe.
+		//Removes and replaces that may not run on safe containers only ever see a respawning container
+		//right after it was reset to its base contents, plus whatever rules add before them. Those are
+		//checked per container for whether their form can be there.
+		std::vector<uint32_t> specificRules{};
+		std::vector<uint32_t> prunableRules{};
+		std::array<std::vector<uint32_t>, 2> genericRules{};
+		for (uint32_t rule = 0; rule < a_table.size(); ++rule) {
+			if (!a_table.GetStaticConditions(rule).empty()) {
+				specificRules.push_back(rule);
+				continue;
+			}
+			if (IsPrunable(a_table, rule)) {
+				prunableRules.push_back(rule);
+				continue;
+			}
+			genericRules[1].push_back(rule);
+			if (a_table.HasFlag(rule, RuleFlag::kAllowSafeBypass)) {
+				genericRules[0].push_back(rule);
+			}
+		}
+
+		//Everything a rule can put into a container, leveled lists flattened.
+		std::vector<std::unordered_set<RE::TESForm*>> addedForms(a_table.size());
+		std::unordered_set<RE::TESForm*> genericAddedForms{};
+		for (uint32_t rule = 0; rule < a_table.size(); ++rule) {
+			for (const auto form : a_table.GetForms(rule)) {
+				CollectReachable(form, addedForms[rule]);
+			}
+			if (a_table.GetStaticConditions(rule).empty()) {
+				genericAddedForms.insert(addedForms[rule].begin(), addedForms[rule].end());
+			}
+		}
+
+		std::vector<RE::TESObjectCONT*> containers{};
+		for (auto* container : dataHandler->GetFormArray<RE::TESObjectCONT>()) {
+			if (container) {
+				containers.push_back(container);
+			}
+		}
+
+		std::vector<std::vector<uint32_t>> matches(containers.size());
+		std::vector<size_t> prunedCounts(containers.size());
+		std::for_each(std::execution::par, containers.begin(), containers.end(), [&](RE::TESObjectCONT*& a_base) {
+			const auto index = static_cast<size_t>(&a_base - containers.data());
+			const bool respawns = IsRespawning(a_base);
+			auto& result = matches[index];
+			for (const auto rule : specificRules) {
+				if (!respawns && !a_table.HasFlag(rule, RuleFlag::kAllowSafeBypass)) {
+					continue;
+				}
+
+				const auto staticConditions = a_table.GetStaticConditions(rule);
+				const bool passes = std::all_of(staticConditions.begin(), staticConditions.end(), [&](uint32_t a_condition) {
+					return a_conditions[a_condition]->IsValidForBase(a_base);
+					});
+				if (passes) {
+					result.push_back(rule);
+				}
+			}
+			if (!respawns) {
+				return;
+			}
+
+			std::unordered_set<RE::TESForm*> reachable{};
+			CollectContents(a_base, reachable);
+			for (const auto rule : result) {
+				reachable.insert(addedForms[rule].begin(), addedForms[rule].end());
+			}
+			auto canReach = [&](RE::TESForm* a_form) {
+				return reachable.contains(a_form) || genericAddedForms.contains(a_form);
+			};
+
+			auto unreachable = [&](uint32_t a_rule) {
+				return IsPrunable(a_table, a_rule) && !canReach(a_table.targets[a_rule]);
+			};
+			if (pruneUnreachable) {
+				prunedCounts[index] = std::erase_if(result, unreachable);
+			}
+			else {
+				prunedCounts[index] = static_cast<size_t>(std::count_if(result.begin(), result.end(), unreachable));
+			}
+
+			for (const auto rule : prunableRules) {
+				const bool reachable = canReach(a_table.targets[rule]);
+				if (reachable || !pruneUnreachable) {
+					result.push_back(rule);
+				}
+				if (!reachable) {
+					++prunedCounts[index];
+				}
+			}
+			std::sort(result.begin(), result.end());
+			});
+
+		//Most containers share a list, intern them by (respawn flag, container specific matches).
+		std::map<std::pair<bool, std::vector<uint32_t>>, Span> interned{};
+		size_t totalCandidates = 0;
+		size_t totalPruned = 0;
+		for (size_t index = 0; index < containers.size(); ++index) {
+			auto* base = containers[index];
+			const bool respawns = IsRespawning(base);
+			auto key = std::make_pair(respawns, std::move(matches[index]));
+
+			auto it = interned.find(key);
+			if (it == interned.end()) {
+				const auto& generic = genericRules[respawns ? 1 : 0];
+				Span span{ static_cast<uint32_t>(arena.size()), static_cast<uint32_t>(generic.size() + key.second.size()) };
+				std::merge(generic.begin(), generic.end(), key.second.begin(), key.second.end(), std::back_inserter(arena));
+				it = interned.emplace(std::move(key), span).first;
+			}
+			lists.emplace(base, it->second);
+			totalCandidates += it->second.size;
+			totalPruned += prunedCounts[index];
+		}
+
+		const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - then);
+		logger::info("Candidate index: {} base containers, {} distinct rule lists, {:.1f} of {} rules per container on average, built in {}us.",
+			containers.size(), interned.size(), containers.empty() ? 0.0 : static_cast<double>(totalCandidates) / containers.size(), a_table.size(), elapsed.count());
+		if (pruneUnreachable) {
+			logger::info("Reachability: pruned {} rule/container pairs where the removed form can't be in the container.", totalPruned);
+		}
+		else {
+			logger::info("Reachability: {} rule/container pairs remove a form that can't be in the container as loaded. Kept, bPruneUnreachableRules would drop them.", totalPruned);
+		}
+	}
+
+	void CandidateIndex::Clear()
+	{
+		lists.clear();
+		arena.clear();
+	}
+
+	bool CandidateIndex::Find(RE::TESObjectCONT* a_base, std::span<const uint32_t>& a_candidates) const
+	{
+		const auto it = lists.find(a_base);
+		if (it == lists.end()) {
+			return false;
+		}
+		a_candidates = std::span<const uint32_t>(arena.data() + it->second.offset, it->second.size);
+		return true;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "conditions/condition.h"
+#include "rules/ruleTable.h"
+
+namespace Rules
+{
+	//For every base container in the data handler, the rules that pass all of their static checks:
+	//container conditions and the respawn half of the safe container check. Plugin requirements are
+	//already resolved when the config is read. Removes and replaces whose form can never be in the
+	//container are counted, and left out only with pruning on. Identical lists are stored once.
+	class CandidateIndex
+	{
+	public:
+		//Read from [General] bPruneUnreachableRules in the INI, off by default. Reachability is only known
+		//for the leveled lists as they are at compile time, items injected later by other plugins or
+		//scripts would never be removed from a pruned container.
+		static void SetPruneUnreachable(bool a_enabled) { pruneUnreachable = a_enabled; }
+
+		void Build(const RuleTable& a_table, const Conditions::ConditionList& a_conditions);
+		void Clear();
+		size_t GetMemoryUsage() const { return Utilities::Memory::GetHashMapMemoryUsage(lists) + arena.capacity() * sizeof(uint32_t); }
+
+		//Returns false for base containers that were not present at load, those need the full table.
+		bool Find(RE::TESObjectCONT* a_base, std::span<const uint32_t>& a_candidates) const;
+
+	private:
+		static bool IsPrunable(const RuleTable& a_table, uint32_t a_rule);
+
+		static inline bool pruneUnreachable{ false };
+
+		std::unordered_map<RE::TESObjectCONT*, Span> lists;
+		std::vector<uint32_t> arena;
+	};
+}
\ No newline at end of file
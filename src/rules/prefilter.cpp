@@ -0,0 +1,186 @@
+#include "prefilter.h"
+
+#include "conditions/containerCondition.h"
+#include "conditions/worldspaceCondition.h"
+
+namespace
+{
+	uint64_t Mix(uint64_t a_value)
+	{
+		a_value += 0x9E3779B97F4A7C15ull;
+		a_value = (a_value ^ (a_value >> 30)) * 0xBF58476D1CE4E5B9ull;
+		a_value = (a_value ^ (a_value >> 27)) * 0x94D049BB133111EBull;
+		return a_value ^ (a_value >> 31);
+	}
+}
+
+namespace Rules
+{
+	void BloomFilter::Reset(size_t a_expectedEntries)
+	{
+		//~16 bits per entry keeps false positives well under 1% with 3 hashes.
+		size_t bits = 64;
+		while (bits < a_expectedEntries * 16) {
+			bits <<= 1;
+		}
+		words.assign(bits / 64, 0);
+		bitMask = bits - 1;
+	}
+
+	void BloomFilter::Insert(RE::FormID a_id)
+	{
+		const auto hash = Mix(a_id);
+		const auto h1 = hash & 0xFFFFFFFF;
+		const auto h2 = (hash >> 32) | 1;
+		for (size_t i = 0; i < kHashes; ++i) {
+			const auto bit = (h1 + i * h2) & bitMask;
+			words[bit >> 6] |= 1ull << (bit & 63);
+		}
+	}
+
+	bool BloomFilter::MayContain(RE::FormID a_id) const
+	{
+		if (words.empty()) {
+			return false;
+		}
+
+		const auto hash = Mix(a_id);
+		const auto h1 = hash & 0xFFFFFFFF;
+		const auto h2 = (hash >> 32) | 1;
+		for (size_t i = 0; i < kHashes; ++i) {
+			const auto bit = (h1 + i * h2) & bitMask;
+			if (!(words[bit >> 6] & (1ull << (bit & 63)))) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void Prefilter::Build(const RuleTable& a_table, const Conditions::ConditionList& a_conditions)
+	{
+		std::array<std::vector<RE::FormID>, 4> containerIDs{};
+		std::array<std::vector<RE::FormID>, 4> worldspaceIDs{};
+		classes = {};
+
+		for (size_t rule = 0; rule < a_table.size(); ++rule) {
+			//A rule only narrows the filter through conditions that must hold. Inverted lists
+			//can't rule anything out up front.
+			const std::vector<RE::TESObjectCONT*>* ruleContainers = nullptr;
+			const std::vector<RE::TESWorldSpace*>* ruleWorldspaces = nullptr;
+			for (const auto condition : a_table.GetConditions(rule)) {
+				auto* stored = a_conditions[condition].get();
+				if (stored->inverted) {
+					continue;
+				}
+
+				if (stored->GetType() == Conditions::ConditionType::kContainer) {
+					ruleContainers = &static_cast<Conditions::ContainerCondition*>(stored)->GetContainers();
+				}
+				else if (stored->GetType() == Conditions::ConditionType::kWorldspace) {
+					ruleWorldspaces = &static_cast<Conditions::WorldspaceCondition*>(stored)->GetWorldspaces();
+				}
+			}
+
+			for (size_t index = 0; index < classes.size(); ++index) {
+				const bool isMerchant = index & 1;
+				const bool isSafe = index & 2;
+				if (isMerchant && !a_table.HasFlag(rule, RuleFlag::kAllowVendors)) {
+					continue;
+				}
+				if (!isMerchant && a_table.HasFlag(rule, RuleFlag::kOnlyVendors)) {
+					continue;
+				}
+				if (isSafe && !a_table.HasFlag(rule, RuleFlag::kAllowSafeBypass)) {
+					continue;
+				}
+
+				auto& filter = classes[index];
+				filter.active = true;
+				if (ruleContainers) {
+					for (const auto container : *ruleContainers) {
+						containerIDs[index].push_back(container->formID);
+					}
+				}
+				else {
+					filter.anyContainer = true;
+				}
+
+				if (ruleWorldspaces) {
+					for (const auto worldspace : *ruleWorldspaces) {
+						worldspaceIDs[index].push_back(worldspace->formID);
+					}
+				}
+				else {
+					filter.anyWorldspace = true;
+				}
+			}
+		}
+
+		for (size_t index = 0; index < classes.size(); ++index) {
+			auto& filter = classes[index];
+			filter.containers.Reset(filter.anyContainer ? 0 : containerIDs[index].size());
+			filter.worldspaces.Reset(filter.anyWorldspace ? 0 : worldspaceIDs[index].size());
+			if (!filter.anyContainer) {
+				for (const auto id : containerIDs[index]) {
+					filter.containers.Insert(id);
+				}
+			}
+			if (!filter.anyWorldspace) {
+				for (const auto id : worldspaceIDs[index]) {
+					filter.worldspaces.Insert(id);
+				}
+			}
+		}
+
+		const auto activeClasses = std::ranges::count_if(classes, [](const ClassFilter& a_filter) { return a_filter.active; });
+		logger::info("Prefilter: rules can reach {} of {} vendor/safe container classes.", activeClasses, classes.size());
+	}
+
+	bool Prefilter::MayApply(RE::TESObjectREFR* a_container, bool a_isMerchant, bool a_isSafe)
+	{
+		const bool result = Test(a_container, a_isMerchant, a_isSafe);
+		if (result) {
+			passed.fetch_add(1, std::memory_order_relaxed);
+		}
+		else {
+			rejected.fetch_add(1, std::memory_order_relaxed);
+		}
+		return result;
+	}
+
+	bool Prefilter::Test(RE::TESObjectREFR* a_container, bool a_isMerchant, bool a_isSafe) const
+	{
+		const auto& filter = classes[GetClass(a_isMerchant, a_isSafe)];
+		bool result = filter.active;
+		if (result && !filter.anyContainer) {
+			const auto base = a_container->GetBaseObject();
+			result = base && filter.containers.MayContain(base->formID);
+		}
+		if (result && !filter.anyWorldspace) {
+			//Worldspace conditions also accept parent worldspaces.
+			result = false;
+			for (auto worldspace = a_container->GetWorldspace(); !result && worldspace; worldspace = worldspace->parentWorld) {
+				result = filter.worldspaces.MayContain(worldspace->formID);
+			}
+		}
+		return result;
+	}
+
+	size_t Prefilter::GetMemoryUsage() const
+	{
+		size_t bytes = sizeof(*this);
+		for (const auto& filter : classes) {
+			bytes += (filter.containers.GetBitCount() + filter.worldspaces.GetBitCount()) / 8;
+		}
+		return bytes;
+	}
+
+	void Prefilter::LogStatistics()
+	{
+		const auto skipped = rejected.load(std::memory_order_relaxed);
+		const auto processed = passed.load(std::memory_order_relaxed);
+		const auto total = skipped + processed;
+		logger::info("Prefilter: {} of {} containers skipped ({:.1f}%), {} went through the rules.",
+			skipped, total, total ? 100.0 * skipped / total : 0.0, processed);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "conditions/condition.h"
+#include "rules/ruleTable.h"
+
+namespace Rules
+{
+	class BloomFilter
+	{
+	public:
+		void Reset(size_t a_expectedEntries);
+		void Insert(RE::FormID a_id);
+		bool MayContain(RE::FormID a_id) const;
+		size_t GetBitCount() const { return words.size() * 64; }
+
+	private:
+		static constexpr size_t kHashes = 3;
+
+		std::vector<uint64_t> words;
+		uint64_t bitMask{ 0 };
+	};
+
+	//Built from the compiled rule table. Answers "can any rule possibly touch this container?" from
+	//the base container, the worldspace and the vendor/safe class, without looking at a single rule.
+	class Prefilter
+	{
+	public:
+		void Build(const RuleTable& a_table, const Conditions::ConditionList& a_conditions);
+		bool MayApply(RE::TESObjectREFR* a_container, bool a_isMerchant, bool a_isSafe);
+		//MayApply without counting, for dry runs.
+		bool Test(RE::TESObjectREFR* a_container, bool a_isMerchant, bool a_isSafe) const;
+		void LogStatistics();
+		size_t GetMemoryUsage() const;
+
+	private:
+		struct ClassFilter
+		{
+			bool active{ false };
+			bool anyContainer{ false };
+			bool anyWorldspace{ false };
+			BloomFilter containers;
+			BloomFilter worldspaces;
+		};
+
+		static size_t GetClass(bool a_isMerchant, bool a_isSafe) { return (a_isMerchant ? 1 : 0) | (a_isSafe ? 2 : 0); }
+
+		std::array<ClassFilter, 4> classes;
+		std::atomic<uint64_t> rejected{ 0 };
+		std::atomic<uint64_t> passed{ 0 };
+	};
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "ruleTable.h"
+
+namespace Rules
+{
+	std::string_view GetRuleTypeName(RuleType a_type)
+	{
+		switch (a_type) {
+		case RuleType::kAdd:
+			return "add"sv;
+		case RuleType::kRemove:
+			return "remove"sv;
+		case RuleType::kRemoveKeyword:
+			return "remove by keyword"sv;
+		case RuleType::kReplace:
+			return "replace"sv;
+		case RuleType::kReplaceKeyword:
+			return "replace by keyword"sv;
+		default:
+			return "unknown"sv;
+		}
+	}
+
+	void RuleTable::Build(const std::vector<RuleData>& a_rules, const RuleLists& a_lists, const Conditions::ConditionList& a_conditions)
+	{
+		Clear();
+
+		//Stable sort keeps config order within each rule type.
+		std::vector<const RuleData*> sorted{};
+		sorted.reserve(a_rules.size());
+		for (const auto& rule : a_rules) {
+			sorted.push_back(&rule);
+		}
+		std::stable_sort(sorted.begin(), sorted.end(), [](const RuleData* a_lhs, const RuleData* a_rhs) {
+			return a_lhs->type < a_rhs->type;
+			});
+
+		types.reserve(sorted.size());
+		flags.reserve(sorted.size());
+		counts.reserve(sorted.size());
+		targets.reserve(sorted.size());
+		conditions.reserve(sorted.size());
+		forms.reserve(sorted.size());
+		keywords.reserve(sorted.size());
+		sources.reserve(sorted.size());
+
+		//Interned lists are equal exactly when their spans are, so each one is copied once.
+		auto key = [](Span a_span) { return static_cast<uint64_t>(a_span.offset) << 32 | a_span.size; };
+		std::unordered_map<uint64_t, ConditionSpan> copiedConditions{};
+		std::unordered_map<uint64_t, Span> copiedForms{};
+		std::unordered_map<uint64_t, Span> copiedKeywords{};
+
+		for (const auto* rule : sorted) {
+			types.push_back(rule->type);
+			flags.push_back(rule->flags);
+			counts.push_back(rule->count);
+			targets.push_back(rule->target);
+
+			auto [condition, newConditions] = copiedConditions.try_emplace(key(rule->conditions));
+			if (newConditions) {
+				//Static conditions go first, so the dynamic ones are a suffix of the same span.
+				const auto offset = conditionArena.size();
+				const auto list = a_lists.conditions.Get(rule->conditions);
+				conditionArena.insert(conditionArena.end(), list.begin(), list.end());
+				const auto firstDynamic = std::stable_partition(conditionArena.begin() + offset, conditionArena.end(), [&](uint32_t a_condition) {
+					return a_conditions[a_condition]->IsStatic();
+					});
+				condition->second = { static_cast<uint32_t>(offset), static_cast<uint16_t>(list.size()),
+					static_cast<uint16_t>(std::distance(conditionArena.begin() + offset, firstDynamic)) };
+			}
+			conditions.push_back(condition->second);
+
+			auto [form, newForms] = copiedForms.try_emplace(key(rule->forms));
+			if (newForms) {
+				form->second = Append(formArena, a_lists.forms.Get(rule->forms));
+			}
+			forms.push_back(form->second);
+
+			auto [keyword, newKeywords] = copiedKeywords.try_emplace(key(rule->keywords));
+			if (newKeywords) {
+				keyword->second = Append(keywordArena, a_lists.keywords.Get(rule->keywords));
+			}
+			keywords.push_back(keyword->second);
+
+			sources.push_back(rule->source);
+			allRules.push_back(static_cast<uint32_t>(allRules.size()));
+		}
+	}
+
+	size_t RuleTable::GetMemoryUsage() const
+	{
+		return types.capacity() * sizeof(RuleType) + flags.capacity() * sizeof(uint8_t) + counts.capacity() * sizeof(uint32_t) +
+			targets.capacity() * sizeof(RE::TESBoundObject*) + conditions.capacity() * sizeof(ConditionSpan) + forms.capacity() * sizeof(Span) +
+			keywords.capacity() * sizeof(Span) + sources.capacity() * sizeof(uint32_t) + allRules.capacity() * sizeof(uint32_t) +
+			conditionArena.capacity() * sizeof(uint32_t) + formArena.capacity() * sizeof(RE::TESBoundObject*) + keywordArena.capacity() * sizeof(RE::BGSKeyword*);
+	}
+
+	void RuleTable::Clear()
+	{
+		types.clear();
+		flags.clear();
+		counts.clear();
+		targets.clear();
+		conditions.clear();
+		forms.clear();
+		keywords.clear();
+		sources.clear();
+		allRules.clear();
+		conditionArena.clear();
+		formArena.clear();
+		keywordArena.clear();
+	}
+}
\ No newline at end of file
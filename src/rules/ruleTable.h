@@ -0,0 +1,166 @@
+#pragma once
+
+#include "conditions/condition.h"
+#include "utilities/utilities.h"
+
+namespace Rules
+{
+	//Order matters: rules are processed grouped by type, in this order.
+	enum class RuleType : uint8_t
+	{
+		kAdd,
+		kRemove,
+		kRemoveKeyword,
+		kReplace,
+		kReplaceKeyword,
+
+		kTotal
+	};
+
+	namespace RuleFlag
+	{
+		enum : uint8_t
+		{
+			kNone = 0,
+			kAllowVendors = 1 << 0,
+			kOnlyVendors = 1 << 1,
+			kAllowSafeBypass = 1 << 2,
+			kRandomAdd = 1 << 3
+		};
+	}
+
+	std::string_view GetRuleTypeName(RuleType a_type);
+
+	struct Span
+	{
+		uint32_t offset;
+		uint32_t size;
+
+		bool operator==(const Span&) const = default;
+	};
+
+	//Append-only list storage. Identical lists are stored once, so two interned lists are equal exactly
+	//when their spans are. Interning can move the values, spans stay valid but spans of Get don't.
+	template <class T>
+	class ListArena
+	{
+	public:
+		template <class Range>
+		Span Intern(const Range& a_values)
+		{
+			uint64_t hash = 14695981039346656037ull;
+			for (const auto& value : a_values) {
+				hash = (hash ^ std::hash<T>{}(static_cast<T>(value))) * 1099511628211ull;
+			}
+			const auto size = static_cast<uint32_t>(std::ranges::size(a_values));
+			for (auto [it, end] = index.equal_range(hash); it != end; ++it) {
+				if (it->second.size == size && std::ranges::equal(Get(it->second), a_values, [](T a_left, const auto& a_right) { return a_left == static_cast<T>(a_right); })) {
+					return it->second;
+				}
+			}
+
+			const Span span{ static_cast<uint32_t>(values.size()), size };
+			for (const auto& value : a_values) {
+				values.push_back(static_cast<T>(value));
+			}
+			index.emplace(hash, span);
+			return span;
+		}
+
+		std::span<const T> Get(Span a_span) const { return std::span<const T>(values.data() + a_span.offset, a_span.size); }
+		size_t GetValueCount() const { return values.size(); }
+		//Values plus an estimate of the lookup index.
+		size_t GetMemoryUsage() const { return values.capacity() * sizeof(T) + Utilities::Memory::GetHashMapMemoryUsage(index); }
+
+	private:
+		std::vector<T> values;
+		std::unordered_multimap<uint64_t, Span> index;
+	};
+
+	//The lists of registered rules. The changes of one config entry share one condition list.
+	struct RuleLists
+	{
+		ListArena<uint32_t> conditions;
+		ListArena<RE::TESBoundObject*> forms;
+		ListArena<RE::BGSKeyword*> keywords;
+	};
+
+	//A rule as it is registered from a config. The optimizer works on these, and they are compiled
+	//into the rule table once loading is done. Lists are interned in the manager's RuleLists.
+	struct RuleData
+	{
+		RuleType type;
+		uint8_t flags;
+		uint32_t count;
+		RE::TESBoundObject* target;
+		Span conditions;
+		Span forms;
+		Span keywords;
+		uint32_t source;
+
+		bool HasFlag(uint8_t a_flag) const { return (flags & a_flag) != 0; }
+	};
+
+	//Conditions of a compiled rule, static ones first. Counts are 16 bit, RegisterRule drops a rule with
+	//more conditions than that.
+	struct ConditionSpan
+	{
+		uint32_t offset;
+		uint16_t size;
+		uint16_t staticCount;
+	};
+	inline constexpr size_t maxRuleConditions = std::numeric_limits<uint16_t>::max();
+
+	//Structure of arrays holding every compiled rule. Hot per-rule data sits in parallel arrays,
+	//variable length lists live in shared arenas and are referenced by span. Rules that share a list
+	//in a_lists share it here too.
+	class RuleTable
+	{
+	public:
+		void Build(const std::vector<RuleData>& a_rules, const RuleLists& a_lists, const Conditions::ConditionList& a_conditions);
+		void Clear();
+		size_t GetMemoryUsage() const;
+		//Bytes of the parallel arrays per rule, without its lists.
+		static constexpr size_t bytesPerRule = sizeof(RuleType) + sizeof(uint8_t) + sizeof(uint32_t) + sizeof(RE::TESBoundObject*) +
+			sizeof(ConditionSpan) + 2 * sizeof(Span) + 2 * sizeof(uint32_t);
+
+		size_t size() const { return types.size(); }
+		bool empty() const { return types.empty(); }
+
+		bool HasFlag(size_t a_rule, uint8_t a_flag) const { return (flags[a_rule] & a_flag) != 0; }
+		std::span<const uint32_t> GetConditions(size_t a_rule) const { return std::span<const uint32_t>(conditionArena.data() + conditions[a_rule].offset, conditions[a_rule].size); }
+		std::span<const uint32_t> GetStaticConditions(size_t a_rule) const { return GetConditions(a_rule).first(conditions[a_rule].staticCount); }
+		std::span<const uint32_t> GetDynamicConditions(size_t a_rule) const { return GetConditions(a_rule).subspan(conditions[a_rule].staticCount); }
+		std::span<RE::TESBoundObject* const> GetForms(size_t a_rule) const { return Slice(formArena, forms[a_rule]); }
+		std::span<RE::BGSKeyword* const> GetKeywords(size_t a_rule) const { return Slice(keywordArena, keywords[a_rule]); }
+
+		std::vector<RuleType> types;
+		std::vector<uint8_t> flags;
+		std::vector<uint32_t> counts;
+		std::vector<RE::TESBoundObject*> targets;
+		std::vector<ConditionSpan> conditions;
+		std::vector<Span> forms;
+		std::vector<Span> keywords;
+		std::vector<uint32_t> sources;
+		std::vector<uint32_t> allRules;
+
+		std::vector<uint32_t> conditionArena;
+		std::vector<RE::TESBoundObject*> formArena;
+		std::vector<RE::BGSKeyword*> keywordArena;
+
+	private:
+		template <class T>
+		static std::span<const T> Slice(const std::vector<T>& a_arena, Span a_span)
+		{
+			return std::span<const T>(a_arena.data() + a_span.offset, a_span.size);
+		}
+
+		template <class T>
+		static Span Append(std::vector<T>& a_arena, std::span<const T> a_values)
+		{
+			Span span{ static_cast<uint32_t>(a_arena.size()), static_cast<uint32_t>(a_values.size()) };
+			a_arena.insert(a_arena.end(), a_values.begin(), a_values.end());
+			return span;
+		}
+	};
+}
\ No newline at end of file
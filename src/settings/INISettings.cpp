@@ -1,17 +1,22 @@
 #include "INISettings.h"
 
 #include "hooks/hooks.h"
+#include "profiling/allocationTracker.h"
+#include "profiling/liveStats.h"
+#include "profiling/ruleProfiler.h"
+#include "profiling/traceBuffer.h"
+#include "rules/candidateIndex.h"
 
 #include <SimpleIni.h>
 
 namespace Settings::INI
 {
-	void Read()
+	bool Read()
 	{
 		std::filesystem::path f{ "./Data/SKSE/Plugins/ContainerDistributionFramework.ini" };
 		if (!std::filesystem::exists(f)) {
 			Hooks::ContainerManager::GetSingleton()->RegisterDistance(25000.0f);
-			return;
+			return false;
 		}
 
 		::CSimpleIniA ini{};
@@ -25,5 +30,19 @@ namespace Settings::INI
 		else {
 			Hooks::ContainerManager::GetSingleton()->RegisterDistance(25000.0f);
 		}
+
+		Rules::CandidateIndex::SetPruneUnreachable(ini.GetBoolValue("General", "bPruneUnreachableRules", false));
+
+		if (ini.GetBoolValue("Tracing", "bEnabled", false)) {
+			Profiling::TraceBuffer::GetSingleton()->SetEnabled(true);
+		}
+
+		Profiling::SetReportSize(static_cast<size_t>(std::max(0L, ini.GetLongValue("Profiling", "iTopRules", 20))));
+		if (ini.GetBoolValue("Profiling", "bLiveStats", false)) {
+			Profiling::LiveStats::GetSingleton()->Publish();
+		}
+		Profiling::SetTrackAllocations(ini.GetBoolValue("Profiling", "bTrackAllocations", false));
+		Profiling::SetSampleRate(static_cast<uint32_t>(std::max(0L, ini.GetLongValue("Profiling", "iSampleRate", 0))));
+		return true;
 	}
 }
\ No newline at end of file
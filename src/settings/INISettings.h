@@ -4,6 +4,7 @@ namespace Settings
 {
 	namespace INI
 	{
-		void Read();
+		//False without an INI, the defaults are used then.
+		bool Read();
 	}
 }
\ No newline at end of file
@@ -1,6 +1,11 @@
 #include "JSONSettings.h"
 
+#include "configCompiler.h"
+#include "configDecoder.h"
+#include "formResolver.h"
+#include "ruleCache.h"
 #include "hooks/hooks.h"
+#include "profiling/startupReport.h"
 #include "utilities/utilities.h"
 
 #include "conditions/actorValueCondition.h"
@@ -13,632 +18,385 @@
 #include "conditions/worldspaceCondition.h"
 
 namespace {
-	void ParseNewAVs(Json::Value& a_data, bool a_inverted, std::vector<Conditions::AVCondition>& a_target, std::string& a_path, Json::Value& friendlyName) {
-		if (!a_data.isArray()) {
-			logger::warn("Config <{}>/[{}] has playerSkills specified, but it is not an array value. Config will be ignored.", a_path, friendlyName.asString());
-			return;
-		}
-
-		std::vector<std::pair<std::string, float>> requiredAVs;
-		for (auto& identifier : a_data) {
-			if (!identifier.isString()) {
-				logger::warn("Config <{}>/[{}] has playerSkills specified, but an element is not a string. Config will be ignored.", a_path, friendlyName.asString());
-				return;
-			}
-
-			auto components = Utilities::String::split(identifier.asString(), "|");
-			if (components.size() != 2) {
-				logger::warn("Config <{}>/[{}] has playerSkills specified, but an element ({}) is not formatted correctly (Skill|Level). Config will be ignored.", a_path, friendlyName.asString(), identifier.asString());
-				return;
-			}
-			float requiredLevel = -1.0f;
-			try {
-				requiredLevel = std::stof(components.at(1));
-			}
-			catch (std::exception& e) {
-				logger::warn("Config <{}>/[{}] has playerSkills specified, but an element ({}) is not formatted correctly (Skill|Level). Config will be ignored.", a_path, friendlyName.asString(), identifier.asString());
-				logger::warn("Error: {}", e.what());
-				return;
-			}
-			if (requiredLevel < 0.0f) {
-				logger::warn("Don't use negative valued for playerSkills.");
-			}
-
-			requiredAVs.push_back({ components.at(0), requiredLevel });
+	//The game side of Settings::Config::RuleCompiler.
+	class GameForms
+	{
+	public:
+		using Item = RE::TESBoundObject*;
+		using Container = RE::TESObjectCONT*;
+		using Location = RE::BGSLocation*;
+		using Worldspace = RE::TESWorldSpace*;
+		using Keyword = RE::BGSKeyword*;
+		using Global = RE::TESGlobal*;
+		using Quest = RE::TESQuest*;
+		using Rule = Settings::Config::CompiledRule<GameForms>;
+
+		GameForms(Settings::FormResolver& a_resolver) :
+			resolver(a_resolver)
+		{}
+
+		bool HasMod(std::string_view a_name) { return resolver.LookupMod(a_name) != nullptr; }
+
+		Item ResolveItem(std::string_view a_identifier) { return resolver.Resolve<RE::TESBoundObject>(a_identifier); }
+		Container ResolveContainer(std::string_view a_identifier) { return resolver.Resolve<RE::TESObjectCONT>(a_identifier); }
+		Location ResolveLocation(std::string_view a_identifier) { return resolver.Resolve<RE::BGSLocation>(a_identifier); }
+		Worldspace ResolveWorldspace(std::string_view a_identifier) { return resolver.Resolve<RE::TESWorldSpace>(a_identifier); }
+		Keyword ResolveKeyword(std::string_view a_identifier) { return resolver.Resolve<RE::BGSKeyword>(a_identifier); }
+
+		Keyword FindKeyword(std::string_view a_editorID) { return RE::TESForm::LookupByEditorID<RE::BGSKeyword>(a_editorID); }
+		Global FindGlobal(std::string_view a_editorID) { return RE::TESForm::LookupByEditorID<RE::TESGlobal>(a_editorID); }
+		Quest FindQuest(std::string_view a_editorID) { return RE::TESForm::LookupByEditorID<RE::TESQuest>(a_editorID); }
+
+	private:
+		Settings::FormResolver& resolver;
+	};
+
+	void Report(Settings::Config::Severity a_severity, const std::string& a_message)
+	{
+		if (a_severity == Settings::Config::Severity::kWarning) {
+			logger::warn("{}", a_message);
 		}
-		for (const auto& pair : requiredAVs) {
-			Conditions::AVCondition newCondition{ pair.first, pair.second };
-			newCondition.inverted = a_inverted;
-			a_target.push_back(newCondition);
+		else {
+			logger::info("{}", a_message);
 		}
 	}
 
-	void ParseNewContainers(Json::Value& a_data, bool a_inverted, std::vector<Conditions::ContainerCondition>& a_target, std::string& a_path, Json::Value& friendlyName) {
-		if (!a_data.isArray()) {
-			logger::warn("Config <{}>/[{}] has containers specified, but it is not an array value. Config will be ignored.", a_path, friendlyName.asString());
-			return;
-		}
-
-		std::vector<RE::TESObjectCONT*> forms{};
-		for (auto& identifier : a_data) {
-			if (!identifier.isString()) {
-				logger::warn("Config <{}>/[{}] has containers specified, but an element is not a string. Config will be ignored.", a_path, friendlyName.asString());
-				return;
-			}
-
-			const auto container = Utilities::Forms::GetFormFromString<RE::TESObjectCONT>(identifier.asString());
-			if (!container) {
-				logger::info("Config <{}>/[{}] requires container {}, but it is not present. This is not fatal.", a_path, friendlyName.asString(), identifier.asString());
-				continue;
+	template <class T, class... Args>
+	void StoreCondition(std::vector<size_t>& a_targets, bool a_inverted, Args&&... a_args)
+	{
+		auto* singleton = Hooks::ContainerManager::GetSingleton();
+		auto condition = std::make_shared<T>(std::forward<Args>(a_args)...);
+		condition->inverted = a_inverted;
+		a_targets.push_back(singleton->storedConditions.size());
+		singleton->storedConditions.push_back(std::move(condition));
+	}
+}
+namespace Settings::JSON
+{
+	static std::vector<std::string> findJsonFiles()
+	{
+		static constexpr std::string_view directory = R"(Data/SKSE/Plugins/ContainerDistributionFramework)";
+		std::vector<std::string> jsonFilePaths;
+		for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+			if (entry.is_regular_file() && entry.path().extension() == ".json") {
+				jsonFilePaths.push_back(entry.path().string());
 			}
-			forms.push_back(container);
 		}
-		Conditions::ContainerCondition newCondition{ forms };
-		newCondition.inverted = a_inverted;
-		a_target.push_back(newCondition);
-	}
 
-	void ParseNewLocations(Json::Value& a_data, bool a_inverted, std::vector<Conditions::LocationCondition>& a_target, std::string& a_path, Json::Value& friendlyName) {
-		if (!a_data.isArray()) {
-			logger::warn("Config <{}>/[{}] has locations specified, but it is not an array value. Config will be ignored.", a_path, friendlyName.asString());
-			return;
-		}
+		std::sort(jsonFilePaths.begin(), jsonFilePaths.end());
+		return jsonFilePaths;
+	}
 
-		std::vector<RE::BGSLocation*> forms{};
-		for (auto& identifier : a_data) {
-			if (!identifier.isString()) {
-				logger::warn("Config <{}>/[{}] has locations specified, but an element is not a string. Config will be ignored.", a_path, friendlyName.asString());
-				return;
-			}
+	struct ParsedFile
+	{
+		Config::ConfigFile config;
+		std::string error;
+		uint64_t hash{ 0 };
+		std::filesystem::file_time_type time{};
+		uintmax_t size{ 0 };
+		double milliseconds{ 0.0 };
+	};
+
+	//What a config looked like when its rules were last registered, for Reload.
+	struct FileState
+	{
+		std::filesystem::file_time_type time{};
+		uintmax_t size{ 0 };
+		uint64_t hash{ 0 };
+	};
 
-			const auto container = Utilities::Forms::GetFormFromString<RE::BGSLocation>(identifier.asString());
-			if (!container) {
-				logger::info("Config <{}>/[{}] requires location {}, but it is not present. This is not fatal.", a_path, friendlyName.asString(), identifier.asString());
-				continue;
-			}
-			forms.push_back(container);
+	//Everything that can be done before the game's data is loaded.
+	struct PendingRead
+	{
+		std::vector<std::string> paths;
+		std::vector<ParsedFile> files;
+		std::string error;
+		std::chrono::duration<double, std::milli> duration{};
+		std::chrono::duration<double, std::milli> discovery{};
+	};
+
+	static void ParseFile(const std::string& a_path, ParsedFile& a_result)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		std::error_code error{};
+		a_result.time = std::filesystem::last_write_time(a_path, error);
+		a_result.size = std::filesystem::file_size(a_path, error);
+		try {
+			Config::Decode(a_path, a_result.config, a_result.error);
 		}
-		Conditions::LocationCondition newCondition{ forms };
-		newCondition.inverted = a_inverted;
-		a_target.push_back(newCondition);
+		catch (const std::exception& e) {
+			a_result.error = fmt::format("Caught unhandled exception {} while reading files.", e.what());
+		}
+		a_result.hash = Cache::HashConfig(a_path, a_result.config.mapping.GetView());
+		a_result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
 	}
 
-	void ParseNewWorldspaces(Json::Value& a_data, bool a_inverted, std::vector<Conditions::WorldspaceCondition>& a_target, std::string& a_path, Json::Value& friendlyName) {
-		if (!a_data.isArray()) {
-			logger::warn("Config <{}>/[{}] has worldspaces specified, but it is not an array value. Config will be ignored.", a_path, friendlyName.asString());
-			return;
+	static PendingRead LoadFiles()
+	{
+		const auto start = std::chrono::steady_clock::now();
+		PendingRead result{};
+		try {
+			result.paths = findJsonFiles();
 		}
-
-		std::vector<RE::TESWorldSpace*> forms{};
-		for (auto& identifier : a_data) {
-			if (!identifier.isString()) {
-				logger::warn("Config <{}>/[{}] has worldspaces specified, but an element is not a string. Config will be ignored.", a_path, friendlyName.asString());
-				return;
-			}
-
-			const auto form = Utilities::Forms::GetFormFromString<RE::TESWorldSpace>(identifier.asString());
-			if (!form) {
-				logger::info("Config <{}>/[{}] requires worldspaces {}, but it is not present. This is not fatal.", a_path, friendlyName.asString(), identifier.asString());
-				continue;
-			}
-			forms.push_back(form);
+		catch (const std::exception& e) {
+			result.error = fmt::format("Caught {} while reading files.", e.what());
+			return result;
 		}
-		Conditions::WorldspaceCondition newCondition{ forms };
-		newCondition.inverted = a_inverted;
-		a_target.push_back(newCondition);
+		result.discovery = std::chrono::steady_clock::now() - start;
+
+		//Mapping and decoding doesn't touch the game, so it is spread over the worker pool. Forms are
+		//resolved and rules registered on the main thread afterwards, in the sorted file order.
+		result.files.resize(result.paths.size());
+		std::for_each(std::execution::par, result.files.begin(), result.files.end(), [&](ParsedFile& a_file) {
+			const auto index = static_cast<size_t>(&a_file - result.files.data());
+			ParseFile(result.paths[index], a_file);
+			});
+		result.duration = std::chrono::steady_clock::now() - start;
+		return result;
 	}
 
-	void ParseNewLocationKeywords(Json::Value& a_data, bool a_inverted, std::vector<Conditions::LocationKeywordCondition>& a_target, std::string& a_path, Json::Value& friendlyName) {
-		if (!a_data.isArray()) {
-			logger::warn("Config <{}>/[{}] has locationKeywords specified, but it is not an array value. Config will be ignored.", a_path, friendlyName.asString());
-			return;
-		}
-
-		std::vector<RE::BGSKeyword*> forms{};
-		for (auto& identifier : a_data) {
-			if (!identifier.isString()) {
-				logger::warn("Config <{}>/[{}] has locationKeywords specified, but an element is not a string. Config will be ignored.", a_path, friendlyName.asString());
-				return;
-			}
+	static std::future<PendingRead> pendingRead;
+	static std::map<std::string, FileState> fileStates;
 
-			const auto keyword = RE::TESForm::LookupByEditorID<RE::BGSKeyword>(identifier.asString());
-			if (!keyword) {
-				logger::info("Config <{}>/[{}] requires keyword {}, but it is not present. This is not fatal.", a_path, friendlyName.asString(), identifier.asString());
-				continue;
-			}
-			forms.push_back(keyword);
+	static void WriteCache(const std::vector<uint64_t>& a_configHashes)
+	{
+		Cache::Writer writer{};
+		if (!Hooks::ContainerManager::GetSingleton()->SerializeRules(writer) || !writer.Finish(Cache::GetPath(), Cache::BuildKey(a_configHashes))) {
+			logger::warn("Failed to write the compiled rule cache: {}.", writer.error);
 		}
-		Conditions::LocationKeywordCondition newCondition{ forms };
-		newCondition.inverted = a_inverted;
-		a_target.push_back(newCondition);
 	}
 
-	void ParseNewGlobals(Json::Value& a_data, bool a_inverted, std::vector<Conditions::GlobalCondition>& a_target, std::string& a_path, Json::Value& friendlyName) {
-		if (!a_data.isArray()) {
-			logger::warn("Config <{}>/[{}] has globals specified, but it is not an array value. Config will be ignored.", a_path, friendlyName.asString());
-			return;
+	//Returns where the time went, for the startup report. Resolution is everything but registration.
+	Profiling::StartupReport::FileTiming ReadConfig(Config::ConfigFile& a_config, std::string& a_path, FormResolver& a_resolver) {
+		Profiling::StartupReport::FileTiming timing{};
+		const auto dataHandler = RE::TESDataHandler::GetSingleton();
+		assert(dataHandler);
+		if (!dataHandler) {
+			logger::critical("FAILED TO GET DATA HANDLER, YOU WILL PROBABLY CRASH.");
+			return timing;
 		}
 
-		std::vector<std::pair<RE::TESGlobal*, float>> requiredGlobals;
-		for (auto& identifier : a_data) {
-			if (!identifier.isString()) {
-				logger::warn("Config <{}>/[{}] has globals specified, but an element is not a string. Config will be ignored.", a_path, friendlyName.asString());
-				return;
+		//Checks and form lookups live in Config::RuleCompiler, shared with the offline linter.
+		auto* singleton = Hooks::ContainerManager::GetSingleton();
+		GameForms forms{ a_resolver };
+		const auto start = std::chrono::steady_clock::now();
+		Config::CompileRules(a_config, a_path, forms, Report, [&](GameForms::Rule& a_rule) {
+			const auto registerStart = std::chrono::steady_clock::now();
+			std::vector<size_t> targets{};
+			for (const auto& skill : a_rule.skills) {
+				StoreCondition<Conditions::AVCondition>(targets, skill.inverted, std::string(skill.name), skill.level);
 			}
-
-			auto components = Utilities::String::split(identifier.asString(), "|");
-			if (components.size() != 2) {
-				logger::warn("Config <{}>/[{}] has globals specified, but an element ({}) is not formatted correctly (Global|Value). Config will be ignored.", a_path, friendlyName.asString(), identifier.asString());
-				return;
+			for (auto& set : a_rule.containers) {
+				StoreCondition<Conditions::ContainerCondition>(targets, set.inverted, std::move(set.forms));
 			}
-
-			const auto global = RE::TESForm::LookupByEditorID<RE::TESGlobal>(components.at(0));
-			if (!global) {
-				logger::info("Config <{}>/[{}] requires global {}, but it is not present. This is not fatal.", a_path, friendlyName.asString(), identifier.asString());
-				continue;
+			for (const auto& global : a_rule.globals) {
+				StoreCondition<Conditions::GlobalCondition>(targets, global.inverted, global.global, global.value);
 			}
-
-			float globalValue = -1.0f;
-			try {
-				globalValue = std::stof(components.at(1));
+			for (auto& set : a_rule.locations) {
+				StoreCondition<Conditions::LocationCondition>(targets, set.inverted, std::move(set.forms));
 			}
-			catch (std::exception& e) {
-				logger::warn("Config <{}>/[{}] has globals specified, but an element ({}) is not formatted correctly (Global|Value). Config will be ignored.", a_path, friendlyName.asString(), identifier.asString());
-				logger::warn("Error: {}", e.what());
-				return;
+			for (auto& set : a_rule.locationKeywords) {
+				StoreCondition<Conditions::LocationKeywordCondition>(targets, set.inverted, std::move(set.forms));
 			}
-			if (globalValue < 0.0f) {
-				logger::warn("Don't use negative valued for globals.");
+			for (auto& quest : a_rule.quests) {
+				StoreCondition<Conditions::QuestCondition>(targets, quest.inverted, quest.quest, std::move(quest.stages), quest.completed);
 			}
-			requiredGlobals.push_back({ global, globalValue });
-		}
-		for (const auto& pair : requiredGlobals) {
-			Conditions::GlobalCondition newCondition{ pair.first, pair.second };
-			newCondition.inverted = a_inverted;
-			a_target.push_back(newCondition);
-		}
+			for (auto& set : a_rule.references) {
+				StoreCondition<Conditions::ReferenceCondition>(targets, set.inverted, std::move(set.ids));
+			}
+			for (auto& set : a_rule.worldspaces) {
+				StoreCondition<Conditions::WorldspaceCondition>(targets, set.inverted, std::move(set.forms));
+			}
+
+			const auto source = singleton->RegisterSource(a_path, std::string(a_rule.friendlyName));
+			const auto conditions = singleton->InternConditions(targets);
+
+			//Forms are resolved once here and handed to the manager as they are.
+			for (auto& change : a_rule.changes) {
+				Hooks::ContainerManager::ResolvedChange resolved{ std::move(change.add), change.remove, std::move(change.removeKeywords), change.count };
+				singleton->RegisterRule(std::move(resolved), conditions, a_rule.bypassUnsafeContainers, a_rule.allowVendors, a_rule.onlyVendors, a_rule.randomAdd, source);
+			}
+			timing.rules += a_rule.changes.size();
+			timing.registration += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - registerStart).count();
+			});
+		const std::chrono::duration<double, std::milli> total = std::chrono::steady_clock::now() - start;
+		timing.resolution = std::max(0.0, total.count() - timing.registration);
+		return timing;
 	}
 
-	void ParseNewQuests(Json::Value& a_data, bool a_inverted, std::vector<Conditions::QuestCondition>& a_target, std::string& a_path, Json::Value& friendlyName) {
-		if (!a_data.isObject()) {
-			logger::warn("Config <{}>/[{}] has questConditions specified, but it is not an object value. Config will be ignored.", a_path, friendlyName.asString());
-			return;
-		}
+	void BeginRead()
+	{
+		pendingRead = std::async(std::launch::async, LoadFiles);
+	}
 
-		if (!a_data["questID"] || !a_data["questID"].isString()) {
-			logger::warn("Config <{}>/[{}] has questConditions specified, but an element is missing questID (or it is not a string).", a_path, friendlyName.asString());
-			return;
+	void Read()
+	{
+		const auto start = std::chrono::steady_clock::now();
+		const bool startedEarly = pendingRead.valid();
+		auto pending = startedEarly ? pendingRead.get() : LoadFiles();
+		if (startedEarly) {
+			const std::chrono::duration<double, std::milli> waited = std::chrono::steady_clock::now() - start;
+			logger::info("Config files were read in {:.1f} ms on a background thread during game load. Waited {:.1f} ms for it here, {:.1f} ms saved.", pending.duration.count(), waited.count(), std::max(0.0, (pending.duration - waited).count()));
 		}
 
-		if (!(a_data["stageDone"] || a_data["completed"])) {
-			logger::warn("Config <{}>/[{}] has questConditions specified, but is missing the actual condition (stagedone/completed).", a_path, friendlyName.asString());
+		if (!pending.error.empty()) {
+			logger::warn("{}", pending.error);
 			return;
 		}
-
-		const auto quest = RE::TESForm::LookupByEditorID<RE::TESQuest>(a_data["questID"].asString());
-		if (!quest) {
-			logger::info("Config <{}>/[{}] requires quest {}, but it is not present. This is not fatal.", a_path, friendlyName.asString(), a_data["questID"].asString());
+		auto* report = Profiling::StartupReport::GetSingleton();
+		report->Add(Profiling::StartupPhase::kFileDiscovery, pending.discovery.count(), pending.paths.size());
+		auto& paths = pending.paths;
+		if (paths.empty()) {
+			logger::info("No settings found");
 			return;
 		}
 
-		bool completed = a_data["completed"] && a_data["completed"].isBool() ? a_data["completed"].asBool() : true;
-		std::vector<uint16_t> completedStages{};
-		if (a_data["stageDone"] && a_data["stageDone"].isArray()) {
-			for (const auto& field : a_data["stageDone"]) {
-				if (!field.isUInt()) {
-					logger::warn("Config <{}>/[{}] requires quest {}, but at least one stage specified is not a number, config will be ignored.", a_path, friendlyName.asString(), a_data["questID"].asString());
-					return;
-				}
-				completedStages.push_back(static_cast<uint16_t>(field.asUInt()));
-			}
+		//Unchanged configs and load order: the resolved rules from the last launch are still valid.
+		auto* manager = Hooks::ContainerManager::GetSingleton();
+		const auto cachePath = Cache::GetPath();
+		std::vector<uint64_t> configHashes{};
+		for (const auto& file : pending.files) {
+			configHashes.push_back(file.hash);
 		}
-		Conditions::QuestCondition newCondition{ quest, completedStages, completed };
-		newCondition.inverted = a_inverted;
-		a_target.push_back(newCondition);
-	}
-
-	void ParseNewReferences(Json::Value& a_data, bool a_inverted, std::vector<Conditions::ReferenceCondition>& a_target, std::string& a_path, Json::Value& friendlyName) {
-		if (!a_data.isArray()) {
-			logger::warn("Config <{}>/[{}] has references specified, but it is not an array value. Config will be ignored.", a_path, friendlyName.asString());
-			return;
+		const auto cacheKey = Cache::BuildKey(configHashes);
+		for (size_t i = 0; i < paths.size(); ++i) {
+			const auto& file = pending.files[i];
+			fileStates[paths[i]] = { file.time, file.size, file.hash };
 		}
-
-		std::vector<RE::FormID> forms{};
-		for (auto& identifier : a_data) {
-			if (!identifier.isString()) {
-				logger::warn("Config <{}>/[{}] has references specified, but an element is not a string. Config will be ignored.", a_path, friendlyName.asString());
+		{
+			//Scoped so the mapping is released before the cache is rewritten.
+			Profiling::StartupTimer timer{ Profiling::StartupPhase::kRuleCache };
+			Cache::Reader reader{};
+			if (reader.Open(cachePath, cacheKey) && manager->DeserializeRules(reader)) {
+				timer.SetItems(manager->GetRuleCount());
+				for (size_t i = 0; i < paths.size(); ++i) {
+					report->AddFile(paths[i], { pending.files[i].milliseconds });
+				}
+				logger::info("Configs and load order are unchanged, loaded rules from the compiled cache. Config errors were reported on the launch that built it.");
 				return;
 			}
-
-			const auto id = Utilities::String::to_num<RE::FormID>(identifier.asString(), true);
-			forms.push_back(id);
+			logger::info("Not using the compiled rule cache ({}), reading configs.", reader.error);
 		}
-		Conditions::ReferenceCondition newCondition{ forms };
-		newCondition.inverted = a_inverted;
-		a_target.push_back(newCondition);
-	}
-}
-namespace Settings::JSON
-{
-	static std::vector<std::string> findJsonFiles()
-	{
-		static constexpr std::string_view directory = R"(Data/SKSE/Plugins/ContainerDistributionFramework)";
-		std::vector<std::string> jsonFilePaths;
-		for (const auto& entry : std::filesystem::directory_iterator(directory)) {
-			if (entry.is_regular_file() && entry.path().extension() == ".json") {
-				jsonFilePaths.push_back(entry.path().string());
-			}
-		}
-
-		std::sort(jsonFilePaths.begin(), jsonFilePaths.end());
-		return jsonFilePaths;
-	}
-
-	void ReadConfig(Json::Value& a_config, std::string& a_path) {
-		auto& rules = a_config["rules"];
-		if (!rules || !rules.isArray()) return;
-
-		for (auto& data : rules) {
-			auto& friendlyName = data["friendlyName"];
-			if (!friendlyName || !friendlyName.isString()) {
-				logger::warn("Config <{}> is missing friendly name, or friendly name is not a string.", a_path);
-				return;
-			}
-			auto& conditions = data["conditions"];
-			auto& changes = data["changes"];
-			if (!changes || !changes.isArray()) {
-				logger::warn("Config <{}>/[{}] is either missing the changes field, or it is not an array.", a_path, friendlyName.asString());
-				return;
-			}
-
-			const auto dataHandler = RE::TESDataHandler::GetSingleton();
-			assert(dataHandler);
-			if (!dataHandler) {
-				logger::critical("FAILED TO GET DATA HANDLER, YOU WILL PROBABLY CRASH.");
-				return;
-			}
-
-			//Initializing condition results so that they may be used in changes.
-			bool bypassUnsafeContainers = false;
-			bool distributeToVendors = false;
-			bool onlyVendors = false;
-			bool randomAdd = false;
-			std::vector<Conditions::AVCondition> newAVs{};
-			std::vector<Conditions::ContainerCondition> newContainers{};
-			std::vector<Conditions::GlobalCondition> newGlobals{};
-			std::vector<Conditions::LocationCondition> newLocations{};
-			std::vector<Conditions::LocationKeywordCondition> newLocationKeywords{};
-			std::vector<Conditions::QuestCondition> newQuests{};
-			std::vector<Conditions::ReferenceCondition> newReferences{};
-			std::vector<Conditions::WorldspaceCondition> newWorldspaces{};
-			std::vector<size_t> targets{};
-			auto* singleton = Hooks::ContainerManager::GetSingleton();
-
-			if (conditions) {
-				//Plugins Check
-				auto& plugins = conditions["plugins"];
-				if (plugins) {
-					if (!plugins.isArray()) {
-						logger::warn("Config <{}>/[{}] has plugins specified, but plugins are not an array. Config will be ignored.", a_path, friendlyName.asString());
-						return;
-					}
-
-					for (auto& plugin : plugins) {
-						if (!plugin.isString()) {
-							logger::warn("Config <{}>/[{}] has plugins specified, and a plugin is not a string. Config will be ignored.", a_path, friendlyName.asString());
-							return;
-						}
-
-						if (!dataHandler->LookupModByName(plugin.asString())) {
-							logger::info("Note that config <{}>/[{}] requires mod {} to work, which is not present.", a_path, friendlyName.asString(), plugin.asString());
-							return;
-						}
-					}
-				} // End of plugins
-
-				//Bypass Check.
-				auto& bypassField = conditions["bypassUnsafeContainers"];
-				if (bypassField) {
-					if (!bypassField.isBool()) {
-						logger::warn("Config <{}>/[{}] has bypassUnsafeContainers specified, but it is not a bool value. Config will be ignored.", a_path, friendlyName.asString());
-						return;
-					}
-					bypassUnsafeContainers = bypassField.asBool();
-				}
-
-				//Vendors Check.
-				auto& vendorsField = conditions["allowVendors"];
-				if (vendorsField) {
-					if (!vendorsField.isBool()) {
-						logger::warn("Config <{}>/[{}] has allowVendors specified, but it is not a bool value. Config will be ignored.", a_path, friendlyName.asString());
-						return;
-					}
-					distributeToVendors = vendorsField.asBool();
-				}
-
-				//Vendors only Check.
-				auto& vendorsOnlyField = conditions["onlyVendors"];
-				if (vendorsOnlyField) {
-					if (!vendorsOnlyField.isBool()) {
-						logger::warn("Config <{}>/[{}] has onlyVendors specified, but it is not a bool value. Config will be ignored.", a_path, friendlyName.asString());
-						return;
-					}
-
-					if (!distributeToVendors && vendorsOnlyField.asBool()) {
-						distributeToVendors = true;
-						onlyVendors = true;
-					}
-					else if (vendorsOnlyField.asBool()) {
-						onlyVendors = true;
-					}
-				}
-
-				//Random add
-				auto& randomAddField = conditions["randomAdd"];
-				if (randomAddField) {
-					if (!randomAddField.isBool()) {
-						logger::warn("Config <{}>/[{}] has randomAdd specified, but it is not a bool value. Config will be ignored.", a_path, friendlyName.asString());
-						return;
-					}
-					randomAdd = randomAddField.asBool();
-				}
-				
-				//Container check
-				auto& containerField = conditions["containers"];
-				auto& reverseContainersField = conditions["!containers"];
-				if (containerField) {
-					ParseNewContainers(containerField, false, newContainers, a_path, friendlyName);
-				}
-				if (reverseContainersField) {
-					ParseNewContainers(reverseContainersField, true, newContainers, a_path, friendlyName);
-				}
-
-				//Location check
-				auto& locations = conditions["locations"];
-				auto& reverseLocations = conditions["!locations"];
-				if (locations) {
-					ParseNewLocations(locations, false, newLocations, a_path, friendlyName);
-				}
-				if (reverseLocations) {
-					ParseNewLocations(reverseLocations, true, newLocations, a_path, friendlyName);
-				}
-
-				//Worldspace check
-				auto& worldspaces = conditions["worldspaces"];
-				auto& reverseWorldspaces = conditions["!worldspaces"];
-				if (worldspaces) {
-					ParseNewWorldspaces(worldspaces, false, newWorldspaces, a_path, friendlyName);
-				}
-				if (reverseWorldspaces) {
-					ParseNewWorldspaces(reverseWorldspaces, true, newWorldspaces, a_path, friendlyName);
-				}
-
-				//Location Keywords check
-				auto& locationKeywords = conditions["locationKeywords"];
-				auto& reverseLocationKeywords = conditions["!locationKeywords"];
-				if (locationKeywords) {
-					ParseNewLocationKeywords(locationKeywords, false, newLocationKeywords, a_path, friendlyName);
-				}
-				if (reverseLocationKeywords) {
-					ParseNewLocationKeywords(reverseLocationKeywords, true, newLocationKeywords, a_path, friendlyName);
-				}
-
-				//player skill check
-				auto& playerSkillsField = conditions["playerSkills"];
-				auto& reversePlayerSkillsField = conditions["!playerSkills"];
-				if (playerSkillsField) {
-					ParseNewAVs(playerSkillsField, false, newAVs, a_path, friendlyName);
-				}
-				if (reversePlayerSkillsField) {
-					ParseNewAVs(reversePlayerSkillsField, true, newAVs, a_path, friendlyName);
-				}
-
-				//Global check
-				auto& globalsField = conditions["globals"];
-				auto& reverseGlobalsField = conditions["!globals"];
-				if (globalsField) {
-					ParseNewGlobals(globalsField, false, newGlobals, a_path, friendlyName);
-				}
-				if (reverseGlobalsField) {
-					ParseNewGlobals(reverseGlobalsField, true, newGlobals, a_path, friendlyName);
-				}
 
-				//Quest check
-				auto& questConditionField = conditions["questConditions"];
-				if (questConditionField) {
-					ParseNewQuests(questConditionField, false, newQuests, a_path, friendlyName);
-				}
-
-				//References check
-				auto& referencesField = conditions["references"];
-				auto& reverseReferencesField = conditions["!references"];
-				if (referencesField) {
-					ParseNewReferences(referencesField, false, newReferences, a_path, friendlyName);
-				}
-				if (reverseReferencesField) {
-					ParseNewReferences(reverseReferencesField, true, newReferences, a_path, friendlyName);
-				}
-			} //End of Conditions
-
-			if (!newAVs.empty()) {
-				for (const auto& item : newAVs) {
-					targets.push_back(singleton->storedConditions.size());
-					singleton->storedConditions.push_back(std::make_unique<Conditions::AVCondition>(item));
-				}
-			}
-
-			if (!newContainers.empty()) {
-				for (const auto& item : newContainers) {
-					targets.push_back(singleton->storedConditions.size());
-					singleton->storedConditions.push_back(std::make_unique<Conditions::ContainerCondition>(item));
-				}
-			}
-
-			if (!newGlobals.empty()) {
-				for (const auto& item : newGlobals) {
-					targets.push_back(singleton->storedConditions.size());
-					singleton->storedConditions.push_back(std::make_unique<Conditions::GlobalCondition>(item));
-				}
-			}
-
-			if (!newLocations.empty()) {
-				for (const auto& item : newLocations) {
-					targets.push_back(singleton->storedConditions.size());
-					singleton->storedConditions.push_back(std::make_unique<Conditions::LocationCondition>(item));
-				}
+		FormResolver resolver{};
+		for (size_t i = 0; i < paths.size(); ++i) {
+			auto& path = paths[i];
+			auto& parsedFile = pending.files[i];
+			Profiling::StartupReport::FileTiming timing{ parsedFile.milliseconds };
+			if (!parsedFile.error.empty()) {
+				logger::warn("{}", parsedFile.error);
 			}
-
-			if (!newLocationKeywords.empty()) {
-				for (const auto& item : newLocationKeywords) {
-					targets.push_back(singleton->storedConditions.size());
-					singleton->storedConditions.push_back(std::make_unique<Conditions::LocationKeywordCondition>(item));
-				}
-			}
-
-			if (!newQuests.empty()) {
-				for (const auto& item : newQuests) {
-					targets.push_back(singleton->storedConditions.size());
-					singleton->storedConditions.push_back(std::make_unique<Conditions::QuestCondition>(item));
-				}
-			}
-
-			if (!newReferences.empty()) {
-				for (const auto& item : newReferences) {
-					targets.push_back(singleton->storedConditions.size());
-					singleton->storedConditions.push_back(std::make_unique<Conditions::ReferenceCondition>(item));
-				}
-			}
-
-			if (!newWorldspaces.empty()) {
-				for (const auto& item : newWorldspaces) {
-					targets.push_back(singleton->storedConditions.size());
-					singleton->storedConditions.push_back(std::make_unique<Conditions::WorldspaceCondition>(item));
-				}
+			else if (parsedFile.config.rootType != Config::ValueType::kObject) {
+				logger::warn("<{}> is not an object. File will be ignored.", path);
 			}
-
-			//This is just verification, so forms are parsed twice. Improve this.
-			for (auto& change : changes) {
-				const auto& add = change["add"];
-				const auto& remove = change["remove"];
-				const auto& removeKeywords = change["removeByKeywords"];
-				const auto& count = change["count"];
-				if (!add && !remove && !removeKeywords && !count) {
-					logger::warn("No changes detected, was this meant?");
-					continue;
-				}
-
-				if (count) {
-					if (!count.isUInt()) {
-						logger::warn("Config <{}>/[{}], rule has invalid count.", a_path, friendlyName.asString());
-						continue;
-					}
-				}
-				if (remove) {
-					if (!remove.isString()) {
-						logger::warn("config <{}>/[{}], rule has invalid remove data.", a_path, friendlyName.asString());
-						continue;
-					}
-
-					const auto obj = Utilities::Forms::GetFormFromString<RE::TESBoundObject>(remove.asString());
-					if (!obj) {
-						logger::warn("Config <{}>/[{}] contains invalid remove data - missing form {}.", a_path, friendlyName.asString(), remove.asString());
-						continue;
-					}
-				}
-				if (add) {
-					if (!add.isArray()) {
-						logger::warn("config <{}>/[{}], rule has invalid add data.", a_path, friendlyName.asString());
-						continue;
-					}
-
-					bool shouldSkip = false;
-					for (auto it = add.begin(); !shouldSkip && it != add.end(); ++it) {
-						const auto& entry = *it;
-						if (!entry.isString()) {
-							logger::warn("Config <{}>/[{}] contains invalid add data.", a_path, friendlyName.asString());
-							shouldSkip = true;
-							continue;
-						}
-
-						auto* obj = Utilities::Forms::GetFormFromString<RE::TESBoundObject>(entry.asString());
-						if (!obj) {
-							logger::warn("Config <{}>/[{}] contains invalid add data - missing form {}.", a_path, friendlyName.asString(), entry.asString());
-							shouldSkip = true;
-							continue;
-						}
-					}
-					if (shouldSkip) {
-						continue;
-					}
-				}
-				if (removeKeywords) {
-					if (!removeKeywords.isArray()) {
-						logger::warn("config <{}>/[{}], rule has invalid removeKeywords data.", a_path, friendlyName.asString());
-						continue;
-					}
-
-					bool shouldSkip = false;
-					for (auto it = removeKeywords.begin(); !shouldSkip && it != removeKeywords.end(); ++it) {
-						const auto& entry = *it;
-						if (!entry.isString()) {
-							logger::warn("Config <{}>/[{}] contains invalid removeKeywords data.", a_path, friendlyName.asString());
-							shouldSkip = true;
-							continue;
-						}
-
-						const auto keyword = Utilities::Forms::GetFormFromString<RE::BGSKeyword>(entry.asString());
-						if (!keyword) {
-							logger::warn("Config <{}>/[{}] contains invalid removeKeywords data - missing form {}.", a_path, friendlyName.asString(), entry.asString());
-							shouldSkip = true;
-							continue;
-						}
-					}
-					if (shouldSkip) {
-						continue;
-					}
-				}
-				Hooks::ContainerManager::GetSingleton()->RegisterRule(change, targets, bypassUnsafeContainers, distributeToVendors, onlyVendors, randomAdd);
+			else {
+				timing = ReadConfig(parsedFile.config, path, resolver);
+				timing.parse = parsedFile.milliseconds;
+				//Unmap as soon as the records are consumed.
+				parsedFile.config = {};
 			}
+			report->AddFile(path, timing);
 		}
+		report->Add(Profiling::StartupPhase::kFormResolution, 0.0, resolver.GetLookupCount());
+		logger::info("Resolved {} form strings, {} of them from the lookup cache.", resolver.GetLookupCount(), resolver.GetHitCount());
+		WriteCache(configHashes);
 	}
 
-	void Read()
+	std::string Reload()
 	{
+		const auto start = std::chrono::steady_clock::now();
 		std::vector<std::string> paths{};
 		try {
 			paths = findJsonFiles();
 		}
 		catch (const std::exception& e) {
 			logger::warn("Caught {} while reading files.", e.what());
-			return;
-		}
-		if (paths.empty()) {
-			logger::info("No settings found");
-			return;
+			return fmt::format("Reload failed: {}", e.what());
 		}
 
-		for (auto& path : paths) {
-			Json::Reader JSONReader;
-			Json::Value JSONFile;
-			try {
-				std::ifstream rawJSON(path);
-				JSONReader.parse(rawJSON, JSONFile);
+		//Files with the same time and size are taken as unchanged without reading them. The rest are
+		//decoded, a file that was only touched is recognized by its hash.
+		std::vector<size_t> candidates{};
+		for (size_t i = 0; i < paths.size(); ++i) {
+			const auto state = fileStates.find(paths[i]);
+			std::error_code error{};
+			const auto time = std::filesystem::last_write_time(paths[i], error);
+			const auto size = std::filesystem::file_size(paths[i], error);
+			if (state == fileStates.end() || state->second.time != time || state->second.size != size) {
+				candidates.push_back(i);
 			}
-			catch (const Json::Exception& e) {
-				logger::warn("Caught {} while reading files.", e.what());
+		}
+
+		std::vector<ParsedFile> parsed(candidates.size());
+		std::for_each(std::execution::par, parsed.begin(), parsed.end(), [&](ParsedFile& a_file) {
+			const auto index = static_cast<size_t>(&a_file - parsed.data());
+			ParseFile(paths[candidates[index]], a_file);
+			});
+
+		std::unordered_set<std::string> stale{};
+		std::vector<size_t> changed{};
+		for (size_t i = 0; i < candidates.size(); ++i) {
+			const auto& path = paths[candidates[i]];
+			auto& state = fileStates[path];
+			const bool sameContents = state.hash == parsed[i].hash && state.hash != 0;
+			state.time = parsed[i].time;
+			state.size = parsed[i].size;
+			if (sameContents) {
 				continue;
 			}
-			catch (const std::exception& e) {
-				logger::error("Caught unhandled exception {} while reading files.", e.what());
+			state.hash = parsed[i].hash;
+			stale.insert(path);
+			changed.push_back(i);
+		}
+
+		const std::unordered_set<std::string_view> present(paths.begin(), paths.end());
+		size_t removed = 0;
+		for (auto it = fileStates.begin(); it != fileStates.end();) {
+			if (present.contains(it->first)) {
+				++it;
 				continue;
 			}
+			stale.insert(it->first);
+			it = fileStates.erase(it);
+			++removed;
+		}
 
-			if (!JSONFile.isObject()) {
+		if (stale.empty()) {
+			return fmt::format("No changes in {} config files.", paths.size());
+		}
+
+		//Only the changed files are resolved. The indexes are rebuilt from the already resolved rules and
+		//swapped in as a whole, containers being processed right now finish with the old ones.
+		auto* manager = Hooks::ContainerManager::GetSingleton();
+		manager->RemoveSources(stale);
+		FormResolver resolver{};
+		for (const auto i : changed) {
+			auto& path = paths[candidates[i]];
+			auto& parsedFile = parsed[i];
+			if (!parsedFile.error.empty()) {
+				logger::warn("{}", parsedFile.error);
+				continue;
+			}
+			if (parsedFile.config.rootType != Config::ValueType::kObject) {
 				logger::warn("<{}> is not an object. File will be ignored.", path);
 				continue;
 			}
+			ReadConfig(parsedFile.config, path, resolver);
+			parsedFile.config = {};
+		}
+		manager->SortAndCompact(paths);
+		manager->Optimize();
+		manager->Compile();
 
-			ReadConfig(JSONFile, path);
+		std::vector<uint64_t> configHashes{};
+		for (const auto& path : paths) {
+			configHashes.push_back(fileStates[path].hash);
 		}
+		WriteCache(configHashes);
+
+		const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+		const auto message = fmt::format("Reloaded {} changed, {} removed of {} config files in {:.1f} ms.", changed.size(), removed, paths.size(), duration.count());
+		logger::info("{}", message);
+		return message;
 	}
 }
\ No newline at end of file
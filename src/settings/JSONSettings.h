@@ -4,6 +4,14 @@ namespace Settings
 {
 	namespace JSON
 	{
+		//Finds, maps and decodes the config files on a background thread. Doesn't need game data, so it
+		//runs while the game loads its plugins.
+		void BeginRead();
+		//Waits for BeginRead (or does its work here if it wasn't started), then resolves forms and
+		//registers rules. Needs kDataLoaded.
 		void Read();
+		//Re-reads the configs that changed since they were last read and swaps in the new rules. Returns
+		//a summary for the console.
+		std::string Reload();
 	}
 }
\ No newline at end of file
@@ -0,0 +1,458 @@
+#pragma once
+
+#include "configDecoder.h"
+#include "utilities/stringUtilities.h"
+
+#include <fmt/format.h>
+
+//Turns decoded config records into rules. Game independent: forms come from a resolver and messages go
+//to a report callback, so the plugin and the offline linter in devtools run the exact same checks.
+//A resolver provides nullable handle types and the lookups that fill them:
+//  Item, Container, Location, Worldspace, Keyword, Global, Quest
+//  bool HasMod(name)
+//  ResolveItem/ResolveContainer/ResolveLocation/ResolveWorldspace/ResolveKeyword(form string)
+//  FindKeyword/FindGlobal/FindQuest(editor ID)
+namespace Settings::Config
+{
+	enum class Severity : uint8_t
+	{
+		kInfo,
+		kWarning
+	};
+
+	template <class Resolver>
+	struct CompiledRule
+	{
+		using Item = typename Resolver::Item;
+		using Keyword = typename Resolver::Keyword;
+
+		struct Skill
+		{
+			std::string_view name;
+			float level;
+			bool inverted;
+		};
+
+		template <class T>
+		struct FormSet
+		{
+			std::vector<T> forms;
+			bool inverted;
+		};
+
+		struct Global
+		{
+			typename Resolver::Global global;
+			float value;
+			bool inverted;
+		};
+
+		struct Quest
+		{
+			typename Resolver::Quest quest;
+			std::vector<uint16_t> stages;
+			bool completed;
+			bool inverted;
+		};
+
+		struct References
+		{
+			std::vector<uint32_t> ids;
+			bool inverted;
+		};
+
+		//Presence matters, an empty add list still makes a rule an add rule.
+		struct Change
+		{
+			std::optional<std::vector<Item>> add;
+			Item remove{};
+			std::optional<std::vector<Keyword>> removeKeywords;
+			std::optional<uint32_t> count;
+		};
+
+		std::string_view friendlyName;
+		bool bypassUnsafeContainers{ false };
+		bool allowVendors{ false };
+		bool onlyVendors{ false };
+		bool randomAdd{ false };
+
+		std::vector<Skill> skills;
+		std::vector<FormSet<typename Resolver::Container>> containers;
+		std::vector<Global> globals;
+		std::vector<FormSet<typename Resolver::Location>> locations;
+		std::vector<FormSet<Keyword>> locationKeywords;
+		std::vector<Quest> quests;
+		std::vector<References> references;
+		std::vector<FormSet<typename Resolver::Worldspace>> worldspaces;
+
+		std::vector<Change> changes;
+	};
+
+	template <class Resolver, class Report>
+	class RuleCompiler
+	{
+	public:
+		using Rule = CompiledRule<Resolver>;
+
+		RuleCompiler(const std::string& a_path, Resolver& a_resolver, Report& a_report) :
+			path(a_path),
+			resolver(a_resolver),
+			report(a_report)
+		{}
+
+		//Calls a_onRule for every rule that survives. A malformed rule header stops the file, like the
+		//plugin always did; a malformed change only drops that change.
+		template <class Callback>
+		void Compile(ConfigFile& a_config, Callback&& a_onRule)
+		{
+			if (a_config.rulesType != ValueType::kArray) return;
+
+			for (auto& data : a_config.rules) {
+				friendlyName = data.friendlyName.text;
+				if (!data.friendlyName || !data.friendlyName.IsString()) {
+					Warn("Config <{}> is missing friendly name, or friendly name is not a string.", path);
+					return;
+				}
+				if (data.changesType != ValueType::kArray) {
+					Warn("Config <{}>/[{}] is either missing the changes field, or it is not an array.", path, friendlyName);
+					return;
+				}
+
+				Rule rule{};
+				rule.friendlyName = friendlyName;
+				if (data.conditions && !ReadConditions(data.conditions, rule)) {
+					return;
+				}
+				ReadChanges(data.changes, rule);
+				a_onRule(rule);
+			}
+		}
+
+	private:
+		template <class... Args>
+		void Info(fmt::format_string<Args...> a_format, Args&&... a_args)
+		{
+			report(Severity::kInfo, fmt::format(a_format, std::forward<Args>(a_args)...));
+		}
+
+		template <class... Args>
+		void Warn(fmt::format_string<Args...> a_format, Args&&... a_args)
+		{
+			report(Severity::kWarning, fmt::format(a_format, std::forward<Args>(a_args)...));
+		}
+
+		bool ReadFlag(const Scalar& a_field, std::string_view a_name, bool& a_target)
+		{
+			if (!a_field) {
+				return true;
+			}
+			if (!a_field.IsBool()) {
+				Warn("Config <{}>/[{}] has {} specified, but it is not a bool value. Config will be ignored.", path, friendlyName, a_name);
+				return false;
+			}
+			a_target = a_field.AsBool();
+			return true;
+		}
+
+		bool ReadConditions(const ConditionsRecord& a_conditions, Rule& a_rule)
+		{
+			//Plugins Check
+			auto& plugins = a_conditions.plugins;
+			if (plugins) {
+				if (!plugins.IsArray()) {
+					Warn("Config <{}>/[{}] has plugins specified, but plugins are not an array. Config will be ignored.", path, friendlyName);
+					return false;
+				}
+
+				for (auto& plugin : plugins.elements) {
+					if (!plugin.IsString()) {
+						Warn("Config <{}>/[{}] has plugins specified, and a plugin is not a string. Config will be ignored.", path, friendlyName);
+						return false;
+					}
+
+					if (!resolver.HasMod(plugin.text)) {
+						Info("Note that config <{}>/[{}] requires mod {} to work, which is not present.", path, friendlyName, plugin.text);
+						return false;
+					}
+				}
+			} // End of plugins
+
+			bool onlyVendors = false;
+			if (!ReadFlag(a_conditions.bypassUnsafeContainers, "bypassUnsafeContainers", a_rule.bypassUnsafeContainers) ||
+				!ReadFlag(a_conditions.allowVendors, "allowVendors", a_rule.allowVendors) ||
+				!ReadFlag(a_conditions.onlyVendors, "onlyVendors", onlyVendors) ||
+				!ReadFlag(a_conditions.randomAdd, "randomAdd", a_rule.randomAdd)) {
+				return false;
+			}
+			//onlyVendors implies allowVendors.
+			if (onlyVendors) {
+				a_rule.allowVendors = true;
+				a_rule.onlyVendors = true;
+			}
+
+			//Malformed condition lists below are reported and skipped, the rule itself is kept.
+			ReadForms(a_conditions.containers, false, "containers", "container", a_rule.containers, [&](std::string_view a_id) { return resolver.ResolveContainer(a_id); });
+			ReadForms(a_conditions.notContainers, true, "containers", "container", a_rule.containers, [&](std::string_view a_id) { return resolver.ResolveContainer(a_id); });
+			ReadForms(a_conditions.locations, false, "locations", "location", a_rule.locations, [&](std::string_view a_id) { return resolver.ResolveLocation(a_id); });
+			ReadForms(a_conditions.notLocations, true, "locations", "location", a_rule.locations, [&](std::string_view a_id) { return resolver.ResolveLocation(a_id); });
+			ReadForms(a_conditions.worldspaces, false, "worldspaces", "worldspaces", a_rule.worldspaces, [&](std::string_view a_id) { return resolver.ResolveWorldspace(a_id); });
+			ReadForms(a_conditions.notWorldspaces, true, "worldspaces", "worldspaces", a_rule.worldspaces, [&](std::string_view a_id) { return resolver.ResolveWorldspace(a_id); });
+			ReadForms(a_conditions.locationKeywords, false, "locationKeywords", "keyword", a_rule.locationKeywords, [&](std::string_view a_id) { return resolver.FindKeyword(a_id); });
+			ReadForms(a_conditions.notLocationKeywords, true, "locationKeywords", "keyword", a_rule.locationKeywords, [&](std::string_view a_id) { return resolver.FindKeyword(a_id); });
+			ReadSkills(a_conditions.playerSkills, false, a_rule.skills);
+			ReadSkills(a_conditions.notPlayerSkills, true, a_rule.skills);
+			ReadGlobals(a_conditions.globals, false, a_rule.globals);
+			ReadGlobals(a_conditions.notGlobals, true, a_rule.globals);
+			ReadQuest(a_conditions.questConditions, false, a_rule.quests);
+			ReadReferences(a_conditions.references, false, a_rule.references);
+			ReadReferences(a_conditions.notReferences, true, a_rule.references);
+			return true;
+		}
+
+		template <class Set, class Lookup>
+		void ReadForms(const List& a_data, bool a_inverted, std::string_view a_field, std::string_view a_kind, std::vector<Set>& a_target, Lookup&& a_lookup)
+		{
+			if (!a_data) {
+				return;
+			}
+			if (!a_data.IsArray()) {
+				Warn("Config <{}>/[{}] has {} specified, but it is not an array value. Config will be ignored.", path, friendlyName, a_field);
+				return;
+			}
+
+			decltype(Set::forms) forms{};
+			for (auto& identifier : a_data.elements) {
+				if (!identifier.IsString()) {
+					Warn("Config <{}>/[{}] has {} specified, but an element is not a string. Config will be ignored.", path, friendlyName, a_field);
+					return;
+				}
+
+				const auto form = a_lookup(identifier.text);
+				if (!form) {
+					Info("Config <{}>/[{}] requires {} {}, but it is not present. This is not fatal.", path, friendlyName, a_kind, identifier.text);
+					continue;
+				}
+				forms.push_back(form);
+			}
+			a_target.push_back({ std::move(forms), a_inverted });
+		}
+
+		void ReadSkills(const List& a_data, bool a_inverted, std::vector<typename Rule::Skill>& a_target)
+		{
+			if (!a_data) {
+				return;
+			}
+			if (!a_data.IsArray()) {
+				Warn("Config <{}>/[{}] has playerSkills specified, but it is not an array value. Config will be ignored.", path, friendlyName);
+				return;
+			}
+
+			std::vector<typename Rule::Skill> skills{};
+			for (auto& identifier : a_data.elements) {
+				if (!identifier.IsString()) {
+					Warn("Config <{}>/[{}] has playerSkills specified, but an element is not a string. Config will be ignored.", path, friendlyName);
+					return;
+				}
+
+				const auto components = Utilities::String::split<2>(identifier.text, "|");
+				const auto requiredLevel = components.count == 2 ? Utilities::String::to_num<float>(components.parts[1]) : std::nullopt;
+				if (!requiredLevel) {
+					Warn("Config <{}>/[{}] has playerSkills specified, but an element ({}) is not formatted correctly (Skill|Level). Config will be ignored.", path, friendlyName, identifier.text);
+					return;
+				}
+				if (*requiredLevel < 0.0f) {
+					Warn("Don't use negative valued for playerSkills.");
+				}
+				skills.push_back({ components.parts[0], *requiredLevel, a_inverted });
+			}
+			a_target.insert(a_target.end(), skills.begin(), skills.end());
+		}
+
+		void ReadGlobals(const List& a_data, bool a_inverted, std::vector<typename Rule::Global>& a_target)
+		{
+			if (!a_data) {
+				return;
+			}
+			if (!a_data.IsArray()) {
+				Warn("Config <{}>/[{}] has globals specified, but it is not an array value. Config will be ignored.", path, friendlyName);
+				return;
+			}
+
+			std::vector<typename Rule::Global> globals{};
+			for (auto& identifier : a_data.elements) {
+				if (!identifier.IsString()) {
+					Warn("Config <{}>/[{}] has globals specified, but an element is not a string. Config will be ignored.", path, friendlyName);
+					return;
+				}
+
+				const auto components = Utilities::String::split<2>(identifier.text, "|");
+				if (components.count != 2) {
+					Warn("Config <{}>/[{}] has globals specified, but an element ({}) is not formatted correctly (Global|Value). Config will be ignored.", path, friendlyName, identifier.text);
+					return;
+				}
+
+				const auto global = resolver.FindGlobal(components.parts[0]);
+				if (!global) {
+					Info("Config <{}>/[{}] requires global {}, but it is not present. This is not fatal.", path, friendlyName, identifier.text);
+					continue;
+				}
+
+				const auto globalValue = Utilities::String::to_num<float>(components.parts[1]);
+				if (!globalValue) {
+					Warn("Config <{}>/[{}] has globals specified, but an element ({}) is not formatted correctly (Global|Value). Config will be ignored.", path, friendlyName, identifier.text);
+					return;
+				}
+				if (*globalValue < 0.0f) {
+					Warn("Don't use negative valued for globals.");
+				}
+				globals.push_back({ global, *globalValue, a_inverted });
+			}
+			a_target.insert(a_target.end(), globals.begin(), globals.end());
+		}
+
+		void ReadQuest(const QuestRecord& a_data, bool a_inverted, std::vector<typename Rule::Quest>& a_target)
+		{
+			if (!a_data) {
+				return;
+			}
+			if (!a_data.IsObject()) {
+				Warn("Config <{}>/[{}] has questConditions specified, but it is not an object value. Config will be ignored.", path, friendlyName);
+				return;
+			}
+
+			if (!a_data.questID || !a_data.questID.IsString()) {
+				Warn("Config <{}>/[{}] has questConditions specified, but an element is missing questID (or it is not a string).", path, friendlyName);
+				return;
+			}
+
+			if (!(a_data.stageDone || a_data.completed)) {
+				Warn("Config <{}>/[{}] has questConditions specified, but is missing the actual condition (stagedone/completed).", path, friendlyName);
+				return;
+			}
+
+			const auto quest = resolver.FindQuest(a_data.questID.text);
+			if (!quest) {
+				Info("Config <{}>/[{}] requires quest {}, but it is not present. This is not fatal.", path, friendlyName, a_data.questID.text);
+				return;
+			}
+
+			bool completed = a_data.completed && a_data.completed.IsBool() ? a_data.completed.AsBool() : true;
+			std::vector<uint16_t> completedStages{};
+			if (a_data.stageDone && a_data.stageDone.IsArray()) {
+				for (const auto& field : a_data.stageDone.elements) {
+					if (!field.IsUInt()) {
+						Warn("Config <{}>/[{}] requires quest {}, but at least one stage specified is not a number, config will be ignored.", path, friendlyName, a_data.questID.text);
+						return;
+					}
+					completedStages.push_back(static_cast<uint16_t>(field.AsUInt()));
+				}
+			}
+			a_target.push_back({ quest, std::move(completedStages), completed, a_inverted });
+		}
+
+		void ReadReferences(const List& a_data, bool a_inverted, std::vector<typename Rule::References>& a_target)
+		{
+			if (!a_data) {
+				return;
+			}
+			if (!a_data.IsArray()) {
+				Warn("Config <{}>/[{}] has references specified, but it is not an array value. Config will be ignored.", path, friendlyName);
+				return;
+			}
+
+			std::vector<uint32_t> ids{};
+			for (auto& identifier : a_data.elements) {
+				if (!identifier.IsString()) {
+					Warn("Config <{}>/[{}] has references specified, but an element is not a string. Config will be ignored.", path, friendlyName);
+					return;
+				}
+
+				const auto id = Utilities::String::to_num<uint32_t>(identifier.text, true);
+				if (!id) {
+					Warn("Config <{}>/[{}] has references specified, but an element ({}) is not a hex FormID. Config will be ignored.", path, friendlyName, identifier.text);
+					return;
+				}
+				ids.push_back(*id);
+			}
+			a_target.push_back({ std::move(ids), a_inverted });
+		}
+
+		template <class T, class Lookup>
+		bool ReadFormList(const List& a_data, std::string_view a_field, std::vector<T>& a_target, Lookup&& a_lookup)
+		{
+			if (!a_data.IsArray()) {
+				Warn("config <{}>/[{}], rule has invalid {} data.", path, friendlyName, a_field);
+				return false;
+			}
+
+			for (const auto& entry : a_data.elements) {
+				if (!entry.IsString()) {
+					Warn("Config <{}>/[{}] contains invalid {} data.", path, friendlyName, a_field);
+					return false;
+				}
+
+				const auto form = a_lookup(entry.text);
+				if (!form) {
+					Warn("Config <{}>/[{}] contains invalid {} data - missing form {}.", path, friendlyName, a_field, entry.text);
+					return false;
+				}
+				a_target.push_back(form);
+			}
+			return true;
+		}
+
+		void ReadChanges(const std::vector<ChangeRecord>& a_changes, Rule& a_rule)
+		{
+			for (auto& change : a_changes) {
+				const auto& add = change.add;
+				const auto& remove = change.remove;
+				const auto& removeKeywords = change.removeByKeywords;
+				const auto& count = change.count;
+				if (!add && !remove && !removeKeywords && !count) {
+					Warn("No changes detected, was this meant?");
+					continue;
+				}
+
+				typename Rule::Change resolved{};
+				if (count) {
+					if (!count.IsUInt()) {
+						Warn("Config <{}>/[{}], rule has invalid count.", path, friendlyName);
+						continue;
+					}
+					resolved.count = count.AsUInt();
+				}
+				if (remove) {
+					if (!remove.IsString()) {
+						Warn("config <{}>/[{}], rule has invalid remove data.", path, friendlyName);
+						continue;
+					}
+
+					resolved.remove = resolver.ResolveItem(remove.text);
+					if (!resolved.remove) {
+						Warn("Config <{}>/[{}] contains invalid remove data - missing form {}.", path, friendlyName, remove.text);
+						continue;
+					}
+				}
+				if (add && !ReadFormList(add, "add", resolved.add.emplace(), [&](std::string_view a_id) { return resolver.ResolveItem(a_id); })) {
+					continue;
+				}
+				if (removeKeywords && !ReadFormList(removeKeywords, "removeKeywords", resolved.removeKeywords.emplace(), [&](std::string_view a_id) { return resolver.ResolveKeyword(a_id); })) {
+					continue;
+				}
+				a_rule.changes.push_back(std::move(resolved));
+			}
+		}
+
+		const std::string& path;
+		Resolver& resolver;
+		Report& report;
+		std::string_view friendlyName;
+	};
+
+	template <class Resolver, class Report, class Callback>
+	void CompileRules(ConfigFile& a_config, const std::string& a_path, Resolver& a_resolver, Report&& a_report, Callback&& a_onRule)
+	{
+		RuleCompiler<Resolver, std::remove_reference_t<Report>> compiler{ a_path, a_resolver, a_report };
+		compiler.Compile(a_config, std::forward<Callback>(a_onRule));
+	}
+}
\ No newline at end of file
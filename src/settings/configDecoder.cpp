@@ -0,0 +1,498 @@
+#include "configDecoder.h"
+
+#include <charconv>
+#include <cmath>
+#include <limits>
+
+namespace Settings::Config
+{
+	namespace
+	{
+		using namespace std::literals;
+
+		constexpr size_t maxDepth = 1000;
+
+		class Parser
+		{
+		public:
+			Parser(std::string_view a_buffer, ConfigFile& a_file) :
+				begin(a_buffer.data()),
+				cur(a_buffer.data()),
+				end(a_buffer.data() + a_buffer.size()),
+				file(a_file)
+			{
+				//UTF-8 BOM
+				if (a_buffer.starts_with("\xEF\xBB\xBF")) {
+					cur += 3;
+				}
+			}
+
+			bool ParseRoot()
+			{
+				SkipWhitespace();
+				file.rootType = Peek();
+				if (file.rootType != ValueType::kObject) {
+					return SkipValue(0);
+				}
+				return ParseObject([&](std::string_view a_key) {
+					if (a_key == "rules") {
+						file.rulesType = Peek();
+						if (file.rulesType != ValueType::kArray) {
+							return SkipValue(1);
+						}
+						return ParseArray([&]() {
+							auto& rule = file.rules.emplace_back();
+							if (Peek() != ValueType::kObject) {
+								//Matches jsoncpp, where every field of a non object reads as null.
+								return SkipValue(2);
+							}
+							return ParseRule(rule);
+						});
+					}
+					return SkipValue(1);
+				});
+			}
+
+			std::string GetError() const
+			{
+				size_t line = 1;
+				size_t column = 1;
+				for (auto* it = begin; it < errorAt && it < end; ++it) {
+					if (*it == '\n') {
+						++line;
+						column = 1;
+					}
+					else {
+						++column;
+					}
+				}
+				return "Line " + std::to_string(line) + ", Column " + std::to_string(column) + ": " + error;
+			}
+
+		private:
+			bool Fail(const char* a_message)
+			{
+				if (error.empty()) {
+					error = a_message;
+					errorAt = cur;
+				}
+				return false;
+			}
+
+			void SkipWhitespace()
+			{
+				while (cur < end) {
+					const char c = *cur;
+					if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+						++cur;
+					}
+					else if (c == '/' && cur + 1 < end && cur[1] == '/') {
+						while (cur < end && *cur != '\n') ++cur;
+					}
+					else if (c == '/' && cur + 1 < end && cur[1] == '*') {
+						cur += 2;
+						while (cur + 1 < end && !(cur[0] == '*' && cur[1] == '/')) ++cur;
+						cur = cur + 1 < end ? cur + 2 : end;
+					}
+					else {
+						break;
+					}
+				}
+			}
+
+			ValueType Peek()
+			{
+				SkipWhitespace();
+				if (cur >= end) return ValueType::kMissing;
+				switch (*cur) {
+				case '{':
+					return ValueType::kObject;
+				case '[':
+					return ValueType::kArray;
+				case '"':
+					return ValueType::kString;
+				case 't':
+				case 'f':
+					return ValueType::kBool;
+				case 'n':
+					return ValueType::kNull;
+				default:
+					return (*cur == '-' || (*cur >= '0' && *cur <= '9')) ? ValueType::kNumber : ValueType::kMissing;
+				}
+			}
+
+			bool Consume(char a_expected)
+			{
+				SkipWhitespace();
+				if (cur < end && *cur == a_expected) {
+					++cur;
+					return true;
+				}
+				return false;
+			}
+
+			bool ParseLiteral(std::string_view a_literal, std::string_view& a_out)
+			{
+				if (std::string_view(cur, static_cast<size_t>(end - cur)).starts_with(a_literal)) {
+					a_out = std::string_view(cur, a_literal.size());
+					cur += a_literal.size();
+					return true;
+				}
+				return Fail("Syntax error: value, object or array expected.");
+			}
+
+			bool ParseNumber(std::string_view& a_out)
+			{
+				const char* start = cur;
+				if (cur < end && *cur == '-') ++cur;
+				const char* digits = cur;
+				while (cur < end && *cur >= '0' && *cur <= '9') ++cur;
+				if (cur == digits) return Fail("Syntax error: value, object or array expected.");
+				if (cur < end && *cur == '.') {
+					++cur;
+					while (cur < end && *cur >= '0' && *cur <= '9') ++cur;
+				}
+				if (cur < end && (*cur == 'e' || *cur == 'E')) {
+					++cur;
+					if (cur < end && (*cur == '+' || *cur == '-')) ++cur;
+					while (cur < end && *cur >= '0' && *cur <= '9') ++cur;
+				}
+				a_out = std::string_view(start, static_cast<size_t>(cur - start));
+				return true;
+			}
+
+			static void AppendUTF8(std::string& a_out, uint32_t a_codePoint)
+			{
+				if (a_codePoint < 0x80) {
+					a_out.push_back(static_cast<char>(a_codePoint));
+				}
+				else if (a_codePoint < 0x800) {
+					a_out.push_back(static_cast<char>(0xC0 | (a_codePoint >> 6)));
+					a_out.push_back(static_cast<char>(0x80 | (a_codePoint & 0x3F)));
+				}
+				else if (a_codePoint < 0x10000) {
+					a_out.push_back(static_cast<char>(0xE0 | (a_codePoint >> 12)));
+					a_out.push_back(static_cast<char>(0x80 | ((a_codePoint >> 6) & 0x3F)));
+					a_out.push_back(static_cast<char>(0x80 | (a_codePoint & 0x3F)));
+				}
+				else {
+					a_out.push_back(static_cast<char>(0xF0 | (a_codePoint >> 18)));
+					a_out.push_back(static_cast<char>(0x80 | ((a_codePoint >> 12) & 0x3F)));
+					a_out.push_back(static_cast<char>(0x80 | ((a_codePoint >> 6) & 0x3F)));
+					a_out.push_back(static_cast<char>(0x80 | (a_codePoint & 0x3F)));
+				}
+			}
+
+			bool ParseHex4(uint32_t& a_out)
+			{
+				if (end - cur < 4) return Fail("Bad unicode escape sequence in string.");
+				const auto result = std::from_chars(cur, cur + 4, a_out, 16);
+				if (result.ptr != cur + 4) return Fail("Bad unicode escape sequence in string.");
+				cur += 4;
+				return true;
+			}
+
+			//Expects cur on the opening quote. The common case, no escapes, is a view into the buffer.
+			bool ParseString(std::string_view& a_out)
+			{
+				++cur;
+				const char* start = cur;
+				while (cur < end && *cur != '"' && *cur != '\\') ++cur;
+				if (cur >= end) return Fail("Missing '\"' to close the string.");
+				if (*cur == '"') {
+					a_out = std::string_view(start, static_cast<size_t>(cur - start));
+					++cur;
+					return true;
+				}
+
+				auto& buffer = file.unescaped.emplace_back(start, static_cast<size_t>(cur - start));
+				while (cur < end && *cur != '"') {
+					if (*cur != '\\') {
+						buffer.push_back(*cur++);
+						continue;
+					}
+					if (++cur >= end) break;
+					switch (*cur++) {
+					case '"':
+						buffer.push_back('"');
+						break;
+					case '\\':
+						buffer.push_back('\\');
+						break;
+					case '/':
+						buffer.push_back('/');
+						break;
+					case 'b':
+						buffer.push_back('\b');
+						break;
+					case 'f':
+						buffer.push_back('\f');
+						break;
+					case 'n':
+						buffer.push_back('\n');
+						break;
+					case 'r':
+						buffer.push_back('\r');
+						break;
+					case 't':
+						buffer.push_back('\t');
+						break;
+					case 'u':
+					{
+						uint32_t codePoint = 0;
+						if (!ParseHex4(codePoint)) return false;
+						if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+							uint32_t low = 0;
+							if (end - cur < 2 || cur[0] != '\\' || cur[1] != 'u') return Fail("Expecting another \\u token to begin the second half of a unicode surrogate pair.");
+							cur += 2;
+							if (!ParseHex4(low)) return false;
+							codePoint = 0x10000 + ((codePoint & 0x3FF) << 10) + (low & 0x3FF);
+						}
+						AppendUTF8(buffer, codePoint);
+						break;
+					}
+					default:
+						return Fail("Bad escape sequence in string.");
+					}
+				}
+				if (cur >= end) return Fail("Missing '\"' to close the string.");
+				++cur;
+				a_out = buffer;
+				return true;
+			}
+
+			//Calls a_onKey(key) for every member. a_onKey must consume the value.
+			template <class F>
+			bool ParseObject(F&& a_onKey)
+			{
+				if (!Consume('{')) return Fail("Missing '{' to open the object.");
+				if (Consume('}')) return true;
+				while (true) {
+					SkipWhitespace();
+					if (cur < end && *cur == '}') {
+						//Trailing comma.
+						++cur;
+						return true;
+					}
+					if (cur >= end || *cur != '"') return Fail("Missing '}' or object member name.");
+					std::string_view key;
+					if (!ParseString(key)) return false;
+					if (!Consume(':')) return Fail("Missing ':' after object member name.");
+					SkipWhitespace();
+					if (!a_onKey(key)) return false;
+					if (Consume(',')) continue;
+					if (Consume('}')) return true;
+					return Fail("Missing ',' or '}' in object declaration.");
+				}
+			}
+
+			template <class F>
+			bool ParseArray(F&& a_onElement)
+			{
+				if (!Consume('[')) return Fail("Missing '[' to open the array.");
+				if (Consume(']')) return true;
+				while (true) {
+					SkipWhitespace();
+					if (cur < end && *cur == ']') {
+						++cur;
+						return true;
+					}
+					if (!a_onElement()) return false;
+					if (Consume(',')) continue;
+					if (Consume(']')) return true;
+					return Fail("Missing ',' or ']' in array declaration.");
+				}
+			}
+
+			bool SkipValue(size_t a_depth)
+			{
+				if (a_depth > maxDepth) return Fail("Exceeded stack limit while parsing.");
+				std::string_view ignored;
+				switch (Peek()) {
+				case ValueType::kObject:
+					return ParseObject([&](std::string_view) { return SkipValue(a_depth + 1); });
+				case ValueType::kArray:
+					return ParseArray([&]() { return SkipValue(a_depth + 1); });
+				case ValueType::kString:
+					return ParseString(ignored);
+				case ValueType::kBool:
+					return ParseLiteral(*cur == 't' ? "true"sv : "false"sv, ignored);
+				case ValueType::kNull:
+					return ParseLiteral("null"sv, ignored);
+				case ValueType::kNumber:
+					return ParseNumber(ignored);
+				default:
+					return Fail("Syntax error: value, object or array expected.");
+				}
+			}
+
+			bool ParseScalar(Scalar& a_out, size_t a_depth)
+			{
+				a_out.type = Peek();
+				a_out.text = {};
+				switch (a_out.type) {
+				case ValueType::kString:
+					return ParseString(a_out.text);
+				case ValueType::kBool:
+					return ParseLiteral(*cur == 't' ? "true"sv : "false"sv, a_out.text);
+				case ValueType::kNumber:
+					return ParseNumber(a_out.text);
+				default:
+					return SkipValue(a_depth);
+				}
+			}
+
+			bool ParseList(List& a_out, size_t a_depth)
+			{
+				a_out.type = Peek();
+				a_out.elements.clear();
+				if (a_out.type != ValueType::kArray) {
+					return SkipValue(a_depth);
+				}
+				return ParseArray([&]() { return ParseScalar(a_out.elements.emplace_back(), a_depth + 1); });
+			}
+
+			bool ParseQuest(QuestRecord& a_out, size_t a_depth)
+			{
+				a_out = {};
+				a_out.type = Peek();
+				if (a_out.type != ValueType::kObject) {
+					return SkipValue(a_depth);
+				}
+				return ParseObject([&](std::string_view a_key) {
+					if (a_key == "questID") return ParseScalar(a_out.questID, a_depth + 1);
+					if (a_key == "stageDone") return ParseList(a_out.stageDone, a_depth + 1);
+					if (a_key == "completed") return ParseScalar(a_out.completed, a_depth + 1);
+					return SkipValue(a_depth + 1);
+				});
+			}
+
+			bool ParseConditions(ConditionsRecord& a_out, size_t a_depth)
+			{
+				a_out = {};
+				a_out.type = Peek();
+				if (a_out.type != ValueType::kObject) {
+					return SkipValue(a_depth);
+				}
+				const auto next = a_depth + 1;
+				return ParseObject([&](std::string_view a_key) {
+					if (a_key == "plugins") return ParseList(a_out.plugins, next);
+					if (a_key == "bypassUnsafeContainers") return ParseScalar(a_out.bypassUnsafeContainers, next);
+					if (a_key == "allowVendors") return ParseScalar(a_out.allowVendors, next);
+					if (a_key == "onlyVendors") return ParseScalar(a_out.onlyVendors, next);
+					if (a_key == "randomAdd") return ParseScalar(a_out.randomAdd, next);
+					if (a_key == "containers") return ParseList(a_out.containers, next);
+					if (a_key == "!containers") return ParseList(a_out.notContainers, next);
+					if (a_key == "locations") return ParseList(a_out.locations, next);
+					if (a_key == "!locations") return ParseList(a_out.notLocations, next);
+					if (a_key == "worldspaces") return ParseList(a_out.worldspaces, next);
+					if (a_key == "!worldspaces") return ParseList(a_out.notWorldspaces, next);
+					if (a_key == "locationKeywords") return ParseList(a_out.locationKeywords, next);
+					if (a_key == "!locationKeywords") return ParseList(a_out.notLocationKeywords, next);
+					if (a_key == "playerSkills") return ParseList(a_out.playerSkills, next);
+					if (a_key == "!playerSkills") return ParseList(a_out.notPlayerSkills, next);
+					if (a_key == "globals") return ParseList(a_out.globals, next);
+					if (a_key == "!globals") return ParseList(a_out.notGlobals, next);
+					if (a_key == "questConditions") return ParseQuest(a_out.questConditions, next);
+					if (a_key == "references") return ParseList(a_out.references, next);
+					if (a_key == "!references") return ParseList(a_out.notReferences, next);
+					return SkipValue(next);
+				});
+			}
+
+			bool ParseChange(ChangeRecord& a_out, size_t a_depth)
+			{
+				const auto next = a_depth + 1;
+				return ParseObject([&](std::string_view a_key) {
+					if (a_key == "add") return ParseList(a_out.add, next);
+					if (a_key == "remove") return ParseScalar(a_out.remove, next);
+					if (a_key == "removeByKeywords") return ParseList(a_out.removeByKeywords, next);
+					if (a_key == "count") return ParseScalar(a_out.count, next);
+					return SkipValue(next);
+				});
+			}
+
+			bool ParseRule(RuleRecord& a_out)
+			{
+				constexpr size_t depth = 3;
+				return ParseObject([&](std::string_view a_key) {
+					if (a_key == "friendlyName") return ParseScalar(a_out.friendlyName, depth);
+					if (a_key == "conditions") return ParseConditions(a_out.conditions, depth);
+					if (a_key == "changes") {
+						a_out.changesType = Peek();
+						a_out.changes.clear();
+						if (a_out.changesType != ValueType::kArray) {
+							return SkipValue(depth);
+						}
+						return ParseArray([&]() {
+							auto& change = a_out.changes.emplace_back();
+							if (Peek() != ValueType::kObject) {
+								return SkipValue(depth + 1);
+							}
+							return ParseChange(change, depth + 1);
+						});
+					}
+					return SkipValue(depth);
+				});
+			}
+
+			const char* begin;
+			const char* cur;
+			const char* end;
+			const char* errorAt{ nullptr };
+			std::string error;
+			ConfigFile& file;
+		};
+	}
+
+	bool Scalar::IsUInt() const
+	{
+		if (type != ValueType::kNumber) return false;
+
+		uint64_t integral = 0;
+		const auto* first = text.data();
+		const auto* last = text.data() + text.size();
+		if (const auto result = std::from_chars(first, last, integral); result.ec == std::errc() && result.ptr == last) {
+			return integral <= std::numeric_limits<uint32_t>::max();
+		}
+
+		//Fractions and exponents count as long as the value is integral, like jsoncpp.
+		double real = 0.0;
+		if (const auto result = std::from_chars(first, last, real); result.ec == std::errc() && result.ptr == last) {
+			return real >= 0.0 && real <= std::numeric_limits<uint32_t>::max() && std::floor(real) == real;
+		}
+		return false;
+	}
+
+	uint32_t Scalar::AsUInt() const
+	{
+		if (!IsUInt()) return 0;
+
+		uint32_t integral = 0;
+		const auto* last = text.data() + text.size();
+		if (const auto result = std::from_chars(text.data(), last, integral); result.ec == std::errc() && result.ptr == last) {
+			return integral;
+		}
+		double real = 0.0;
+		std::from_chars(text.data(), last, real);
+		return static_cast<uint32_t>(real);
+	}
+
+	bool Decode(std::string_view a_buffer, const std::string& a_name, ConfigFile& a_file, std::string& a_error)
+	{
+		Parser parser{ a_buffer, a_file };
+		if (!parser.ParseRoot()) {
+			a_error = "<" + a_name + "> is not valid JSON. File will be ignored. Error: " + parser.GetError();
+			return false;
+		}
+		return true;
+	}
+
+	bool Decode(const std::string& a_path, ConfigFile& a_file, std::string& a_error)
+	{
+		if (!a_file.mapping.Open(a_path, a_error)) {
+			return false;
+		}
+		return Decode(a_file.mapping.GetView(), a_path, a_file, a_error);
+	}
+}
\ No newline at end of file
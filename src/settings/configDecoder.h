@@ -0,0 +1,123 @@
+#pragma once
+
+#include "mappedFile.h"
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//Single pass decoder for the config schema. Game independent (no RE/SKSE), so devtools can build it.
+//The file is memory mapped and walked once; known keys are written straight into the records below and
+//everything else is skipped. Strings are views into the mapping, only strings with escapes are copied.
+//Fields keep the JSON kind they were written with, so the reader can still complain about wrong types.
+namespace Settings::Config
+{
+	enum class ValueType : uint8_t
+	{
+		kMissing,
+		kNull,
+		kBool,
+		kNumber,
+		kString,
+		kArray,
+		kObject
+	};
+
+	struct Scalar
+	{
+		//Same meaning as a present, non null Json::Value.
+		explicit operator bool() const { return type != ValueType::kMissing && type != ValueType::kNull; }
+
+		bool IsString() const { return type == ValueType::kString; }
+		bool IsBool() const { return type == ValueType::kBool; }
+		bool AsBool() const { return type == ValueType::kBool && text == "true"; }
+		//Non negative integral number that fits in 32 bits.
+		bool IsUInt() const;
+		uint32_t AsUInt() const;
+
+		ValueType type{ ValueType::kMissing };
+		//String contents (unescaped), the number literal, or the bool literal. Empty for containers.
+		std::string_view text;
+	};
+
+	struct List
+	{
+		explicit operator bool() const { return type != ValueType::kMissing && type != ValueType::kNull; }
+		bool IsArray() const { return type == ValueType::kArray; }
+
+		ValueType type{ ValueType::kMissing };
+		//Only filled for arrays. Nested containers are recorded by type.
+		std::vector<Scalar> elements;
+	};
+
+	struct QuestRecord
+	{
+		explicit operator bool() const { return type != ValueType::kMissing && type != ValueType::kNull; }
+		bool IsObject() const { return type == ValueType::kObject; }
+
+		ValueType type{ ValueType::kMissing };
+		Scalar questID;
+		List stageDone;
+		Scalar completed;
+	};
+
+	struct ConditionsRecord
+	{
+		explicit operator bool() const { return type != ValueType::kMissing && type != ValueType::kNull; }
+
+		ValueType type{ ValueType::kMissing };
+		List plugins;
+		Scalar bypassUnsafeContainers;
+		Scalar allowVendors;
+		Scalar onlyVendors;
+		Scalar randomAdd;
+		List containers;
+		List notContainers;
+		List locations;
+		List notLocations;
+		List worldspaces;
+		List notWorldspaces;
+		List locationKeywords;
+		List notLocationKeywords;
+		List playerSkills;
+		List notPlayerSkills;
+		List globals;
+		List notGlobals;
+		QuestRecord questConditions;
+		List references;
+		List notReferences;
+	};
+
+	struct ChangeRecord
+	{
+		List add;
+		Scalar remove;
+		List removeByKeywords;
+		Scalar count;
+	};
+
+	struct RuleRecord
+	{
+		Scalar friendlyName;
+		ConditionsRecord conditions;
+		ValueType changesType{ ValueType::kMissing };
+		std::vector<ChangeRecord> changes;
+	};
+
+	struct ConfigFile
+	{
+		ValueType rootType{ ValueType::kMissing };
+		ValueType rulesType{ ValueType::kMissing };
+		std::vector<RuleRecord> rules;
+		//Views in the records point into these, keep the file alive while reading it.
+		MappedFile mapping;
+		std::deque<std::string> unescaped;
+	};
+
+	//Maps and decodes a_path. On failure a_error holds the message to log and a_file should be ignored.
+	bool Decode(const std::string& a_path, ConfigFile& a_file, std::string& a_error);
+	//Decodes a buffer that outlives a_file. a_name is only used for messages.
+	bool Decode(std::string_view a_buffer, const std::string& a_name, ConfigFile& a_file, std::string& a_error);
+}
\ No newline at end of file
@@ -0,0 +1,141 @@
+#include "formDump.h"
+
+#include "utilities/utilities.h"
+
+namespace Settings::FormDump
+{
+	namespace
+	{
+		void WriteHeader(std::ofstream& a_file, std::string_view a_tag, const RE::TESForm* a_form)
+		{
+			a_file << fmt::format("{}\t{:08X}\t{}\t", a_tag, a_form->GetFormID(), Utilities::EDID::GetEditorID(a_form));
+		}
+
+		void WriteKeywords(std::ofstream& a_file, const RE::BGSKeywordForm* a_keywords)
+		{
+			if (!a_keywords) {
+				return;
+			}
+			bool first = true;
+			for (uint32_t i = 0; i < a_keywords->numKeywords; ++i) {
+				if (const auto keyword = a_keywords->keywords[i]) {
+					a_file << fmt::format("{}{:08X}", first ? "" : ",", keyword->GetFormID());
+					first = false;
+				}
+			}
+		}
+
+		//a_filter picks the forms of a type that can be items, like lights that can be carried.
+		template <class T, class Filter = decltype([](const T*) { return true; })>
+		size_t WriteItems(std::ofstream& a_file, RE::TESDataHandler* a_dataHandler, Filter a_filter = {})
+		{
+			size_t count = 0;
+			for (const auto form : a_dataHandler->GetFormArray<T>()) {
+				if (!form || !a_filter(form)) continue;
+				WriteHeader(a_file, "ITEM"sv, form);
+				if constexpr (std::is_convertible_v<T*, RE::BGSKeywordForm*>) {
+					WriteKeywords(a_file, form);
+				}
+				a_file << '\n';
+				++count;
+			}
+			return count;
+		}
+
+		template <class T>
+		size_t WritePlain(std::ofstream& a_file, RE::TESDataHandler* a_dataHandler, std::string_view a_tag)
+		{
+			size_t count = 0;
+			for (const auto form : a_dataHandler->GetFormArray<T>()) {
+				if (!form) continue;
+				WriteHeader(a_file, a_tag, form);
+				a_file << '\n';
+				++count;
+			}
+			return count;
+		}
+	}
+
+	std::filesystem::path GetPath()
+	{
+		auto path = logger::log_directory();
+		if (!path) {
+			return {};
+		}
+		*path /= fmt::format("{}.forms"sv, Plugin::NAME);
+		return *path;
+	}
+
+	size_t Write(const std::filesystem::path& a_path, std::string& a_error)
+	{
+		auto* dataHandler = RE::TESDataHandler::GetSingleton();
+		std::ofstream file{ a_path, std::ios::trunc };
+		if (!dataHandler || !file) {
+			a_error = fmt::format("could not open {}", a_path.string());
+			return 0;
+		}
+
+		file << fmt::format("CDF form dump {}\n", version);
+		for (const auto* mod : dataHandler->files) {
+			if (mod && mod->compileIndex != 0xFF) {
+				file << fmt::format("MOD\t{:02X}\t{:03X}\t{}\n", mod->compileIndex, mod->smallFileCompileIndex, mod->GetFilename());
+			}
+		}
+
+		size_t count = 0;
+		count += WriteItems<RE::TESObjectWEAP>(file, dataHandler);
+		count += WriteItems<RE::TESObjectARMO>(file, dataHandler);
+		count += WriteItems<RE::TESObjectMISC>(file, dataHandler);
+		count += WriteItems<RE::AlchemyItem>(file, dataHandler);
+		count += WriteItems<RE::TESObjectBOOK>(file, dataHandler);
+		count += WriteItems<RE::IngredientItem>(file, dataHandler);
+		count += WriteItems<RE::TESAmmo>(file, dataHandler);
+		count += WriteItems<RE::ScrollItem>(file, dataHandler);
+		count += WriteItems<RE::TESKey>(file, dataHandler);
+		count += WriteItems<RE::TESSoulGem>(file, dataHandler);
+		count += WriteItems<RE::TESObjectLIGH>(file, dataHandler, [](const RE::TESObjectLIGH* a_light) {
+			return a_light->data.flags.any(RE::TES_LIGHT_FLAGS::kCanCarry);
+			});
+
+		for (const auto list : dataHandler->GetFormArray<RE::TESLevItem>()) {
+			if (!list) continue;
+			WriteHeader(file, "LVLI"sv, list);
+			bool first = true;
+			for (const auto& entry : list->entries) {
+				if (entry.form) {
+					file << fmt::format("{}{:08X}", first ? "" : ",", entry.form->GetFormID());
+					first = false;
+				}
+			}
+			file << '\n';
+			++count;
+		}
+
+		for (const auto container : dataHandler->GetFormArray<RE::TESObjectCONT>()) {
+			if (!container) continue;
+			WriteHeader(file, "CONT"sv, container);
+			bool first = true;
+			for (uint32_t i = 0; i < container->numContainerObjects; ++i) {
+				const auto entry = container->containerObjects[i];
+				if (entry && entry->obj) {
+					file << fmt::format("{}{:08X}*{}", first ? "" : ",", entry->obj->GetFormID(), entry->count);
+					first = false;
+				}
+			}
+			file << '\n';
+			++count;
+		}
+
+		count += WritePlain<RE::BGSKeyword>(file, dataHandler, "KYWD"sv);
+		count += WritePlain<RE::BGSLocation>(file, dataHandler, "LCTN"sv);
+		count += WritePlain<RE::TESWorldSpace>(file, dataHandler, "WRLD"sv);
+		count += WritePlain<RE::TESGlobal>(file, dataHandler, "GLOB"sv);
+		count += WritePlain<RE::TESQuest>(file, dataHandler, "QUST"sv);
+
+		if (!file) {
+			a_error = fmt::format("failed writing {}", a_path.string());
+			return 0;
+		}
+		return count;
+	}
+}
\ No newline at end of file
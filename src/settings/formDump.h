@@ -0,0 +1,20 @@
+#pragma once
+
+//Writes the forms configs can refer to as a text file, so configs can be checked offline with
+//devtools/configLint. Tab separated, one record per line:
+//  CDF form dump <version>
+//  MOD   <compile index> <small file index> <file name>        (indices in hex)
+//  <tag> <form ID> <editor ID> <data>                           (form IDs in hex, editor ID may be empty)
+//Tags and their data:
+//  ITEM  keywords, comma separated form IDs (empty for carryable lights)
+//  LVLI  leveled list entries, comma separated form IDs
+//  CONT  contents, comma separated <form ID>*<count>
+//  KYWD, LCTN, WRLD, GLOB, QUST  no data
+namespace Settings::FormDump
+{
+	inline constexpr uint32_t version = 1;
+
+	std::filesystem::path GetPath();
+	//Main thread, after kDataLoaded. Returns the number of forms written, a_error is set on failure.
+	size_t Write(const std::filesystem::path& a_path, std::string& a_error);
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include "formResolver.h"
+
+#include "utilities/utilities.h"
+
+namespace Settings
+{
+	FormResolver::FormResolver()
+	{
+		for (const auto* file : RE::TESDataHandler::GetSingleton()->files) {
+			if (file) {
+				//First match wins, same as the data handler's scan.
+				mods.emplace(Utilities::String::tolower(file->GetFilename()), file);
+			}
+		}
+	}
+
+	const RE::TESFile* FormResolver::LookupMod(std::string_view a_name)
+	{
+		lowered.assign(a_name);
+		std::ranges::transform(lowered, lowered.begin(), [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+		const auto it = mods.find(std::string_view(lowered));
+		return it != mods.end() ? it->second : nullptr;
+	}
+
+	RE::TESForm* FormResolver::Resolve(std::string_view a_identifier)
+	{
+		++lookups;
+		if (const auto it = forms.find(a_identifier); it != forms.end()) {
+			++hits;
+			return it->second;
+		}
+
+		auto* form = Lookup(a_identifier);
+		forms.emplace(std::string(a_identifier), form);
+		return form;
+	}
+
+	//Same rules as Utilities::Forms::GetFormFromString.
+	RE::TESForm* FormResolver::Lookup(std::string_view a_identifier)
+	{
+		const auto splitID = Utilities::String::split<2>(a_identifier, "|");
+		if (splitID.count != 2) {
+			return RE::TESForm::LookupByEditorID(a_identifier);
+		}
+
+		if (!Utilities::String::is_only_hex(splitID.parts[0])) return nullptr;
+		const auto rawFormID = Utilities::String::to_num<RE::FormID>(splitID.parts[0], true);
+		if (!rawFormID) return nullptr;
+
+		//TESDataHandler::LookupFormID, minus the mod scan.
+		const auto* file = LookupMod(splitID.parts[1]);
+		if (!file || file->compileIndex == 0xFF) return nullptr;
+
+		RE::FormID formID = static_cast<RE::FormID>(file->compileIndex) << 24;
+		formID += static_cast<RE::FormID>(file->smallFileCompileIndex) << 12;
+		formID += *rawFormID;
+		return RE::TESForm::LookupByID(formID);
+	}
+}
\ No newline at end of file
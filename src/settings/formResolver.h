@@ -0,0 +1,42 @@
+#pragma once
+
+namespace Settings
+{
+	//Load scoped memo of form string lookups ("0xID|Plugin.esp" or an editor ID). Popular forms show up
+	//in many configs, each distinct string is resolved once per load. Misses are remembered as well.
+	//Plugin names go through an index instead of the data handler's linear scan. Main thread only.
+	class FormResolver
+	{
+	public:
+		FormResolver();
+
+		//Case insensitive, like TESDataHandler::LookupModByName.
+		const RE::TESFile* LookupMod(std::string_view a_name);
+
+		template <class T>
+		T* Resolve(std::string_view a_identifier)
+		{
+			auto* form = Resolve(a_identifier);
+			return form ? skyrim_cast<T*>(form) : nullptr;
+		}
+
+		size_t GetLookupCount() { return lookups; }
+		size_t GetHitCount() { return hits; }
+
+	private:
+		struct StringHash
+		{
+			using is_transparent = void;
+			size_t operator()(std::string_view a_string) const { return std::hash<std::string_view>{}(a_string); }
+		};
+
+		RE::TESForm* Resolve(std::string_view a_identifier);
+		RE::TESForm* Lookup(std::string_view a_identifier);
+
+		std::unordered_map<std::string, RE::TESForm*, StringHash, std::equal_to<>> forms;
+		std::unordered_map<std::string, const RE::TESFile*, StringHash, std::equal_to<>> mods;
+		std::string lowered;
+		size_t lookups{ 0 };
+		size_t hits{ 0 };
+	};
+}
\ No newline at end of file
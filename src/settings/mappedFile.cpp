@@ -0,0 +1,139 @@
+#include "mappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#	define WIN32_LEAN_AND_MEAN
+#	define NOMINMAX
+#	include <Windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+namespace Settings
+{
+	MappedFile::MappedFile(MappedFile&& a_other) noexcept
+	{
+		*this = std::move(a_other);
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& a_other) noexcept
+	{
+		if (this != &a_other) {
+			Close();
+			data = std::exchange(a_other.data, nullptr);
+			size = std::exchange(a_other.size, 0);
+			fileHandle = std::exchange(a_other.fileHandle, nullptr);
+			mappingHandle = std::exchange(a_other.mappingHandle, nullptr);
+		}
+		return *this;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+#ifdef _WIN32
+	bool MappedFile::Open(const std::string& a_path, std::string& a_error)
+	{
+		Close();
+		const auto file = ::CreateFileA(a_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE) {
+			a_error = "Failed to open <" + a_path + ">. File will be ignored.";
+			return false;
+		}
+		fileHandle = file;
+
+		LARGE_INTEGER fileSize{};
+		if (!::GetFileSizeEx(file, &fileSize)) {
+			a_error = "Failed to get the size of <" + a_path + ">. File will be ignored.";
+			Close();
+			return false;
+		}
+		if (fileSize.QuadPart == 0) {
+			return true;
+		}
+
+		const auto mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping) {
+			a_error = "Failed to map <" + a_path + ">. File will be ignored.";
+			Close();
+			return false;
+		}
+		mappingHandle = mapping;
+
+		const auto view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!view) {
+			a_error = "Failed to map <" + a_path + ">. File will be ignored.";
+			Close();
+			return false;
+		}
+		data = static_cast<const char*>(view);
+		size = static_cast<size_t>(fileSize.QuadPart);
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (data) {
+			::UnmapViewOfFile(data);
+		}
+		if (mappingHandle) {
+			::CloseHandle(mappingHandle);
+		}
+		if (fileHandle) {
+			::CloseHandle(fileHandle);
+		}
+		data = nullptr;
+		size = 0;
+		fileHandle = nullptr;
+		mappingHandle = nullptr;
+	}
+#else
+	bool MappedFile::Open(const std::string& a_path, std::string& a_error)
+	{
+		Close();
+		const int file = ::open(a_path.c_str(), O_RDONLY);
+		if (file < 0) {
+			a_error = "Failed to open <" + a_path + ">. File will be ignored.";
+			return false;
+		}
+
+		struct stat info{};
+		if (::fstat(file, &info) != 0) {
+			::close(file);
+			a_error = "Failed to get the size of <" + a_path + ">. File will be ignored.";
+			return false;
+		}
+		if (info.st_size == 0) {
+			::close(file);
+			return true;
+		}
+
+		void* view = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		::close(file);
+		if (view == MAP_FAILED) {
+			a_error = "Failed to map <" + a_path + ">. File will be ignored.";
+			return false;
+		}
+		data = static_cast<const char*>(view);
+		size = static_cast<size_t>(info.st_size);
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (data) {
+			::munmap(const_cast<char*>(data), size);
+		}
+		data = nullptr;
+		size = 0;
+		fileHandle = nullptr;
+		mappingHandle = nullptr;
+	}
+#endif
+}
\ No newline at end of file
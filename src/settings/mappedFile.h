@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace Settings
+{
+	//Read only memory mapping of a whole file. Game independent, also used by devtools.
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile(MappedFile&& a_other) noexcept;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile& operator=(MappedFile&& a_other) noexcept;
+		~MappedFile();
+
+		//Returns false and fills a_error if the file can't be opened or mapped. Empty files map to an
+		//empty view.
+		bool Open(const std::string& a_path, std::string& a_error);
+		void Close();
+
+		std::string_view GetView() const { return std::string_view(data, size); }
+
+	private:
+		const char* data{ nullptr };
+		size_t size{ 0 };
+		void* fileHandle{ nullptr };
+		void* mappingHandle{ nullptr };
+	};
+}
\ No newline at end of file
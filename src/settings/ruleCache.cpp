@@ -0,0 +1,254 @@
+#include "ruleCache.h"
+
+namespace Settings::Cache
+{
+	namespace
+	{
+		//Bump whenever the layout or anything a condition serializes changes.
+		constexpr uint32_t formatVersion = 1;
+		constexpr char magic[4] = { 'C', 'D', 'F', 'C' };
+		constexpr uint16_t nullPlugin = 0xFFFF;
+
+		struct Header
+		{
+			char magic[4];
+			uint32_t version;
+			uint64_t key;
+			uint64_t payloadSize;
+			uint64_t checksum;
+		};
+	}
+
+	uint64_t Hash(std::string_view a_data, uint64_t a_seed)
+	{
+		uint64_t hash = a_seed;
+		for (const auto c : a_data) {
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 0x100000001B3;
+		}
+		return hash;
+	}
+
+	uint64_t HashConfig(std::string_view a_path, std::string_view a_contents)
+	{
+		return Hash(a_contents, Hash(a_path));
+	}
+
+	uint64_t BuildKey(const std::vector<uint64_t>& a_configHashes)
+	{
+		uint64_t key = Hash(Plugin::VERSION.string());
+		key = Hash(std::string_view(reinterpret_cast<const char*>(&formatVersion), sizeof(formatVersion)), key);
+		for (const auto fileHash : a_configHashes) {
+			key = Hash(std::string_view(reinterpret_cast<const char*>(&fileHash), sizeof(fileHash)), key);
+		}
+
+		//Size and time too: a plugin updated under the same name can give an editor ID to another form.
+		const auto* dataHandler = RE::TESDataHandler::GetSingleton();
+		for (const auto* files : { &dataHandler->compiledFileCollection.files, &dataHandler->compiledFileCollection.smallFiles }) {
+			for (const auto* file : *files) {
+				key = Hash(file->GetFilename(), key);
+				key = Hash("\n", key);
+
+				std::error_code error{};
+				const auto path = std::filesystem::path("Data") / file->GetFilename();
+				const auto size = static_cast<uint64_t>(std::filesystem::file_size(path, error));
+				const auto time = static_cast<int64_t>(std::filesystem::last_write_time(path, error).time_since_epoch().count());
+				key = Hash(std::string_view(reinterpret_cast<const char*>(&size), sizeof(size)), key);
+				key = Hash(std::string_view(reinterpret_cast<const char*>(&time), sizeof(time)), key);
+			}
+		}
+		return key;
+	}
+
+	std::filesystem::path GetPath()
+	{
+		auto path = logger::log_directory();
+		if (!path) {
+			return {};
+		}
+		*path /= fmt::format("{}.cache"sv, Plugin::NAME);
+		return *path;
+	}
+
+	void Writer::WriteString(std::string_view a_string)
+	{
+		Write(static_cast<uint32_t>(a_string.size()));
+		body.append(a_string);
+	}
+
+	void Writer::WriteForm(const RE::TESForm* a_form)
+	{
+		if (!a_form) {
+			Write(nullPlugin);
+			Write(uint32_t{ 0 });
+			return;
+		}
+
+		const auto* file = a_form->GetFile(0);
+		if (!file) {
+			Fail(fmt::format("form {:08X} has no source plugin", a_form->GetFormID()));
+			return;
+		}
+
+		std::string name{ file->GetFilename() };
+		auto it = pluginIndices.find(name);
+		if (it == pluginIndices.end()) {
+			it = pluginIndices.emplace(name, static_cast<uint16_t>(plugins.size())).first;
+			plugins.push_back(std::move(name));
+		}
+		Write(it->second);
+		Write(static_cast<uint32_t>(a_form->GetLocalFormID()));
+	}
+
+	void Writer::Fail(std::string_view a_reason)
+	{
+		if (error.empty()) {
+			error = a_reason;
+		}
+	}
+
+	bool Writer::Finish(const std::filesystem::path& a_path, uint64_t a_key)
+	{
+		if (Failed()) return false;
+		if (a_path.empty()) {
+			Fail("no log directory");
+			return false;
+		}
+
+		std::string payload{};
+		const auto pluginCount = static_cast<uint32_t>(plugins.size());
+		payload.append(reinterpret_cast<const char*>(&pluginCount), sizeof(pluginCount));
+		for (const auto& plugin : plugins) {
+			const auto size = static_cast<uint32_t>(plugin.size());
+			payload.append(reinterpret_cast<const char*>(&size), sizeof(size));
+			payload.append(plugin);
+		}
+		payload.append(body);
+
+		Header header{};
+		std::memcpy(header.magic, magic, sizeof(magic));
+		header.version = formatVersion;
+		header.key = a_key;
+		header.payloadSize = payload.size();
+		header.checksum = Hash(payload);
+
+		auto temporary = a_path;
+		temporary += ".tmp";
+		try {
+			{
+				std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+				out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+				out.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+				if (!out) {
+					Fail("failed to write the cache file");
+					return false;
+				}
+			}
+			std::filesystem::rename(temporary, a_path);
+		}
+		catch (const std::exception& e) {
+			Fail(e.what());
+			return false;
+		}
+		return true;
+	}
+
+	bool Reader::Open(const std::filesystem::path& a_path, uint64_t a_key)
+	{
+		std::error_code ec{};
+		if (a_path.empty() || !std::filesystem::exists(a_path, ec)) {
+			Fail("no cache yet");
+			return false;
+		}
+
+		std::string mapError{};
+		if (!mapping.Open(a_path.string(), mapError)) {
+			Fail("failed to map the cache file");
+			return false;
+		}
+
+		const auto view = mapping.GetView();
+		if (view.size() < sizeof(Header)) {
+			Fail("cache file is truncated");
+			return false;
+		}
+
+		Header header{};
+		std::memcpy(&header, view.data(), sizeof(header));
+		if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != formatVersion) {
+			Fail("cache file has an unknown format");
+			return false;
+		}
+		if (header.key != a_key) {
+			Fail("configs or load order changed");
+			return false;
+		}
+
+		const auto payload = view.substr(sizeof(Header));
+		if (payload.size() != header.payloadSize || Hash(payload) != header.checksum) {
+			Fail("cache file is corrupt");
+			return false;
+		}
+
+		cursor = payload.data();
+		end = payload.data() + payload.size();
+		const auto pluginCount = ReadCount(sizeof(uint32_t));
+		for (uint32_t i = 0; i < pluginCount && !Failed(); ++i) {
+			plugins.push_back(ReadString());
+		}
+		return !Failed();
+	}
+
+	std::string Reader::ReadString()
+	{
+		const auto size = ReadCount(1);
+		if (Failed()) return {};
+		std::string result(cursor, size);
+		cursor += size;
+		return result;
+	}
+
+	RE::TESForm* Reader::ReadForm()
+	{
+		const auto plugin = Read<uint16_t>();
+		const auto localID = Read<uint32_t>();
+		if (Failed() || plugin == nullPlugin) return nullptr;
+		if (plugin >= plugins.size()) {
+			Fail("form refers to an unknown plugin");
+			return nullptr;
+		}
+
+		auto* form = RE::TESDataHandler::GetSingleton()->LookupForm(localID, plugins[plugin]);
+		if (!form) {
+			Fail(fmt::format("form {:X}|{} no longer exists", localID, plugins[plugin]));
+		}
+		return form;
+	}
+
+	uint32_t Reader::ReadCount(size_t a_elementSize)
+	{
+		const auto count = Read<uint32_t>();
+		if (!Failed() && static_cast<size_t>(end - cursor) / std::max<size_t>(a_elementSize, 1) < count) {
+			Fail("cache file is corrupt");
+			return 0;
+		}
+		return Failed() ? 0 : count;
+	}
+
+	void Reader::Fail(std::string_view a_reason)
+	{
+		if (error.empty()) {
+			error = a_reason;
+		}
+	}
+
+	bool Reader::Require(size_t a_size)
+	{
+		if (Failed()) return false;
+		if (static_cast<size_t>(end - cursor) < a_size) {
+			Fail("cache file is corrupt");
+			return false;
+		}
+		return true;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "mappedFile.h"
+
+//Binary cache of the rules and conditions Settings::JSON::Read produces, so unchanged configs don't
+//have to be decoded and resolved again on the next launch. Forms are stored as (plugin, local FormID).
+//The cache is keyed by a hash of the config files, the active plugins (name, size and write time) and
+//the plugin version, and checksummed; anything that doesn't match is ignored and the configs are read
+//as usual.
+namespace Settings::Cache
+{
+	inline constexpr uint64_t hashSeed = 0xCBF29CE484222325;
+
+	//FNV-1a
+	uint64_t Hash(std::string_view a_data, uint64_t a_seed = hashSeed);
+	//Hash of one config file's path and contents.
+	uint64_t HashConfig(std::string_view a_path, std::string_view a_contents);
+	//Combines the config hashes (in order) with the active plugins and the plugin version.
+	uint64_t BuildKey(const std::vector<uint64_t>& a_configHashes);
+	std::filesystem::path GetPath();
+
+	class Writer
+	{
+	public:
+		template <class T>
+		void Write(const T& a_value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			const auto* bytes = reinterpret_cast<const char*>(std::addressof(a_value));
+			body.append(bytes, sizeof(T));
+		}
+
+		void WriteString(std::string_view a_string);
+		//Forms without a source file (created at runtime) can't be stored and fail the writer.
+		void WriteForm(const RE::TESForm* a_form);
+
+		template <class T>
+		void WriteForms(const std::vector<T*>& a_forms)
+		{
+			WriteForms(std::span<T* const>(a_forms));
+		}
+
+		template <class T>
+		void WriteForms(std::span<T* const> a_forms)
+		{
+			Write(static_cast<uint32_t>(a_forms.size()));
+			for (const auto* form : a_forms) {
+				WriteForm(form);
+			}
+		}
+
+		template <class T>
+		void WriteVector(const std::vector<T>& a_values)
+		{
+			Write(static_cast<uint32_t>(a_values.size()));
+			for (const auto& value : a_values) {
+				Write(value);
+			}
+		}
+
+		void Fail(std::string_view a_reason);
+		bool Failed() { return !error.empty(); }
+		//Writes header, plugin table and body to a temporary file and swaps it in.
+		bool Finish(const std::filesystem::path& a_path, uint64_t a_key);
+
+		std::string error;
+
+	private:
+		std::string body;
+		std::vector<std::string> plugins;
+		std::unordered_map<std::string, uint16_t> pluginIndices;
+	};
+
+	class Reader
+	{
+	public:
+		//Maps the cache and validates header, key and checksum. On failure error says why.
+		bool Open(const std::filesystem::path& a_path, uint64_t a_key);
+
+		template <class T>
+		T Read()
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			T value{};
+			if (!Require(sizeof(T))) return value;
+			std::memcpy(std::addressof(value), cursor, sizeof(T));
+			cursor += sizeof(T);
+			return value;
+		}
+
+		std::string ReadString();
+		//Returns nullptr for stored null forms. A stored form that no longer resolves fails the reader.
+		RE::TESForm* ReadForm();
+
+		template <class T>
+		T* ReadForm()
+		{
+			auto* form = ReadForm();
+			if (!form) return nullptr;
+			auto* result = form->As<T>();
+			if (!result) Fail("stored form has a different type");
+			return result;
+		}
+
+		template <class T>
+		std::vector<T*> ReadForms()
+		{
+			std::vector<T*> result;
+			const auto count = ReadCount(sizeof(uint16_t) + sizeof(uint32_t));
+			result.reserve(count);
+			for (uint32_t i = 0; i < count && !Failed(); ++i) {
+				result.push_back(ReadForm<T>());
+			}
+			return result;
+		}
+
+		template <class T>
+		std::vector<T> ReadVector()
+		{
+			std::vector<T> result;
+			const auto count = ReadCount(sizeof(T));
+			result.reserve(count);
+			for (uint32_t i = 0; i < count && !Failed(); ++i) {
+				result.push_back(Read<T>());
+			}
+			return result;
+		}
+
+		//Element count, rejected if the remaining bytes can't hold that many elements.
+		uint32_t ReadCount(size_t a_elementSize);
+		void Fail(std::string_view a_reason);
+		bool Failed() { return !error.empty(); }
+
+		std::string error;
+
+	private:
+		bool Require(size_t a_size);
+
+		MappedFile mapping;
+		const char* cursor{ nullptr };
+		const char* end{ nullptr };
+		std::vector<std::string> plugins;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+//String helpers used while reading configs. Game independent, so devtools can use them too. Only
+//tolower and replace_all allocate.
+namespace Utilities::String
+{
+	//The first N parts of a split, as views into the source string. count is the total number of parts,
+	//which can be larger than N, so callers can reject extra separators.
+	template <size_t N>
+	struct SplitResult
+	{
+		std::array<std::string_view, N> parts{};
+		size_t count{ 0 };
+	};
+
+	template <size_t N>
+	constexpr SplitResult<N> split(std::string_view a_str, std::string_view a_delimiter)
+	{
+		SplitResult<N> result{};
+		if (a_delimiter.empty()) {
+			result.parts[0] = a_str;
+			result.count = 1;
+			return result;
+		}
+
+		size_t start = 0;
+		while (true) {
+			const auto end = a_str.find(a_delimiter, start);
+			if (result.count < N) {
+				result.parts[result.count] = a_str.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+			}
+			++result.count;
+			if (end == std::string_view::npos) {
+				break;
+			}
+			start = end + a_delimiter.length();
+		}
+		return result;
+	}
+
+	// Credit: https://github.com/powerof3/CLibUtil
+	inline bool is_only_hex(std::string_view a_str, bool a_requirePrefix = true)
+	{
+		if (!a_requirePrefix) {
+			return std::ranges::all_of(a_str, [](unsigned char ch) {
+				return std::isxdigit(ch);
+				});
+		}
+		else if (a_str.compare(0, 2, "0x") == 0 || a_str.compare(0, 2, "0X") == 0) {
+			return a_str.size() > 2 && std::all_of(a_str.begin() + 2, a_str.end(), [](unsigned char ch) {
+				return std::isxdigit(ch);
+				});
+		}
+		return false;
+	}
+
+	inline std::string_view trim(std::string_view a_str)
+	{
+		constexpr std::string_view whitespace = " \t\r\n";
+		const auto first = a_str.find_first_not_of(whitespace);
+		if (first == std::string_view::npos) {
+			return {};
+		}
+		return a_str.substr(first, a_str.find_last_not_of(whitespace) - first + 1);
+	}
+
+	//Parses the whole string (surrounding whitespace aside) with std::from_chars. Returns nullopt
+	//instead of throwing on bad input or overflow. Hex accepts an optional 0x prefix, decimal a leading +.
+	template <class T>
+	std::optional<T> to_num(std::string_view a_str, bool a_hex = false)
+	{
+		auto str = trim(a_str);
+		if (a_hex && (str.starts_with("0x") || str.starts_with("0X"))) {
+			str.remove_prefix(2);
+		}
+		else if (!a_hex && str.starts_with('+')) {
+			str.remove_prefix(1);
+		}
+
+		T value{};
+		const auto* first = str.data();
+		const auto* last = str.data() + str.size();
+		std::from_chars_result result{};
+		if constexpr (std::is_floating_point_v<T>) {
+			result = std::from_chars(first, last, value, a_hex ? std::chars_format::hex : std::chars_format::general);
+		}
+		else {
+			result = std::from_chars(first, last, value, a_hex ? 16 : 10);
+		}
+
+		if (str.empty() || result.ec != std::errc() || result.ptr != last) {
+			return std::nullopt;
+		}
+		return value;
+	}
+
+	inline std::string tolower(std::string_view a_str)
+	{
+		std::string result(a_str);
+		std::ranges::transform(result, result.begin(), [](unsigned char ch) { return static_cast<unsigned char>(std::tolower(ch)); });
+		return result;
+	}
+
+	inline bool replace_all(std::string& a_str, std::string_view a_search, std::string_view a_replace)
+	{
+		if (a_search.empty()) {
+			return false;
+		}
+
+		std::size_t pos = 0;
+		bool wasReplaced = false;
+		while ((pos = a_str.find(a_search, pos)) != std::string::npos) {
+			a_str.replace(pos, a_search.length(), a_replace);
+			pos += a_replace.length();
+			wasReplaced = true;
+		}
+
+		return wasReplaced;
+	}
+}
\ No newline at end of file
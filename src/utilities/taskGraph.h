@@ -0,0 +1,194 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Utilities
+{
+	//A handful of dependent tasks, run once. Worker tasks get their own thread as soon as their
+	//dependencies are done. Main thread tasks run on the thread that calls Run, for anything that
+	//must not touch engine state from another thread. Game independent.
+	class TaskGraph
+	{
+	public:
+		using TaskID = size_t;
+
+		enum class Affinity
+		{
+			kMainThread,
+			kWorker
+		};
+
+		struct Timing
+		{
+			double start{ 0.0 };
+			double end{ 0.0 };
+
+			double Duration() const { return end - start; }
+		};
+
+		//Dependencies must already be added, so the graph can't have cycles.
+		TaskID Add(std::string a_name, Affinity a_affinity, std::function<void()> a_task, std::initializer_list<TaskID> a_dependencies = {})
+		{
+			const auto id = tasks.size();
+			auto& task = tasks.emplace_back();
+			task.name = std::move(a_name);
+			task.affinity = a_affinity;
+			task.function = std::move(a_task);
+			for (const auto dependency : a_dependencies) {
+				task.dependencies.push_back(dependency);
+				tasks[dependency].dependents.push_back(id);
+			}
+			return id;
+		}
+
+		//Returns when every task has finished. Rethrows the first exception a task threw.
+		void Run()
+		{
+			origin = std::chrono::steady_clock::now();
+			{
+				std::unique_lock lock{ mutex };
+				for (TaskID id = 0; id < tasks.size(); ++id) {
+					tasks[id].pending = tasks[id].dependencies.size();
+					if (tasks[id].pending == 0) {
+						Schedule(id);
+					}
+				}
+
+				while (completed < tasks.size()) {
+					condition.wait(lock, [&]() { return !mainQueue.empty() || completed == tasks.size(); });
+					if (mainQueue.empty()) {
+						break;
+					}
+					const auto id = mainQueue.front();
+					mainQueue.pop_front();
+					lock.unlock();
+					Execute(id);
+					lock.lock();
+				}
+			}
+
+			for (auto& thread : threads) {
+				thread.join();
+			}
+			threads.clear();
+			if (failure) {
+				std::rethrow_exception(failure);
+			}
+		}
+
+		size_t size() const { return tasks.size(); }
+		const std::string& GetName(TaskID a_task) const { return tasks[a_task].name; }
+		Affinity GetAffinity(TaskID a_task) const { return tasks[a_task].affinity; }
+		//Milliseconds since Run started.
+		const Timing& GetTiming(TaskID a_task) const { return tasks[a_task].timing; }
+
+		double GetWallTime() const
+		{
+			double result = 0.0;
+			for (const auto& task : tasks) {
+				result = std::max(result, task.timing.end);
+			}
+			return result;
+		}
+
+		//Longest chain of dependent tasks by their own durations, and its length in milliseconds. This is
+		//the lower bound for the whole graph no matter how many threads are free.
+		double GetCriticalPath(std::vector<TaskID>& a_path) const
+		{
+			std::vector<double> length(tasks.size(), 0.0);
+			std::vector<TaskID> previous(tasks.size(), tasks.size());
+			TaskID last = tasks.size();
+			for (TaskID id = 0; id < tasks.size(); ++id) {
+				for (const auto dependency : tasks[id].dependencies) {
+					if (length[dependency] > length[id]) {
+						length[id] = length[dependency];
+						previous[id] = dependency;
+					}
+				}
+				length[id] += tasks[id].timing.Duration();
+				if (last == tasks.size() || length[id] > length[last]) {
+					last = id;
+				}
+			}
+
+			a_path.clear();
+			for (auto id = last; id < tasks.size(); id = previous[id]) {
+				a_path.insert(a_path.begin(), id);
+			}
+			return last < tasks.size() ? length[last] : 0.0;
+		}
+
+	private:
+		struct Task
+		{
+			std::string name;
+			Affinity affinity{ Affinity::kMainThread };
+			std::function<void()> function;
+			std::vector<TaskID> dependencies;
+			std::vector<TaskID> dependents;
+			size_t pending{ 0 };
+			Timing timing;
+		};
+
+		double Now() const
+		{
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - origin).count();
+		}
+
+		//Called with the mutex held.
+		void Schedule(TaskID a_task)
+		{
+			if (tasks[a_task].affinity == Affinity::kMainThread) {
+				mainQueue.push_back(a_task);
+				condition.notify_all();
+			}
+			else {
+				threads.emplace_back([this, a_task]() { Execute(a_task); });
+			}
+		}
+
+		void Execute(TaskID a_task)
+		{
+			auto& task = tasks[a_task];
+			task.timing.start = Now();
+			std::exception_ptr exception{};
+			try {
+				task.function();
+			}
+			catch (...) {
+				exception = std::current_exception();
+			}
+			task.timing.end = Now();
+
+			std::scoped_lock lock{ mutex };
+			if (exception && !failure) {
+				failure = exception;
+			}
+			for (const auto dependent : task.dependents) {
+				if (--tasks[dependent].pending == 0) {
+					Schedule(dependent);
+				}
+			}
+			++completed;
+			condition.notify_all();
+		}
+
+		std::vector<Task> tasks;
+		std::deque<TaskID> mainQueue;
+		std::vector<std::thread> threads;
+		std::mutex mutex;
+		std::condition_variable condition;
+		size_t completed{ 0 };
+		std::exception_ptr failure;
+		std::chrono::steady_clock::time_point origin;
+	};
+}
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "stringUtilities.h"
+
 namespace Utilities
 {
 	namespace EDID
@@ -73,104 +75,32 @@ namespace Utilities
 		};
 	}
 
-	namespace String
+	namespace Memory
 	{
-
-		// Credit: https://github.com/powerof3/CLibUtil
-		inline std::vector<std::string> split(const std::string& a_str, const std::string& a_delimiter) {
-			std::vector<std::string> result;
-			size_t start = 0;
-			size_t end = a_str.find(a_delimiter);
-
-			while (end != std::string::npos) {
-				result.push_back(a_str.substr(start, end - start));
-				start = end + a_delimiter.length();
-				end = a_str.find(a_delimiter, start);
-			}
-
-			result.push_back(a_str.substr(start));
-			return result;
-		}
-
-		inline bool is_only_hex(std::string_view a_str, bool a_requirePrefix = true)
-		{
-			if (!a_requirePrefix) {
-				return std::ranges::all_of(a_str, [](unsigned char ch) {
-					return std::isxdigit(ch);
-					});
-			}
-			else if (a_str.compare(0, 2, "0x") == 0 || a_str.compare(0, 2, "0X") == 0) {
-				return a_str.size() > 2 && std::all_of(a_str.begin() + 2, a_str.end(), [](unsigned char ch) {
-					return std::isxdigit(ch);
-					});
-			}
-			return false;
-		}
-
-		template <class T>
-		T to_num(const std::string& a_str, bool a_hex = false)
-		{
-			const int base = a_hex ? 16 : 10;
-
-			if constexpr (std::is_same_v<T, double>) {
-				return static_cast<T>(std::stod(a_str, nullptr));
-			}
-			else if constexpr (std::is_same_v<T, float>) {
-				return static_cast<T>(std::stof(a_str, nullptr));
-			}
-			else if constexpr (std::is_same_v<T, std::int64_t>) {
-				return static_cast<T>(std::stol(a_str, nullptr, base));
-			}
-			else if constexpr (std::is_same_v<T, std::uint64_t>) {
-				return static_cast<T>(std::stoull(a_str, nullptr, base));
-			}
-			else if constexpr (std::is_signed_v<T>) {
-				return static_cast<T>(std::stoi(a_str, nullptr, base));
-			}
-			else {
-				return static_cast<T>(std::stoul(a_str, nullptr, base));
-			}
-		}
-
-		inline std::string tolower(std::string_view a_str)
+		//Estimate for a node based hash map: a heap node per entry with the value and a link, and the
+		//bucket array.
+		template <class Map>
+		size_t GetHashMapMemoryUsage(const Map& a_map)
 		{
-			std::string result(a_str);
-			std::ranges::transform(result, result.begin(), [](unsigned char ch) { return static_cast<unsigned char>(std::tolower(ch)); });
-			return result;
-		}
-
-		inline bool replace_all(std::string& a_str, std::string_view a_search, std::string_view a_replace)
-		{
-			if (a_search.empty()) {
-				return false;
-			}
-
-			std::size_t pos = 0;
-			bool wasReplaced = false;
-			while ((pos = a_str.find(a_search, pos)) != std::string::npos) {
-				a_str.replace(pos, a_search.length(), a_replace);
-				pos += a_replace.length();
-				wasReplaced = true;
-			}
-
-			return wasReplaced;
+			return a_map.size() * (sizeof(typename Map::value_type) + 2 * sizeof(void*)) + a_map.bucket_count() * 2 * sizeof(void*);
 		}
 	}
 
 	namespace Forms
 	{
 		template <typename T>
-		T* GetFormFromString(const std::string& a_str)
+		T* GetFormFromString(std::string_view a_str)
 		{
 			T* response = nullptr;
-			if (const auto splitID = String::split(a_str, "|"); splitID.size() == 2) {
-				if (!String::is_only_hex(splitID[0])) return nullptr;
-				const auto  formID = String::to_num<RE::FormID>(splitID[0], true);
+			if (const auto splitID = String::split<2>(a_str, "|"); splitID.count == 2) {
+				if (!String::is_only_hex(splitID.parts[0])) return nullptr;
+				const auto formID = String::to_num<RE::FormID>(splitID.parts[0], true);
+				if (!formID) return nullptr;
 
-				const auto& modName = splitID[1];
+				const auto modName = splitID.parts[1];
 				if (!RE::TESDataHandler::GetSingleton()->LookupModByName(modName)) return nullptr;
 
-				const auto foundForm = RE::TESDataHandler::GetSingleton()->LookupForm(formID, modName);
+				const auto foundForm = RE::TESDataHandler::GetSingleton()->LookupForm(*formID, modName);
 				if (foundForm) {
 					response = skyrim_cast<T*>(foundForm);
 				}